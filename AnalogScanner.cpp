@@ -0,0 +1,104 @@
+#include "Arduino.h"
+#include "AnalogScanner.h"
+
+AnalogScanner::AnalogScanner()
+{
+  this->_count = 0;
+  this->_discards = 0;
+  this->_settleMicros = 0;
+  this->_scanMicros = 0;
+}
+
+int AnalogScanner::add(Sensor* sensor)
+{
+  if(this->_count >= MAX_SCAN_CHANNELS || sensor->readingFunction != &basicAnalogicReading)
+  {
+    return -1;
+  }
+
+  pinMode(sensor->pin,INPUT);
+  this->_sensors[this->_count] = sensor;
+  return this->_count++;
+}
+
+void AnalogScanner::setSettling(unsigned char discards, unsigned int settleMicros)
+{
+  this->_discards = discards;
+  this->_settleMicros = settleMicros;
+}
+
+int AnalogScanner::scan()
+{
+  unsigned long started = micros();
+  short int samples[MAX_SCAN_CHANNELS];
+  long conversions[MAX_SCAN_CHANNELS];
+  short int rounds = 0;
+  for(int i = 0; i < this->_count; i++)
+  {
+    this->_sensors[i]->scanBegin();
+    samples[i] = this->_sensors[i]->samplesPerReading();
+    conversions[i] = 1L << (2 * this->_sensors[i]->getFilter().oversamplingBits);
+    rounds = samples[i] > rounds ? samples[i] : rounds;
+  }
+
+  /* When using Arduino Due, change resolution once for the whole scan */
+  #ifdef ARDUINO_DUE
+    analogReadResolution(12);
+  #endif
+
+  short int lastPin = -1;
+  for(short int round = 0; round < rounds; round++)
+  {
+    for(int i = 0; i < this->_count; i++)
+    {
+      if(round >= samples[i])
+      {
+        continue;
+      }
+
+      Sensor* sensor = this->_sensors[i];
+      if(sensor->pin != lastPin)
+      {
+        for(unsigned char d = 0; d < this->_discards; d++)
+        {
+          analogRead(sensor->pin);
+        }
+        if(this->_settleMicros > 0)
+        {
+          delayMicroseconds(this->_settleMicros);
+        }
+        lastPin = sensor->pin;
+      }
+
+      /* 4^bits conversions, decimated by 2^bits, as oversampledSample() */
+      if(conversions[i] == 1)
+      {
+        sensor->scanSample(analogRead(sensor->pin));
+        continue;
+      }
+      long sum = 0;
+      for(long c = 0; c < conversions[i]; c++)
+      {
+        sum += analogRead(sensor->pin);
+      }
+      sensor->scanSample((uint16_t)(sum >> sensor->getFilter().oversamplingBits));
+    }
+  }
+
+  #ifdef ARDUINO_DUE
+    analogReadResolution(10);
+  #endif
+
+  this->_scanMicros = micros() - started;
+  return this->_count;
+}
+
+int AnalogScanner::getChannelsCount()
+{
+  return this->_count;
+}
+
+unsigned long AnalogScanner::getScanMicros()
+{
+  return this->_scanMicros;
+}
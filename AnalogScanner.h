@@ -0,0 +1,56 @@
+#ifndef AnalogScanner_h
+#define AnalogScanner_h
+
+#include "Arduino.h"
+#include "Sensor.h"
+
+#if defined(__AVR__)
+	#define MAX_SCAN_CHANNELS		8
+#else
+	#define MAX_SCAN_CHANNELS		16
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Batched acquisition of many analogic sensors.																				*/
+/*																																											*/
+/* Sensors read one by one configure their pin and, on the Due, switch the ADC						*/
+/* resolution at every reading, and take all their samples before the next sensor				*/
+/* starts. scan() configures the pins once, when they are added, switches the resolution	*/
+/* once per scan and takes the samples round by round: the first sample of every				*/
+/* sensor, then the second one, and so on. The readings of a scan then cover the same		*/
+/* time span, and each sensor gets its reading through its filter as collectInput() does.	*/
+/*																																											*/
+/* After the multiplexer moves to another pin, the sample and hold capacitor needs time		*/
+/* to follow a high impedance source: setSettling() discards conversions and waits			*/
+/* before the first sample of each pin.																									*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class AnalogScanner
+{
+	public:
+		AnalogScanner();
+
+		/* add: a sensor to scan, its pin is configured now. Returns its id, -1 if it is not analogic or the scanner is full */
+		int add(Sensor* sensor);
+
+		/* setSettling: conversions discarded and microseconds waited after the multiplexer changes pin */
+		void setSettling(unsigned char discards, unsigned int settleMicros);
+
+		/* scan: one reading of every sensor, blocking. Returns the sensors read */
+		int scan();
+
+		int getChannelsCount();
+		/* getScanMicros: duration of the last scan */
+		unsigned long getScanMicros();
+
+	private:
+		Sensor* _sensors[MAX_SCAN_CHANNELS];
+		unsigned char _count;
+		unsigned char _discards;
+		unsigned int _settleMicros;
+		unsigned long _scanMicros;
+};
+
+#endif
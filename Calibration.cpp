@@ -0,0 +1,295 @@
+#include <math.h>
+#include <string.h>
+#include "Calibration.h"
+
+Calibration::Calibration()
+{
+  this->setLinear(0, 1);
+}
+
+void Calibration::setLinear(float intercept, float slope)
+{
+  /* t = raw, so the coefficients are the line itself */
+  this->_model = CALIBRATION_LINEAR;
+  this->_knots = 0;
+  this->_terms.polynomial.center = 0;
+  this->_terms.polynomial.scale = 1;
+  this->_terms.polynomial.coefficients[0] = intercept;
+  this->_terms.polynomial.coefficients[1] = slope;
+}
+
+bool Calibration::fit(unsigned char model, const float* rawValues, const float* referenceValues, short int count)
+{
+  if(count > MAX_CALIBRATION_POINTS)
+  {
+    count = MAX_CALIBRATION_POINTS;
+  }
+
+  switch(model)
+  {
+    case CALIBRATION_LINEAR:
+    case CALIBRATION_QUADRATIC:
+    case CALIBRATION_CUBIC:
+      return this->fitPolynomial(model, rawValues, referenceValues, count);
+    case CALIBRATION_PIECEWISE:
+      return this->fitPiecewise(rawValues, referenceValues, count);
+    default:
+      return false;
+  }
+}
+
+bool Calibration::fitPolynomial(short int degree, const float* rawValues, const float* referenceValues, short int count)
+{
+  if(count < degree + 1)
+  {
+    return false;
+  }
+
+  /* Centre and scale the raw values to [-1, 1] */
+  double center = 0;
+  for(int i = 0; i < count; i++)
+  {
+    center += rawValues[i];
+  }
+  center /= count;
+  double halfRange = 0;
+  for(int i = 0; i < count; i++)
+  {
+    double distance = fabs(rawValues[i] - center);
+    halfRange = distance > halfRange ? distance : halfRange;
+  }
+  if(halfRange == 0)
+  {
+    return false;
+  }
+  double scale = 1 / halfRange;
+
+  /* Normal equations, augmented with the right-hand side */
+  const int size = degree + 1;
+  double normal[MAX_CALIBRATION_DEGREE + 1][MAX_CALIBRATION_DEGREE + 2];
+  for(int row = 0; row < size; row++)
+  {
+    for(int column = 0; column <= size; column++)
+    {
+      normal[row][column] = 0;
+    }
+  }
+  for(int i = 0; i < count; i++)
+  {
+    double t = (rawValues[i] - center) * scale;
+    double powers[2 * MAX_CALIBRATION_DEGREE + 1];
+    powers[0] = 1;
+    for(int p = 1; p <= 2 * degree; p++)
+    {
+      powers[p] = powers[p - 1] * t;
+    }
+    for(int row = 0; row < size; row++)
+    {
+      for(int column = 0; column < size; column++)
+      {
+        normal[row][column] += powers[row + column];
+      }
+      normal[row][size] += referenceValues[i] * powers[row];
+    }
+  }
+
+  /* Gaussian elimination with partial pivoting */
+  for(int pivot = 0; pivot < size; pivot++)
+  {
+    int best = pivot;
+    for(int row = pivot + 1; row < size; row++)
+    {
+      if(fabs(normal[row][pivot]) > fabs(normal[best][pivot]))
+      {
+        best = row;
+      }
+    }
+    if(fabs(normal[best][pivot]) < 1e-9)
+    {
+      /* Fewer distinct raw values than coefficients */
+      return false;
+    }
+    for(int column = 0; column <= size; column++)
+    {
+      double swap = normal[pivot][column];
+      normal[pivot][column] = normal[best][column];
+      normal[best][column] = swap;
+    }
+    for(int row = pivot + 1; row < size; row++)
+    {
+      double factor = normal[row][pivot] / normal[pivot][pivot];
+      for(int column = pivot; column <= size; column++)
+      {
+        normal[row][column] -= factor * normal[pivot][column];
+      }
+    }
+  }
+
+  double coefficients[MAX_CALIBRATION_DEGREE + 1];
+  for(int row = size - 1; row >= 0; row--)
+  {
+    double sum = normal[row][size];
+    for(int column = row + 1; column < size; column++)
+    {
+      sum -= normal[row][column] * coefficients[column];
+    }
+    coefficients[row] = sum / normal[row][row];
+  }
+
+  this->_model = degree;
+  this->_knots = 0;
+  this->_terms.polynomial.center = center;
+  this->_terms.polynomial.scale = scale;
+  for(int i = 0; i < size; i++)
+  {
+    this->_terms.polynomial.coefficients[i] = coefficients[i];
+  }
+  return true;
+}
+
+bool Calibration::fitPiecewise(const float* rawValues, const float* referenceValues, short int count)
+{
+  /* Sort the points by raw value (insertion sort, there are at most 10) */
+  float knots[MAX_CALIBRATION_POINTS];
+  float values[MAX_CALIBRATION_POINTS];
+  for(int i = 0; i < count; i++)
+  {
+    int j = i;
+    while(j > 0 && knots[j - 1] > rawValues[i])
+    {
+      knots[j] = knots[j - 1];
+      values[j] = values[j - 1];
+      j--;
+    }
+    knots[j] = rawValues[i];
+    values[j] = referenceValues[i];
+  }
+
+  /* Points with the same raw value are merged into their average */
+  short int distinct = 0;
+  for(int i = 0; i < count; )
+  {
+    int j = i;
+    float sum = 0;
+    while(j < count && knots[j] == knots[i])
+    {
+      sum += values[j];
+      j++;
+    }
+    knots[distinct] = knots[i];
+    values[distinct] = sum / (j - i);
+    distinct++;
+    i = j;
+  }
+  if(distinct < 2)
+  {
+    return false;
+  }
+
+  this->_model = CALIBRATION_PIECEWISE;
+  this->_knots = distinct;
+  for(int i = 0; i < distinct; i++)
+  {
+    this->_terms.piecewise.knots[i] = knots[i];
+    this->_terms.piecewise.values[i] = values[i];
+  }
+  for(int i = 0; i < distinct - 1; i++)
+  {
+    this->_terms.piecewise.slopes[i] = (values[i + 1] - values[i]) / (knots[i + 1] - knots[i]);
+  }
+  return true;
+}
+
+float Calibration::evaluate(float rawValue) const
+{
+  if(this->_model == CALIBRATION_PIECEWISE)
+  {
+    const calibration_piecewise& terms = this->_terms.piecewise;
+
+    /* Segment whose start is the last knot not above rawValue, clamped to the first and last segments */
+    short int low = 0;
+    short int high = this->_knots - 1;
+    while(high - low > 1)
+    {
+      short int middle = (low + high) / 2;
+      if(terms.knots[middle] <= rawValue)
+      {
+        low = middle;
+      } else {
+        high = middle;
+      }
+    }
+    return terms.values[low] + terms.slopes[low] * (rawValue - terms.knots[low]);
+  }
+
+  /* Horner, in the centred variable */
+  const calibration_polynomial& terms = this->_terms.polynomial;
+  float t = (rawValue - terms.center) * terms.scale;
+  float value = terms.coefficients[this->_model];
+  for(int i = this->_model - 1; i >= 0; i--)
+  {
+    value = value * t + terms.coefficients[i];
+  }
+  return value;
+}
+
+short int Calibration::degree() const
+{
+  return this->_model == CALIBRATION_PIECEWISE ? 1 : this->_model;
+}
+
+float Calibration::slope() const
+{
+  return this->_model == CALIBRATION_LINEAR ? this->_terms.polynomial.coefficients[1] * this->_terms.polynomial.scale : NAN;
+}
+
+float Calibration::intercept() const
+{
+  return this->_model == CALIBRATION_LINEAR ? this->_terms.polynomial.coefficients[0] - this->slope() * this->_terms.polynomial.center : NAN;
+}
+
+/* FNV-1a over the model and the terms it uses, not over the unused part of the union */
+static unsigned long hashBytes(unsigned long hash, const void* data, size_t length)
+{
+  const unsigned char* bytes = (const unsigned char*)data;
+  for(size_t i = 0; i < length; i++)
+  {
+    hash ^= bytes[i];
+    hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+  }
+  return hash;
+}
+
+unsigned long Calibration::fingerprint() const
+{
+  unsigned long hash = hashBytes(2166136261UL, &this->_model, sizeof(this->_model));
+  if(this->_model == CALIBRATION_PIECEWISE)
+  {
+    const calibration_piecewise& terms = this->_terms.piecewise;
+    hash = hashBytes(hash, terms.knots, this->_knots * sizeof(float));
+    return hashBytes(hash, terms.values, this->_knots * sizeof(float));
+  }
+  const calibration_polynomial& terms = this->_terms.polynomial;
+  hash = hashBytes(hash, &terms.center, sizeof(terms.center));
+  hash = hashBytes(hash, &terms.scale, sizeof(terms.scale));
+  return hashBytes(hash, terms.coefficients, (this->_model + 1) * sizeof(float));
+}
+
+bool Calibration::sameAs(const Calibration& other) const
+{
+  if(this->_model != other._model)
+  {
+    return false;
+  }
+  if(this->_model == CALIBRATION_PIECEWISE)
+  {
+    const calibration_piecewise& terms = this->_terms.piecewise;
+    return this->_knots == other._knots
+      && memcmp(terms.knots, other._terms.piecewise.knots, this->_knots * sizeof(float)) == 0
+      && memcmp(terms.values, other._terms.piecewise.values, this->_knots * sizeof(float)) == 0;
+  }
+  const calibration_polynomial& terms = this->_terms.polynomial;
+  return memcmp(&terms.center, &other._terms.polynomial.center, sizeof(terms.center)) == 0
+    && memcmp(&terms.scale, &other._terms.polynomial.scale, sizeof(terms.scale)) == 0
+    && memcmp(terms.coefficients, other._terms.polynomial.coefficients, (this->_model + 1) * sizeof(float)) == 0;
+}
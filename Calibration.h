@@ -0,0 +1,86 @@
+#ifndef Calibration_h
+#define Calibration_h
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Calibration models, from raw readings to the measure unit.														*/
+/*																																											*/
+/* fit() takes the raw readings taken at the calibration points and the reference values	*/
+/* of the points, and precomputes a form that evaluate() runs in constant time:					*/
+/*   - polynomials (linear, quadratic, cubic) are least squares fits in the centred and		*/
+/*     scaled variable t = (raw - center) * scale, with t in [-1, 1], so the normal				*/
+/*     equations stay well conditioned on 12 bit readings; they are evaluated by Horner;		*/
+/*   - piecewise-linear goes through the points, sorted by raw value, with a slope per		*/
+/*     segment; the segment is found by binary search, readings outside the points are		*/
+/*     extrapolated from the first or last segment.																				*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define CALIBRATION_LINEAR				0x01
+#define CALIBRATION_QUADRATIC			0x02
+#define CALIBRATION_CUBIC					0x03
+#define CALIBRATION_PIECEWISE			0x04
+
+#define MAX_CALIBRATION_POINTS		10
+#define MAX_CALIBRATION_DEGREE		3
+
+typedef struct calibration_polynomial {
+
+		float center;
+		float scale;
+		float coefficients[MAX_CALIBRATION_DEGREE + 1];		// Of t, from the constant term
+
+	} calibration_polynomial;
+
+typedef struct calibration_piecewise {
+
+		float knots[MAX_CALIBRATION_POINTS];				// Raw values, increasing
+		float values[MAX_CALIBRATION_POINTS];				// Reference values at the knots
+		float slopes[MAX_CALIBRATION_POINTS - 1];		// Of the segments
+
+	} calibration_piecewise;
+
+class Calibration
+{
+	public:
+		/* The identity line */
+		Calibration();
+
+		/* fit: fits a model through count points. Returns false, leaving the calibration unchanged, if there are		*/
+		/* too few distinct raw values for the model (degree + 1 for polynomials, 2 for piecewise)							*/
+		bool fit(unsigned char model, const float* rawValues, const float* referenceValues, short int count);
+
+		/* setLinear: sets a line given in raw units */
+		void setLinear(float intercept, float slope);
+
+		/* evaluate: converts a raw value */
+		float evaluate(float rawValue) const;
+
+		unsigned char model() const { return this->_model; }
+		/* Degree of polynomial models, 1 for piecewise */
+		short int degree() const;
+		/* Number of knots of piecewise models */
+		short int knots() const { return this->_knots; }
+
+		/* slope and intercept of linear models, in raw units */
+		float slope() const;
+		float intercept() const;
+
+		/* fingerprint: hash of the model and its terms, equal calibrations have equal fingerprints */
+		unsigned long fingerprint() const;
+		/* sameAs: same model and terms, byte for byte, as fingerprint() hashes them */
+		bool sameAs(const Calibration& other) const;
+
+	private:
+		unsigned char _model;
+		short int _knots;
+		union {
+			calibration_polynomial polynomial;
+			calibration_piecewise piecewise;
+		} _terms;
+
+		bool fitPolynomial(short int degree, const float* rawValues, const float* referenceValues, short int count);
+		bool fitPiecewise(const float* rawValues, const float* referenceValues, short int count);
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "Arduino.h"
+#include "CalibrationStore.h"
+#include "Telemetry.h"
+
+unsigned int CalibrationStore::_start = CALIBRATION_STORE_START;
+unsigned int CalibrationStore::_length = CALIBRATION_STORE_LENGTH;
+unsigned long (*CalibrationStore::_clock)() = NULL;
+
+#if defined(__AVR__) || defined(ARDUINO_HOST)
+
+#include <EEPROM.h>
+
+static unsigned int storeSize()
+{
+  return EEPROM.length();
+}
+
+static byte storeRead(unsigned int address)
+{
+  return EEPROM.read(address);
+}
+
+static void storeUpdate(unsigned int address, byte value)
+{
+  EEPROM.update(address, value);
+}
+
+#else
+
+/* No EEPROM on this board: the log has no slots */
+static unsigned int storeSize()
+{
+  return 0;
+}
+
+static byte storeRead(unsigned int address)
+{
+  return 0xFF;
+}
+
+static void storeUpdate(unsigned int address, byte value)
+{
+}
+
+#endif
+
+void CalibrationStore::begin(unsigned int start, unsigned int length)
+{
+  CalibrationStore::_start = start;
+  CalibrationStore::_length = length;
+}
+
+void CalibrationStore::setClock(unsigned long (*clock)())
+{
+  CalibrationStore::_clock = clock;
+}
+
+bool CalibrationStore::save(calibration_record* record)
+{
+  unsigned int count = CalibrationStore::slots();
+  if(count == 0)
+  {
+    return false;
+  }
+
+  /* The newest record of the log, the new one goes after it */
+  calibration_record stored;
+  unsigned long sequence = 0;
+  int newest = -1;
+  for(unsigned int i = 0; i < count; i++)
+  {
+    if(CalibrationStore::readSlot(i, &stored) && (newest < 0 || stored.sequence > sequence))
+    {
+      sequence = stored.sequence;
+      newest = i;
+    }
+  }
+
+  record->magic = CALIBRATION_RECORD_MAGIC;
+  record->version = CALIBRATION_RECORD_VERSION;
+  record->sequence = sequence + 1;
+  record->timestamp = CalibrationStore::now();
+  record->crc = crc16((const byte*)record, offsetof(calibration_record, crc));
+
+  /* Free slots are erased, torn or superseded by a newer record of their sensor. The latest record		*/
+  /* of the sensor itself is kept until the new one is written, so a reset meanwhile loses nothing		*/
+  unsigned int first = newest < 0 ? 0 : newest + 1;
+  for(unsigned int k = 0; k < count; k++)
+  {
+    unsigned int slot = (first + k) % count;
+    if(!CalibrationStore::readSlot(slot, &stored) || CalibrationStore::latest(stored.type, stored.pin) != (int)slot)
+    {
+      CalibrationStore::writeSlot(slot, *record);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CalibrationStore::load(unsigned char type, unsigned char pin, calibration_record* record)
+{
+  int slot = CalibrationStore::latest(type, pin);
+  return slot >= 0 && CalibrationStore::readSlot(slot, record);
+}
+
+void CalibrationStore::erase()
+{
+  unsigned int length = CalibrationStore::slots() * sizeof(calibration_record);
+  for(unsigned int i = 0; i < length; i++)
+  {
+    storeUpdate(CalibrationStore::_start + i, 0xFF);
+  }
+}
+
+unsigned int CalibrationStore::slots()
+{
+  /* The region is cut at the end of the EEPROM */
+  unsigned int size = storeSize();
+  if(CalibrationStore::_start >= size)
+  {
+    return 0;
+  }
+  unsigned int length = CalibrationStore::_length < size - CalibrationStore::_start ? CalibrationStore::_length : size - CalibrationStore::_start;
+  return length / sizeof(calibration_record);
+}
+
+unsigned long CalibrationStore::now()
+{
+  return CalibrationStore::_clock != NULL ? CalibrationStore::_clock() : millis();
+}
+
+bool CalibrationStore::readSlot(unsigned int slot, calibration_record* record)
+{
+  unsigned int address = CalibrationStore::_start + slot * sizeof(calibration_record);
+  byte* bytes = (byte*)record;
+  for(unsigned int i = 0; i < sizeof(calibration_record); i++)
+  {
+    bytes[i] = storeRead(address + i);
+  }
+
+  return record->magic == CALIBRATION_RECORD_MAGIC && record->version == CALIBRATION_RECORD_VERSION
+    && record->crc == crc16(bytes, offsetof(calibration_record, crc));
+}
+
+void CalibrationStore::writeSlot(unsigned int slot, const calibration_record& record)
+{
+  unsigned int address = CalibrationStore::_start + slot * sizeof(calibration_record);
+  const byte* bytes = (const byte*)&record;
+  for(unsigned int i = 0; i < sizeof(calibration_record); i++)
+  {
+    storeUpdate(address + i, bytes[i]);
+  }
+}
+
+int CalibrationStore::latest(unsigned char type, unsigned char pin)
+{
+  calibration_record stored;
+  unsigned long sequence = 0;
+  int slot = -1;
+  for(unsigned int i = 0; i < CalibrationStore::slots(); i++)
+  {
+    if(CalibrationStore::readSlot(i, &stored) && stored.type == type && stored.pin == pin && (slot < 0 || stored.sequence > sequence))
+    {
+      sequence = stored.sequence;
+      slot = i;
+    }
+  }
+  return slot;
+}
@@ -0,0 +1,89 @@
+#ifndef CalibrationStore_h
+#define CalibrationStore_h
+
+#include "Arduino.h"
+#include "Calibration.h"
+
+#define CALIBRATION_RECORD_MAGIC		0xCA
+#define CALIBRATION_RECORD_VERSION	1			// Records of other versions are ignored
+
+/* EEPROM region of the log. None by default: the EEPROM belongs to the sketch unless it gives some, e.g.	*/
+/* -DCALIBRATION_STORE_START=512 -DCALIBRATION_STORE_LENGTH=512 in the build flags, or begin() in setup()	*/
+#ifndef CALIBRATION_STORE_START
+	#define CALIBRATION_STORE_START		0
+#endif
+#ifndef CALIBRATION_STORE_LENGTH
+	#define CALIBRATION_STORE_LENGTH	0
+#endif
+
+/* Calibration of a sensor as stored, in a slot of the log */
+typedef struct calibration_record {
+
+		unsigned char magic;													// CALIBRATION_RECORD_MAGIC, 0xFF in erased slots
+		unsigned char version;												// CALIBRATION_RECORD_VERSION
+		unsigned char type;														// Sensor type constant, CUSTOM for custom sensor_params
+		unsigned char pin;
+		unsigned char model;													// CALIBRATION_...
+		unsigned char points;													// Calibration points of the sensor
+		unsigned long sequence;												// Order of the writes, the newest record has the highest
+		unsigned long timestamp;											// When the calibration was saved, see setClock()
+		float intercept;															// Linear models, in raw units
+		float slope;
+		float references[MAX_CALIBRATION_POINTS];			// Reference values of the points
+		float rawValues[MAX_CALIBRATION_POINTS];			// Raw values read at the points, fitted again by the other models
+		unsigned short crc;														// crc16() of the bytes before it
+
+	} calibration_record;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Calibrations kept across resets, in EEPROM.																					*/
+/*																																											*/
+/* The region is a log of fixed size slots, written in turn: a new record goes to the		*/
+/* slot after the newest one, skipping the slots that hold the latest record of a				*/
+/* sensor, so each sensor keeps one, and the writes of a sensor calibrated over and over	*/
+/* are spread over the whole region. Only the bytes that change are written.						*/
+/*																																											*/
+/* A record is found by sensor type and pin, and is valid if its CRC matches: one torn		*/
+/* by a reset while written is skipped, and the previous record of the sensor is used.	*/
+/* Polynomial and piecewise models are fitted again from the stored points, as				*/
+/* calibrate() fitted them, so a record is about 100 bytes whatever the model.					*/
+/*																																											*/
+/* The log only uses the region it is given, CALIBRATION_STORE_LENGTH bytes by default:	*/
+/* with none, calibrations are not kept. Available on AVR, and on the host where the			*/
+/* EEPROM can be backed by a file (see HostSim.h). Elsewhere there are no slots.					*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class CalibrationStore
+{
+	public:
+		/* begin: keeps the log in length bytes of EEPROM from start instead of the CALIBRATION_STORE_ region.	*/
+		/* Call it in setup(), before the first reading: sensors load their calibration then						*/
+		static void begin(unsigned int start, unsigned int length);
+		/* setClock: timestamps of the records, e.g. Unix time from an RTC. millis() if NULL */
+		static void setClock(unsigned long (*clock)());
+
+		/* save: writes record as the latest of its sensor, setting its magic, version, sequence, timestamp and	*/
+		/* CRC. Padding must be zeroed. False if every slot holds the latest record of a sensor									*/
+		static bool save(calibration_record* record);
+		/* load: the latest valid record of the sensor with this type and pin, false if there is none */
+		static bool load(unsigned char type, unsigned char pin, calibration_record* record);
+		/* erase: erases the whole log */
+		static void erase();
+
+		static unsigned int slots();
+		static unsigned long now();
+
+	private:
+		static unsigned int _start;
+		static unsigned int _length;
+		static unsigned long (*_clock)();
+
+		static bool readSlot(unsigned int slot, calibration_record* record);
+		static void writeSlot(unsigned int slot, const calibration_record& record);
+		/* Slot holding the latest record of the sensor with this type and pin, -1 if none */
+		static int latest(unsigned char type, unsigned char pin);
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "Arduino.h"
+#include "CalibrationTable.h"
+
+#if MAX_CALIBRATION_TABLES > 0
+CalibrationTable CalibrationTable::_pool[MAX_CALIBRATION_TABLES];
+Calibration CalibrationTable::_calibrations[MAX_CALIBRATION_TABLES];
+int16_t CalibrationTable::_storage[MAX_CALIBRATION_TABLES][CALIBRATION_TABLE_CODES];
+#endif
+
+CalibrationTable::CalibrationTable()
+{
+  this->_entries = NULL;
+  this->_inFlash = false;
+  this->_scale = 1;
+  this->_offset = 0;
+  this->_fingerprint = 0;
+  this->_users = 0;
+}
+
+CalibrationTable::CalibrationTable(const int16_t* entries, float scale, float offset)
+{
+  this->_entries = entries;
+  this->_inFlash = true;
+  this->_scale = scale;
+  this->_offset = offset;
+  this->_fingerprint = 0;
+  this->_users = 0;
+}
+
+CalibrationTable* CalibrationTable::acquire(const Calibration& calibration)
+{
+#if MAX_CALIBRATION_TABLES > 0
+  unsigned long fingerprint = calibration.fingerprint();
+
+  /* Share a table built for the same calibration, not just one with the same fingerprint */
+  for(int i = 0; i < MAX_CALIBRATION_TABLES; i++)
+  {
+    if(_pool[i]._users > 0 && _pool[i]._users < 255 && _pool[i]._fingerprint == fingerprint
+      && _calibrations[i].sameAs(calibration))
+    {
+      _pool[i]._users++;
+      return &_pool[i];
+    }
+  }
+
+  for(int i = 0; i < MAX_CALIBRATION_TABLES; i++)
+  {
+    if(_pool[i]._users == 0)
+    {
+      CalibrationTable::generate(calibration, _storage[i], &_pool[i]._scale, &_pool[i]._offset);
+      _pool[i]._entries = _storage[i];
+      _pool[i]._fingerprint = fingerprint;
+      _calibrations[i] = calibration;
+      _pool[i]._users = 1;
+      return &_pool[i];
+    }
+  }
+#endif
+  return NULL;
+}
+
+void CalibrationTable::release(const CalibrationTable* table)
+{
+#if MAX_CALIBRATION_TABLES > 0
+  /* Tables in flash belong to the caller */
+  for(int i = 0; i < MAX_CALIBRATION_TABLES; i++)
+  {
+    if(table == &_pool[i] && _pool[i]._users > 0)
+    {
+      _pool[i]._users--;
+    }
+  }
+#endif
+}
+
+unsigned char CalibrationTable::tablesInUse()
+{
+  unsigned char count = 0;
+#if MAX_CALIBRATION_TABLES > 0
+  for(int i = 0; i < MAX_CALIBRATION_TABLES; i++)
+  {
+    if(_pool[i]._users > 0)
+    {
+      count++;
+    }
+  }
+#endif
+  return count;
+}
+
+void CalibrationTable::generate(const Calibration& calibration, int16_t* entries, float* scale, float* offset)
+{
+  /* Range of the values, so the entries use all the int16 range */
+  float minimum = calibration.evaluate(0);
+  float maximum = minimum;
+  for(int code = 1; code < CALIBRATION_TABLE_CODES; code++)
+  {
+    float value = calibration.evaluate(code);
+    minimum = value < minimum ? value : minimum;
+    maximum = value > maximum ? value : maximum;
+  }
+  *offset = (minimum + maximum) / 2;
+  *scale = maximum > minimum ? (maximum - minimum) / 65534 : 1;
+
+  for(int code = 0; code < CALIBRATION_TABLE_CODES; code++)
+  {
+    float entry = (calibration.evaluate(code) - *offset) / *scale;
+    entry = entry > 32767 ? 32767 : (entry < -32767 ? -32767 : entry);
+    entries[code] = (int16_t)(entry >= 0 ? entry + 0.5f : entry - 0.5f);
+  }
+}
+
+int CalibrationTable::entry(int code) const
+{
+  if(code < 0)
+  {
+    code = 0;
+  }
+  if(code >= CALIBRATION_TABLE_CODES)
+  {
+    code = CALIBRATION_TABLE_CODES - 1;
+  }
+  return this->_inFlash ? (int16_t)pgm_read_word(&this->_entries[code]) : this->_entries[code];
+}
+
+float CalibrationTable::lookup(int code) const
+{
+  return this->_offset + this->entry(code) * this->_scale;
+}
+
+float CalibrationTable::lookup(long rawSum, short int count) const
+{
+  /* Code of the average and fraction towards the next one, in 1/256, all in integers */
+  int code = rawSum / count;
+  long fraction = ((rawSum % count) << 8) / count;
+  long low = this->entry(code);
+  if(fraction == 0)
+  {
+    return this->_offset + low * this->_scale;
+  }
+  long high = this->entry(code + 1);
+  return this->_offset + (low + (((high - low) * fraction) >> 8)) * this->_scale;
+}
@@ -0,0 +1,83 @@
+#ifndef CalibrationTable_h
+#define CalibrationTable_h
+
+#include "Arduino.h"
+#include "Calibration.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Lookup tables from raw ADC code to calibrated value.																	*/
+/*																																											*/
+/* The raw domain of analogic sensors is finite, so any calibration model can be				*/
+/* evaluated once per code and stored as int16 entries, value = offset + entry * scale.	*/
+/* A reading then costs a lookup and an integer interpolation between the two codes			*/
+/* around the average of its samples, whatever the model.																*/
+/*																																											*/
+/* Tables built at run time come from a static pool and are shared: acquire() returns		*/
+/* the table already built for the same calibration, if any, found by fingerprint and		*/
+/* then checked term by term, as fingerprints can collide. Each										*/
+/* table takes CALIBRATION_TABLE_CODES * 2 bytes of RAM, so the pool is empty on AVR by		*/
+/* default; there, tables can be generated on the host with generate() and kept in			*/
+/* flash (PROGMEM), using the constructor.																							*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef ARDUINO_DUE
+	#define CALIBRATION_TABLE_CODES		4096
+#else
+	#define CALIBRATION_TABLE_CODES		1024
+#endif
+
+#ifndef MAX_CALIBRATION_TABLES
+	#if defined(__AVR__)
+		#define MAX_CALIBRATION_TABLES	0
+	#else
+		#define MAX_CALIBRATION_TABLES	2
+	#endif
+#endif
+
+class CalibrationTable
+{
+	public:
+		/* A table of CALIBRATION_TABLE_CODES entries in flash, as written by generate() */
+		CalibrationTable(const int16_t* entries, float scale, float offset);
+
+		/* acquire: a table for calibration from the pool, shared with the sensors that have the same		*/
+		/* calibration. NULL if the pool is full. Every acquired table must be released							*/
+		static CalibrationTable* acquire(const Calibration& calibration);
+		static void release(const CalibrationTable* table);
+		/* Pool tables in use */
+		static unsigned char tablesInUse();
+
+		/* generate: evaluates calibration for every code into entries, and gives their scale and offset */
+		static void generate(const Calibration& calibration, int16_t* entries, float* scale, float* offset);
+
+		/* lookup: calibrated value of the average of count samples summing to rawSum */
+		float lookup(long rawSum, short int count) const;
+		float lookup(int code) const;
+
+		unsigned long fingerprint() const { return this->_fingerprint; }
+		unsigned char users() const { return this->_users; }
+		float scale() const { return this->_scale; }
+		float offset() const { return this->_offset; }
+
+	private:
+		CalibrationTable();
+
+		const int16_t* _entries;
+		bool _inFlash;
+		float _scale;
+		float _offset;
+		unsigned long _fingerprint;
+		unsigned char _users;
+
+		int entry(int code) const;
+
+#if MAX_CALIBRATION_TABLES > 0
+		static CalibrationTable _pool[MAX_CALIBRATION_TABLES];
+		static Calibration _calibrations[MAX_CALIBRATION_TABLES];		// The calibration each pool table was built for
+		static int16_t _storage[MAX_CALIBRATION_TABLES][CALIBRATION_TABLE_CODES];
+#endif
+};
+
+#endif
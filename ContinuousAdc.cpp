@@ -0,0 +1,365 @@
+#include "Arduino.h"
+#include "ContinuousAdc.h"
+
+#ifdef SENSOR_CONTINUOUS_ADC
+
+adc_channel ContinuousAdc::_channels[MAX_CONTINUOUS_CHANNELS];
+unsigned char ContinuousAdc::_count = 0;
+volatile unsigned char ContinuousAdc::_current = 0;
+volatile unsigned long ContinuousAdc::_conversions = 0;
+bool ContinuousAdc::_running = false;
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/*                                                                                       */
+/* Timer and ADC of the board																														 */
+/*                                                                                       */
+///////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega2560__)
+
+#include <avr/interrupt.h>
+
+/* The ADC takes 13 cycles of its 125 kHz clock per conversion */
+#define ADC_MIN_PERIOD		120
+
+/* Timer1 as the core set it up, for the PWM of its pins, given back by adcStop() */
+static uint8_t savedTCCR1A;
+static uint8_t savedTCCR1B;
+static uint16_t savedOCR1A;
+static uint16_t savedOCR1B;
+
+static void adcSelect(short int pin)
+{
+  uint8_t channel = pin >= A0 ? pin - A0 : pin;
+#if defined(MUX5)
+  ADCSRB = (ADCSRB & ~(1 << MUX5)) | ((channel & 0x08) ? (1 << MUX5) : 0);
+#endif
+  ADMUX = (1 << REFS0) | (channel & 0x07);
+}
+
+static bool adcStart(unsigned long periodMicros)
+{
+  /* Timer1 in CTC mode with a prescaler of 8, its compare match B triggers the conversions */
+  unsigned long ticks = periodMicros * (F_CPU / 1000000UL) / 8;
+  if(periodMicros < ADC_MIN_PERIOD || ticks > 65536UL)
+  {
+    return false;
+  }
+
+  noInterrupts();
+  savedTCCR1A = TCCR1A;
+  savedTCCR1B = TCCR1B;
+  savedOCR1A = OCR1A;
+  savedOCR1B = OCR1B;
+  TCCR1A = 0;
+  TCCR1B = 0;
+  TCNT1 = 0;
+  OCR1A = ticks - 1;
+  OCR1B = ticks - 1;
+  TIMSK1 = (1 << OCIE1B);
+  TCCR1B = (1 << WGM12) | (1 << CS11);
+  ADCSRB = (ADCSRB & ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0))) | (1 << ADTS2) | (1 << ADTS0);
+  ADCSRA = (1 << ADEN) | (1 << ADATE) | (1 << ADIE) | (1 << ADIF) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  interrupts();
+  return true;
+}
+
+static void adcStop()
+{
+  noInterrupts();
+  TCCR1B = 0;
+  TIMSK1 &= ~(1 << OCIE1B);
+  OCR1A = savedOCR1A;
+  OCR1B = savedOCR1B;
+  TCNT1 = 0;
+  TCCR1A = savedTCCR1A;
+  TCCR1B = savedTCCR1B;
+  ADCSRB &= ~((1 << ADTS2) | (1 << ADTS1) | (1 << ADTS0));
+  /* Back to the single conversions of analogRead() */
+  ADCSRA = (1 << ADEN) | (1 << ADIF) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+  interrupts();
+}
+
+/* The compare match only triggers the ADC, its interrupt clears the flag for the next one */
+EMPTY_INTERRUPT(TIMER1_COMPB_vect);
+
+ISR(ADC_vect)
+{
+  ContinuousAdc::conversionComplete(ADC);
+}
+
+#elif defined(ARDUINO_HOST)
+
+/* Conversions on the simulated clock, see HostSim.h */
+static void adcSelect(short int pin)
+{
+  hostAdcSelect(pin);
+}
+
+static bool adcStart(unsigned long periodMicros)
+{
+  return hostAdcStart(&ContinuousAdc::conversionComplete, periodMicros);
+}
+
+static void adcStop()
+{
+  hostAdcStop();
+}
+
+#else
+
+/* No free-running conversions on this board yet */
+static void adcSelect(short int pin)
+{
+}
+
+static bool adcStart(unsigned long periodMicros)
+{
+  return false;
+}
+
+static void adcStop()
+{
+}
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/*                                                                                       */
+/* Channels																																							 */
+/*                                                                                       */
+///////////////////////////////////////////////////////////////////////////////////////////
+
+int ContinuousAdc::add(short int pin)
+{
+  if(_running || _count >= MAX_CONTINUOUS_CHANNELS)
+  {
+    return -1;
+  }
+
+  int channel = channelOf(pin);
+  if(channel >= 0)
+  {
+    return channel;
+  }
+
+  pinMode(pin,INPUT);
+  adc_channel* c = &_channels[_count];
+  c->pin = pin;
+  c->head = 0;
+  c->tail = 0;
+  c->overruns = 0;
+  return _count++;
+}
+
+int ContinuousAdc::channelOf(short int pin)
+{
+  for(int i = 0; i < _count; i++)
+  {
+    if(_channels[i].pin == pin)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+void ContinuousAdc::clear()
+{
+  end();
+  _count = 0;
+}
+
+bool ContinuousAdc::begin(unsigned long periodMicros)
+{
+  if(_running || _count == 0)
+  {
+    return false;
+  }
+
+  for(int i = 0; i < _count; i++)
+  {
+    _channels[i].head = 0;
+    _channels[i].tail = 0;
+    _channels[i].overruns = 0;
+  }
+  _current = 0;
+  _conversions = 0;
+
+  adcSelect(_channels[0].pin);
+  _running = adcStart(periodMicros);
+  return _running;
+}
+
+void ContinuousAdc::end()
+{
+  if(_running)
+  {
+    adcStop();
+    _running = false;
+  }
+}
+
+bool ContinuousAdc::running()
+{
+  return _running;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/*                                                                                       */
+/* Queues																																								 */
+/*                                                                                       */
+///////////////////////////////////////////////////////////////////////////////////////////
+
+void ContinuousAdc::conversionComplete(uint16_t value)
+{
+  unsigned char current = _current;
+  adc_channel* c = &_channels[current];
+
+  /* The next conversion is started by the timer: select its pin now */
+  current = current + 1 == _count ? 0 : current + 1;
+  _current = current;
+  if(_count > 1)
+  {
+    adcSelect(_channels[current].pin);
+  }
+  _conversions = _conversions + 1;
+
+  unsigned char head = c->head;
+  unsigned char next = head + 1 == CONTINUOUS_QUEUE_SIZE ? 0 : head + 1;
+  if(next == c->tail)
+  {
+    c->overruns = c->overruns + 1;
+    return;
+  }
+
+  /* Publish the conversion only once it is stored */
+  c->samples[head] = value;
+  SENSOR_BARRIER();
+  c->head = next;
+}
+
+unsigned int ContinuousAdc::available(int channel)
+{
+  if(channel < 0 || channel >= _count)
+  {
+    return 0;
+  }
+
+  unsigned char head = _channels[channel].head;
+  unsigned char tail = _channels[channel].tail;
+  return head >= tail ? head - tail : head + CONTINUOUS_QUEUE_SIZE - tail;
+}
+
+bool ContinuousAdc::take(int channel, uint16_t* sample)
+{
+  if(channel < 0 || channel >= _count)
+  {
+    return false;
+  }
+
+  adc_channel* c = &_channels[channel];
+  unsigned char tail = c->tail;
+  if(tail == c->head)
+  {
+    return false;
+  }
+
+  /* Free the slot only once the conversion is read */
+  *sample = c->samples[tail];
+  SENSOR_BARRIER();
+  c->tail = tail + 1 == CONTINUOUS_QUEUE_SIZE ? 0 : tail + 1;
+  return true;
+}
+
+unsigned long ContinuousAdc::overruns(int channel)
+{
+  if(channel < 0 || channel >= _count)
+  {
+    return 0;
+  }
+
+  unsigned long overruns;
+  SENSOR_ATOMIC
+  {
+    overruns = _channels[channel].overruns;
+  }
+  return overruns;
+}
+
+unsigned long ContinuousAdc::conversions()
+{
+  unsigned long conversions;
+  SENSOR_ATOMIC
+  {
+    conversions = _conversions;
+  }
+  return conversions;
+}
+
+int ContinuousAdc::getChannelsCount()
+{
+  return _count;
+}
+
+#else
+
+/* Without SENSOR_CONTINUOUS_ADC there are no queues and no interrupt: no pin can be added */
+int ContinuousAdc::add(short int pin)
+{
+  return -1;
+}
+
+int ContinuousAdc::channelOf(short int pin)
+{
+  return -1;
+}
+
+void ContinuousAdc::clear()
+{
+}
+
+bool ContinuousAdc::begin(unsigned long periodMicros)
+{
+  return false;
+}
+
+void ContinuousAdc::end()
+{
+}
+
+bool ContinuousAdc::running()
+{
+  return false;
+}
+
+void ContinuousAdc::conversionComplete(uint16_t value)
+{
+}
+
+unsigned int ContinuousAdc::available(int channel)
+{
+  return 0;
+}
+
+bool ContinuousAdc::take(int channel, uint16_t* sample)
+{
+  return false;
+}
+
+unsigned long ContinuousAdc::overruns(int channel)
+{
+  return 0;
+}
+
+unsigned long ContinuousAdc::conversions()
+{
+  return 0;
+}
+
+int ContinuousAdc::getChannelsCount()
+{
+  return 0;
+}
+
+#endif
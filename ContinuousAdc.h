@@ -0,0 +1,95 @@
+#ifndef ContinuousAdc_h
+#define ContinuousAdc_h
+
+#include "Arduino.h"
+#include "SensorConfig.h"
+
+#ifndef MAX_CONTINUOUS_CHANNELS
+	#if defined(__AVR__)
+		#define MAX_CONTINUOUS_CHANNELS		4
+	#else
+		#define MAX_CONTINUOUS_CHANNELS		8
+	#endif
+#endif
+
+/* Conversions queued per channel, plus one free slot. At most 256: the indexes are single bytes */
+#ifndef CONTINUOUS_QUEUE_SIZE
+	#if defined(__AVR__)
+		#define CONTINUOUS_QUEUE_SIZE		16
+	#else
+		#define CONTINUOUS_QUEUE_SIZE		64
+	#endif
+#endif
+
+/* A converted pin and the conversions waiting for loop() */
+typedef struct adc_channel {
+
+		short int pin;
+		uint16_t samples[CONTINUOUS_QUEUE_SIZE];
+		volatile unsigned char head;				// Position of the next conversion stored, moved by the interrupt only
+		volatile unsigned char tail;				// Position of the next conversion taken, moved by loop() only
+		volatile unsigned long overruns;		// Conversions lost because the queue was full
+
+	} adc_channel;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Free-running acquisition of analogic pins.																						*/
+/*																																											*/
+/* analogRead() waits for every conversion, so the sample rate depends on how busy			*/
+/* loop() is. Once begin() is called, a timer starts a conversion every periodMicros,		*/
+/* and the conversion complete interrupt queues the result on its channel and moves			*/
+/* the multiplexer to the next one: each of n channels gets a conversion every n				*/
+/* periods, with the jitter of the timer instead of the one of loop().									*/
+/*																																											*/
+/* Every queue has a single producer, the interrupt, and a single consumer, loop(): each	*/
+/* side only moves its own byte-sized index, so neither blocks interrupts. A conversion	*/
+/* that finds its queue full is dropped and counted as an overrun.												*/
+/*																																											*/
+/* Opt-in with SENSOR_CONTINUOUS_ADC (see SensorConfig.h): only then are the queues and	*/
+/* the ADC interrupt compiled, otherwise add() always fails and a sketch can have its		*/
+/* own ADC_vect. On the ATmega328P and ATmega2560 the timer is Timer1, unavailable to		*/
+/* Servo and to analogWrite() on its pins while running; end() gives its PWM setup back.	*/
+/* analogRead() must not be called while running. The host backend simulates the				*/
+/* interrupt on the simulated clock. begin() fails elsewhere.														*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class ContinuousAdc
+{
+	public:
+		/* add: a pin to convert, before begin(). Returns its channel, -1 if running or full */
+		static int add(short int pin);
+		/* channelOf: the channel of a pin, -1 if it has none */
+		static int channelOf(short int pin);
+		/* clear: stops the conversions and removes all the channels */
+		static void clear();
+
+		/* begin: starts a conversion every periodMicros, channels in turn. False if there is no	*/
+		/* channel, or if the board can't convert at that period																		*/
+		static bool begin(unsigned long periodMicros);
+		static void end();
+		static bool running();
+
+		/* available: conversions queued on the channel */
+		static unsigned int available(int channel);
+		/* take: the oldest conversion of the channel, false if there is none */
+		static bool take(int channel, uint16_t* sample);
+		/* overruns: conversions of the channel dropped because loop() didn't take them in time */
+		static unsigned long overruns(int channel);
+		/* conversions: conversions of all the channels since begin() */
+		static unsigned long conversions();
+		static int getChannelsCount();
+
+		/* conversionComplete: body of the conversion complete interrupt, for the code of the board */
+		static void conversionComplete(uint16_t value);
+
+	private:
+		static adc_channel _channels[MAX_CONTINUOUS_CHANNELS];
+		static unsigned char _count;
+		static volatile unsigned char _current;					// Channel being converted
+		static volatile unsigned long _conversions;
+		static bool _running;
+};
+
+#endif
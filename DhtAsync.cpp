@@ -0,0 +1,208 @@
+#include "Arduino.h"
+#include <SimpleDHT.h>
+#include "DhtAsync.h"
+#include "SensorConfig.h"
+
+dht_transaction DhtAsync::_transactions[MAX_DHT_DEVICES];
+
+/* attachInterrupt() takes no argument: one handler per slot, MAX_DHT_DEVICES of them */
+static void edge0() { DhtAsync::edge(0); }
+static void edge1() { DhtAsync::edge(1); }
+static void edge2() { DhtAsync::edge(2); }
+static void edge3() { DhtAsync::edge(3); }
+static void (* const edgeHandlers[MAX_DHT_DEVICES])() = { edge0, edge1, edge2, edge3 };
+
+bool DhtAsync::begin(short int pin)
+{
+  if(digitalPinToInterrupt(pin) == NOT_AN_INTERRUPT)
+  {
+    return false;
+  }
+
+  dht_transaction* transaction = DhtAsync::transactionFor(pin);
+  if(transaction == NULL)
+  {
+    return false;
+  }
+  if(transaction->state != DHT_IDLE || !DhtCache::due(pin))
+  {
+    return true;
+  }
+
+  /* Start pulse: the pin is held low until poll() releases it */
+  pinMode(pin,OUTPUT);
+  digitalWrite(pin,LOW);
+  transaction->started = millis();
+  transaction->state = DHT_STARTING;
+  return true;
+}
+
+bool DhtAsync::poll(short int pin)
+{
+  dht_transaction* transaction = NULL;
+  for(int i = 0; i < MAX_DHT_DEVICES; i++)
+  {
+    if(DhtAsync::_transactions[i].used && DhtAsync::_transactions[i].pin == pin)
+    {
+      transaction = &DhtAsync::_transactions[i];
+    }
+  }
+  if(transaction == NULL || transaction->state == DHT_IDLE)
+  {
+    return true;
+  }
+
+  unsigned long now = millis();
+  if(transaction->state == DHT_STARTING)
+  {
+    if(now - transaction->started < DHT_START_MILLIS)
+    {
+      return false;
+    }
+
+    /* Release the pin, the device answers within 40 us */
+    transaction->edges = 0;
+    transaction->lastEdge = micros();
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega168__)
+    /* The start pulse latched INTFn: writing a one clears it, so only the frame is captured */
+    EIFR = bit(digitalPinToInterrupt(pin));
+#endif
+    attachInterrupt(digitalPinToInterrupt(pin), edgeHandlers[transaction - DhtAsync::_transactions], FALLING);
+    digitalWrite(pin,HIGH);
+    pinMode(pin,INPUT);
+    transaction->started = now;
+    transaction->state = DHT_CAPTURING;
+    return false;
+  }
+
+  /* The frame is over once a whole frame is in and the line has been quiet for longer than a bit */
+  unsigned char edges = transaction->edges;
+  unsigned long quiet = 0;
+  SENSOR_ATOMIC
+  {
+    quiet = micros() - transaction->lastEdge;
+  }
+  bool complete = edges >= DHT_CAPTURE_EDGES || (edges >= DHT_FRAME_EDGES && quiet > 255);
+  if(!complete && now - transaction->started < DHT_FRAME_MILLIS)
+  {
+    return false;
+  }
+
+  DhtAsync::finish(transaction);
+  return true;
+}
+
+bool DhtAsync::busy(short int pin)
+{
+  for(int i = 0; i < MAX_DHT_DEVICES; i++)
+  {
+    if(DhtAsync::_transactions[i].used && DhtAsync::_transactions[i].pin == pin)
+    {
+      return DhtAsync::_transactions[i].state != DHT_IDLE;
+    }
+  }
+  return false;
+}
+
+int DhtAsync::decode(const volatile unsigned char* intervals, unsigned char count, float* temperature, float* humidity)
+{
+  if(count == 0)
+  {
+    return SimpleDHTErrStartLow;
+  }
+  if(count < DHT_FRAME_EDGES)
+  {
+    return SimpleDHTErrDataEOF;
+  }
+
+  /* The last 40 edges end the bits, MSB first: an early spurious edge comes before them */
+  const volatile unsigned char* bits = intervals + count - 40;
+  byte data[5] = { 0, 0, 0, 0, 0 };
+  for(int i = 0; i < 40; i++)
+  {
+    data[i / 8] <<= 1;
+    if(bits[i] > DHT_ONE_MICROS)
+    {
+      data[i / 8] |= 0x01;
+    }
+  }
+
+  if((byte)(data[0] + data[1] + data[2] + data[3]) != data[4])
+  {
+    return SimpleDHTErrDataChecksum;
+  }
+
+  /* Integral and decimal bytes, the sign is the high bit of the decimal byte of temperature */
+  *humidity = data[0] + data[1] * 0.1;
+  *temperature = data[2] + (data[3] & 0x7F) * 0.1;
+  if(data[3] & 0x80)
+  {
+    *temperature = -*temperature;
+  }
+  return SimpleDHTErrSuccess;
+}
+
+void DhtAsync::clear()
+{
+  for(int i = 0; i < MAX_DHT_DEVICES; i++)
+  {
+    dht_transaction* transaction = &DhtAsync::_transactions[i];
+    if(transaction->used && transaction->state == DHT_CAPTURING)
+    {
+      detachInterrupt(digitalPinToInterrupt(transaction->pin));
+    }
+    transaction->state = DHT_IDLE;
+    transaction->used = false;
+  }
+}
+
+void DhtAsync::edge(int slot)
+{
+  dht_transaction* transaction = &DhtAsync::_transactions[slot];
+  unsigned long now = micros();
+  unsigned long interval = now - transaction->lastEdge;
+  transaction->lastEdge = now;
+
+  unsigned char edges = transaction->edges;
+  if(edges < DHT_CAPTURE_EDGES)
+  {
+    transaction->intervals[edges] = interval > 255 ? 255 : interval;
+    transaction->edges = edges + 1;
+  }
+}
+
+dht_transaction* DhtAsync::transactionFor(short int pin)
+{
+  dht_transaction* slot = NULL;
+  for(int i = 0; i < MAX_DHT_DEVICES; i++)
+  {
+    if(!DhtAsync::_transactions[i].used)
+    {
+      slot = slot == NULL ? &DhtAsync::_transactions[i] : slot;
+    } else if(DhtAsync::_transactions[i].pin == pin) {
+      return &DhtAsync::_transactions[i];
+    }
+  }
+
+  /* New device: take a free slot, there are as many as in DhtCache */
+  if(slot != NULL)
+  {
+    slot->pin = pin;
+    slot->state = DHT_IDLE;
+    slot->used = true;
+  }
+  return slot;
+}
+
+void DhtAsync::finish(dht_transaction* transaction)
+{
+  detachInterrupt(digitalPinToInterrupt(transaction->pin));
+
+  float temperature = 0;
+  float humidity = 0;
+  int error = DhtAsync::decode(transaction->intervals, transaction->edges, &temperature, &humidity);
+
+  /* The device counts its recovery from the release of the pin */
+  DhtCache::store(transaction->pin, error, temperature, humidity, transaction->started);
+  transaction->state = DHT_IDLE;
+}
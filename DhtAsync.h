@@ -0,0 +1,78 @@
+#ifndef DhtAsync_h
+#define DhtAsync_h
+
+#include "Arduino.h"
+#include "DhtCache.h"
+
+/* Steps of a transaction */
+#define DHT_IDLE					0x00
+#define DHT_STARTING			0x01		// The pin is held low to wake the device up
+#define DHT_CAPTURING			0x02		// The interrupt records the falling edges of the frame
+
+#define DHT_START_MILLIS	20			// Start pulse, at least 18 ms for a DHT11
+#define DHT_FRAME_MILLIS	10			// Response and 40 bits take at most about 5.5 ms
+#define DHT_FRAME_EDGES		42			// Falling edges: response, one per bit, end of frame
+#define DHT_CAPTURE_EDGES	(DHT_FRAME_EDGES + 1)	// Room for a spurious edge at attachInterrupt()
+#define DHT_ONE_MICROS		100			// Between falling edges: 50 us low, then 26-28 us high for a 0, 70 us for a 1
+
+/* Transaction in progress on the DHT device of a pin */
+typedef struct dht_transaction {
+
+		short int pin;
+		unsigned char state;										// DHT_...
+		unsigned long started;									// millis() at the start of the step
+		volatile unsigned char edges;						// Falling edges captured
+		volatile unsigned long lastEdge;				// micros() at the last edge, or at the release of the pin
+		volatile unsigned char intervals[DHT_CAPTURE_EDGES];	// Microseconds before each edge, at most 255
+		bool used;															// Slot in use
+
+	} dht_transaction;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Non-blocking DHT11 transactions.																											*/
+/*																																											*/
+/* read2() spins for the whole transaction, over 20 ms, and the bit timing loops miss		*/
+/* serial input meanwhile. Here poll() holds the start pulse without waiting, then an		*/
+/* interrupt on the falling edges of the pin records the time since the previous edge,	*/
+/* which is all a bit takes: an edge costs a few microseconds of interrupt. Once the			*/
+/* frame is in, or after DHT_FRAME_MILLIS, poll() decodes it from loop() and stores the	*/
+/* result in DhtCache, where the DHT readings of the sensors find it.										*/
+/*																																											*/
+/* The start pulse is a falling edge too: on AVR it raises the interrupt flag before		*/
+/* attachInterrupt(), which then runs the handler at once. poll() clears the flag where	*/
+/* the interrupt number is the INTn bit (ATmega328P and 168), and decode() only reads		*/
+/* the last 41 intervals, so an early edge never shifts the bits on the other boards.		*/
+/*																																											*/
+/* The pin must have an external interrupt (2 or 3 on an Uno, any pin on a Due),				*/
+/* otherwise begin() fails and readings go on through read2().													*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class DhtAsync
+{
+	public:
+		/* begin: starts a transaction on the pin unless one is running, or DhtCache can't poll the device yet.	*/
+		/* False if the pin has no interrupt																																			*/
+		static bool begin(short int pin);
+
+		/* poll: moves the transaction of the pin on, true once there is none running */
+		static bool poll(short int pin);
+		static bool busy(short int pin);
+
+		/* decode: SimpleDHT error of a frame of count edge intervals, and its values if it succeeded. The last 41 are read */
+		static int decode(const volatile unsigned char* intervals, unsigned char count, float* temperature, float* humidity);
+
+		/* clear: stops all the transactions */
+		static void clear();
+
+		/* edge: body of the interrupt of a slot */
+		static void edge(int slot);
+
+	private:
+		static dht_transaction _transactions[MAX_DHT_DEVICES];
+		static dht_transaction* transactionFor(short int pin);
+		static void finish(dht_transaction* transaction);
+};
+
+#endif
@@ -0,0 +1,107 @@
+#include "Arduino.h"
+#include <SimpleDHT.h>
+#include "DhtCache.h"
+#include "DhtAsync.h"
+
+dht_sample DhtCache::_samples[MAX_DHT_DEVICES];
+
+const dht_sample* DhtCache::read(short int pin)
+{
+  dht_sample* sample = DhtCache::sampleFor(pin);
+  unsigned long now = millis();
+
+  /* The device has not recovered from the last transaction, or is answering a non-blocking one */
+  if(!DhtCache::due(pin) || DhtAsync::busy(pin))
+  {
+    return sample;
+  }
+
+  float temperature = 0;
+  float humidity = 0;
+  SimpleDHT11 dht((int)pin);
+
+  pinMode(pin,INPUT);
+  int error = dht.read2(&temperature,&humidity,NULL);
+  DhtCache::store(pin, error, temperature, humidity, now);
+
+  return sample;
+}
+
+bool DhtCache::due(short int pin)
+{
+  dht_sample* sample = DhtCache::sampleFor(pin);
+  return !sample->polled || millis() - sample->lastAttempt >= DHT_MIN_INTERVAL;
+}
+
+void DhtCache::store(short int pin, int error, float temperature, float humidity, unsigned long attempt)
+{
+  dht_sample* sample = DhtCache::sampleFor(pin);
+  sample->lastError = error;
+  sample->lastAttempt = attempt;
+  sample->polled = true;
+
+  if(error == SimpleDHTErrSuccess)
+  {
+    sample->temperature = temperature;
+    sample->humidity = humidity;
+    sample->timestamp = attempt;
+    sample->valid = true;
+  }
+}
+
+void DhtCache::invalidate(short int pin)
+{
+  for(int i = 0; i < MAX_DHT_DEVICES; i++)
+  {
+    if(DhtCache::_samples[i].used && DhtCache::_samples[i].pin == pin)
+    {
+      DhtCache::_samples[i].polled = false;
+    }
+  }
+}
+
+void DhtCache::clear()
+{
+  for(int i = 0; i < MAX_DHT_DEVICES; i++)
+  {
+    DhtCache::_samples[i].used = false;
+  }
+}
+
+dht_sample* DhtCache::sampleFor(short int pin)
+{
+  for(int i = 0; i < MAX_DHT_DEVICES; i++)
+  {
+    if(DhtCache::_samples[i].used && DhtCache::_samples[i].pin == pin)
+    {
+      return &DhtCache::_samples[i];
+    }
+  }
+
+  /* New device: take a free slot, or recycle the least recently polled one */
+  dht_sample* slot = &DhtCache::_samples[0];
+  for(int i = 0; i < MAX_DHT_DEVICES; i++)
+  {
+    if(!DhtCache::_samples[i].used)
+    {
+      slot = &DhtCache::_samples[i];
+      break;
+    }
+    if(DhtCache::_samples[i].lastAttempt < slot->lastAttempt)
+    {
+      slot = &DhtCache::_samples[i];
+    }
+  }
+
+  slot->pin = pin;
+  slot->temperature = 0;
+  slot->humidity = 0;
+  slot->valid = false;
+  slot->timestamp = 0;
+  slot->lastAttempt = 0;
+  slot->lastError = SimpleDHTErrSuccess;
+  slot->polled = false;
+  slot->used = true;
+
+  return slot;
+}
@@ -0,0 +1,59 @@
+#ifndef DhtCache_h
+#define DhtCache_h
+
+#include "Arduino.h"
+
+#define MAX_DHT_DEVICES		4
+#define DHT_MIN_INTERVAL	1000		// A DHT11 can't be polled more than once per second
+
+/* Last transaction with the DHT device on a pin */
+typedef struct dht_sample {
+
+		short int pin;
+		float temperature;
+		float humidity;
+		bool valid;											// True once a transaction succeeded
+		unsigned long timestamp;				// millis() at the last successful transaction
+		unsigned long lastAttempt;			// millis() at the last transaction, successful or not
+		int lastError;									// Result of the last transaction, SimpleDHTErrSuccess if it succeeded
+		bool polled;										// False until the first transaction, or after invalidate()
+		bool used;											// Slot in use
+
+	} dht_sample;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Per-pin DHT transaction cache.																												*/
+/*																																											*/
+/* A single read2() transaction returns both temperature and humidity, and blocks for		*/
+/* about 20 ms. Every Sensor bound to the same pin (typically a HYGROMETER and an				*/
+/* AIR_THERMOMETER) is served from the cached pair, and a new transaction is only done	*/
+/* once DHT_MIN_INTERVAL has elapsed since the previous one. While a DhtAsync						*/
+/* transaction is running on the pin, read() serves the cached pair as well.						*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class DhtCache
+{
+	public:
+		/* read: returns the sample for the pin, doing a transaction only if the device can be polled again. 	*/
+		/* When a transaction fails the previous values are kept, check valid and lastError.									*/
+		static const dht_sample* read(short int pin);
+
+		/* invalidate: forces a transaction on the next read of the pin, even within DHT_MIN_INTERVAL */
+		static void invalidate(short int pin);
+
+		/* clear: forgets all the devices */
+		static void clear();
+
+		/* due: true when the device of the pin can be polled again */
+		static bool due(short int pin);
+		/* store: records the outcome of a transaction done elsewhere, see DhtAsync.h. attempt is its millis() */
+		static void store(short int pin, int error, float temperature, float humidity, unsigned long attempt);
+
+	private:
+		static dht_sample _samples[MAX_DHT_DEVICES];
+		static dht_sample* sampleFor(short int pin);
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef FixedPoint_h
+#define FixedPoint_h
+
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Q16.16 fixed-point arithmetic, used by the SENSOR_FIXED_POINT read path.							*/
+/*																																											*/
+/* A fixed_t holds value * 65536 in a signed 32-bit integer: range about +-32768,				*/
+/* resolution 1/65536. Conversions round to the nearest and saturate. Products go				*/
+/* through a 64-bit intermediate, quotients through 32-bit divisions only, so nothing		*/
+/* here calls the software floating point routines of AVR, except the conversions				*/
+/* from and to float at the ends of the pipeline.																				*/
+/*																																											*/
+/* A slope is rounded to 1/65536, so a converted value can be off by up to						*/
+/* raw / 131072 (0.008 for a 10 bit reading of 1023) against the float path.						*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+typedef int32_t fixed_t;
+
+#define FIXED_FRACTION_BITS		16
+#define FIXED_ONE							((fixed_t)1 << FIXED_FRACTION_BITS)
+#define FIXED_MAX							((fixed_t)0x7FFFFFFF)
+#define FIXED_MIN							(-FIXED_MAX - 1)
+
+/* fixedFromFloat: nearest fixed_t to value, saturated */
+inline fixed_t fixedFromFloat(float value)
+{
+	float scaled = value * FIXED_ONE;
+	if(scaled >= 2147483647.0f)
+	{
+		return FIXED_MAX;
+	}
+	if(scaled <= -2147483648.0f)
+	{
+		return FIXED_MIN;
+	}
+	return (fixed_t)(scaled >= 0 ? scaled + 0.5f : scaled - 0.5f);
+}
+
+inline float fixedToFloat(fixed_t value)
+{
+	return value * (1.0f / FIXED_ONE);
+}
+
+/* fixedFromInt: value must be within +-32767. A multiplication, as shifting a negative value is undefined */
+inline fixed_t fixedFromInt(int32_t value)
+{
+	return value * FIXED_ONE;
+}
+
+/* fixedMultiply: a * b, rounded and saturated */
+inline fixed_t fixedMultiply(fixed_t a, fixed_t b)
+{
+	int64_t product = ((int64_t)a * b + (FIXED_ONE >> 1)) >> FIXED_FRACTION_BITS;
+	if(product > FIXED_MAX)
+	{
+		return FIXED_MAX;
+	}
+	if(product < FIXED_MIN)
+	{
+		return FIXED_MIN;
+	}
+	return (fixed_t)product;
+}
+
+/* fixedFromRatio: numerator / denominator, rounded, e.g. the average of an ADC sum.		*/
+/* denominator must be positive and below 32768, as numReadings is.											*/
+inline fixed_t fixedFromRatio(int32_t numerator, int32_t denominator)
+{
+	if(numerator < 0)
+	{
+		return -fixedFromRatio(-numerator, denominator);
+	}
+	uint32_t rest = numerator % denominator;
+	return fixedFromInt(numerator / denominator) + (fixed_t)(((rest << FIXED_FRACTION_BITS) + denominator / 2) / denominator);
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "Arduino.h"
+#include "OutputBuffer.h"
+
+OutputBuffer::OutputBuffer()
+{
+  this->configure(OUTPUT_DROP_NEWEST, 0, 0, 0);
+}
+
+void OutputBuffer::configure(unsigned char policy, unsigned int lowWatermark, unsigned int highWatermark, unsigned long maxDelay)
+{
+  this->_policy = policy;
+  this->_highWatermark = highWatermark > this->capacity() ? this->capacity() : highWatermark;
+  this->_lowWatermark = lowWatermark > this->_highWatermark ? this->_highWatermark : lowWatermark;
+  this->_maxDelay = maxDelay;
+  this->_head = 0;
+  this->_tail = 0;
+  this->_dropped = 0;
+  this->_draining = false;
+  this->_flushing = false;
+}
+
+size_t OutputBuffer::write(const byte* data, size_t length)
+{
+  if(this->_head == this->_tail)
+  {
+    this->_queuedSince = millis();
+  }
+
+  size_t written = 0;
+  while(written < length)
+  {
+    unsigned int next = this->_head + 1 == OUTPUT_BUFFER_SIZE ? 0 : this->_head + 1;
+    if(next == this->_tail)
+    {
+      /* Full: the oldest byte makes room, or the rest is dropped */
+      if(this->_policy != OUTPUT_DROP_OLDEST)
+      {
+        if(this->_policy == OUTPUT_DROP_NEWEST)
+        {
+          this->_dropped += length - written;
+        }
+        break;
+      }
+      this->_tail = this->_tail + 1 == OUTPUT_BUFFER_SIZE ? 0 : this->_tail + 1;
+      this->_dropped++;
+    }
+
+    this->_data[this->_head] = data[written++];
+    this->_head = next;
+  }
+  return written;
+}
+
+bool OutputBuffer::due()
+{
+  unsigned int level = this->level();
+  if(level == 0)
+  {
+    this->_draining = false;
+    this->_flushing = false;
+    return false;
+  }
+
+  if(!this->_draining)
+  {
+    if(this->_flushing || millis() - this->_queuedSince >= this->_maxDelay)
+    {
+      this->_draining = true;
+      this->_drainTarget = 0;
+    } else if(level >= this->_highWatermark) {
+      this->_draining = true;
+      this->_drainTarget = this->_lowWatermark;
+    }
+  }
+
+  /* Back to the low watermark: the rest waits for more bytes, or for maxDelay */
+  if(this->_draining && level <= this->_drainTarget)
+  {
+    this->_draining = false;
+    this->_queuedSince = millis();
+  }
+  return this->_draining;
+}
+
+int OutputBuffer::take()
+{
+  if(this->_tail == this->_head)
+  {
+    return -1;
+  }
+  int value = this->_data[this->_tail];
+  this->_tail = this->_tail + 1 == OUTPUT_BUFFER_SIZE ? 0 : this->_tail + 1;
+  return value;
+}
+
+void OutputBuffer::flush()
+{
+  this->_drainTarget = 0;
+  this->_flushing = true;
+}
+
+unsigned int OutputBuffer::level()
+{
+  return this->_head >= this->_tail ? this->_head - this->_tail : this->_head + OUTPUT_BUFFER_SIZE - this->_tail;
+}
+
+unsigned long OutputBuffer::dropped()
+{
+  return this->_dropped;
+}
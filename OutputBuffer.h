@@ -0,0 +1,73 @@
+#ifndef OutputBuffer_h
+#define OutputBuffer_h
+
+#include "Arduino.h"
+
+#ifndef OUTPUT_BUFFER_SIZE
+	#if defined(__AVR__)
+		#define OUTPUT_BUFFER_SIZE	64
+	#else
+		#define OUTPUT_BUFFER_SIZE	256
+	#endif
+#endif
+
+/* What a write does when the buffer is full */
+#define OUTPUT_DROP_NEWEST		0x00		// The bytes that don't fit are dropped
+#define OUTPUT_DROP_OLDEST		0x01		// The oldest bytes are dropped to make room
+#define OUTPUT_BLOCK					0x02		// The writer sends bytes to the sink until they fit
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Byte queue between the messages of the sensors and a slow sink.											*/
+/*																																											*/
+/* Writes only copy bytes, the sink is fed by take(), a byte at a time, from loop().		*/
+/* due() tells when to send: once highWatermark bytes are queued												*/
+/* it stays true until the queue is back to lowWatermark, so small lines go out in			*/
+/* bursts. Bytes queued for maxDelay milliseconds, or a flush(), empty the queue.				*/
+/*																																											*/
+/* Writer and reader both run from loop(), so the buffer has no volatile state nor			*/
+/* atomic sections: none of it may be used from an interrupt. The Arduino cores have no	*/
+/* TX-empty hook to drain from anyway, HardwareSerial owns USART_UDRE_vect.							*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class OutputBuffer
+{
+	public:
+		OutputBuffer();
+
+		/* configure: empties the buffer and sets its policy, watermarks are clamped to the capacity */
+		void configure(unsigned char policy, unsigned int lowWatermark, unsigned int highWatermark, unsigned long maxDelay);
+
+		/* write: queues bytes as the policy allows, returns the bytes queued. With OUTPUT_BLOCK it stops when full */
+		size_t write(const byte* data, size_t length);
+
+		/* due: true while queued bytes should be sent to the sink */
+		bool due();
+		/* take: the oldest byte, removed from the queue, -1 if empty */
+		int take();
+		/* flush: makes all the queued bytes due */
+		void flush();
+
+		unsigned int level();
+		unsigned int capacity() const { return OUTPUT_BUFFER_SIZE - 1; }
+		unsigned char policy() const { return this->_policy; }
+		/* dropped: bytes lost to overflow since configure() */
+		unsigned long dropped();
+
+	private:
+		byte _data[OUTPUT_BUFFER_SIZE];
+		unsigned int _head;						// Position of the next byte written
+		unsigned int _tail;						// Position of the next byte taken
+		unsigned long _dropped;
+		unsigned char _policy;
+		unsigned int _lowWatermark;
+		unsigned int _highWatermark;
+		unsigned long _maxDelay;
+		unsigned long _queuedSince;				// millis() when the buffer stopped being empty
+		bool _draining;							// Sending until _drainTarget bytes are left
+		unsigned int _drainTarget;
+		bool _flushing;
+};
+
+#endif
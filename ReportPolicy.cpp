@@ -0,0 +1,68 @@
+#include "Arduino.h"
+#include "ReportPolicy.h"
+
+static bool reportRuleFires(const report_policy& policy, const report_state& state, float value, unsigned long now)
+{
+  if(policy.mode == REPORT_ALWAYS || !state.reported)
+  {
+    return true;
+  }
+
+  unsigned long elapsed = now - state.reportedTime;
+  if(elapsed < policy.minInterval)
+  {
+    return false;
+  }
+  if(policy.maxInterval > 0 && elapsed >= policy.maxInterval)
+  {
+    return true;
+  }
+
+  /* Deadband around the last value sent */
+  float band = policy.absoluteDeadband;
+  float relative = policy.relativeDeadband * fabs(state.reportedValue);
+  if(relative > band)
+  {
+    band = relative;
+  }
+  if(fabs(value - state.reportedValue) > band)
+  {
+    return true;
+  }
+
+  /* Rate of change since the previous reading, per second */
+  if(policy.rateThreshold > 0 && state.hasPrevious && now != state.previousTime)
+  {
+    float rate = fabs(value - state.previousValue) * 1000.0 / (now - state.previousTime);
+    if(rate > policy.rateThreshold)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool reportDue(const report_policy& policy, report_state& state, float value, unsigned long now)
+{
+  bool due = reportRuleFires(policy, state, value, now);
+  if(due)
+  {
+    state.reported = true;
+    state.reportedValue = value;
+    state.reportedTime = now;
+    state.sent++;
+  } else {
+    state.suppressed++;
+  }
+
+  state.hasPrevious = true;
+  state.previousValue = value;
+  state.previousTime = now;
+  return due;
+}
+
+void reportReset(report_state& state)
+{
+  state.reported = false;
+  state.hasPrevious = false;
+}
@@ -0,0 +1,54 @@
+#ifndef ReportPolicy_h
+#define ReportPolicy_h
+
+#include "Arduino.h"
+
+/* Modes of a report policy */
+#define REPORT_ALWAYS					0x00		// Every reading is sent, the default
+#define REPORT_ON_CHANGE			0x01		// Readings are sent when the rules below fire
+
+/* When printAll() sends the reading of a sensor. Zero is REPORT_ALWAYS */
+typedef struct report_policy {
+
+		unsigned char mode;							// REPORT_...
+		float absoluteDeadband;					// Changes since the last report up to this are not sent
+		float relativeDeadband;					// Nor those up to this fraction of the last value sent, the larger band applies
+		float rateThreshold;						// Sent anyway when the value moves faster than this per second, 0 to disable
+		unsigned long minInterval;			// Milliseconds after a report before the next one, 0 for none
+		unsigned long maxInterval;			// Heartbeat: a reading is sent at least this often, 0 for never
+
+	} report_policy;
+
+/* What a policy decides from, and what it decided */
+typedef struct report_state {
+
+		bool reported;									// False until the first report
+		float reportedValue;						// Value of the last report
+		unsigned long reportedTime;			// millis() of the last report
+		bool hasPrevious;								// False until the first reading
+		float previousValue;						// Last reading, for the rate of change
+		unsigned long previousTime;
+		unsigned long sent;							// Readings sent
+		unsigned long suppressed;				// Readings held back
+
+	} report_state;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Change-driven reporting.																															*/
+/*																																											*/
+/* With REPORT_ON_CHANGE a reading is sent when it left the deadband around the last		*/
+/* value sent, or when it changed faster than rateThreshold since the previous reading,	*/
+/* but never sooner than minInterval after the last report. A reading is sent anyway		*/
+/* maxInterval after the last report, so receivers can tell a steady sensor from a dead	*/
+/* one. With both deadbands at 0 any change is sent. The first reading is always sent.		*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+/* reportDue: whether the reading value taken at now must be sent. Counts it in state as sent or suppressed */
+bool reportDue(const report_policy& policy, report_state& state, float value, unsigned long now);
+
+/* reportReset: forgets the last report, so the next reading is sent. The counters are kept */
+void reportReset(report_state& state);
+
+#endif
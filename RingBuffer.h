@@ -0,0 +1,149 @@
+#ifndef RingBuffer_h
+#define RingBuffer_h
+
+#include "SensorConfig.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Fixed-capacity ring buffer, with no heap allocation.																	*/
+/*																																											*/
+/* push() is O(1) and overwrites the oldest element when the buffer is full. Elements		*/
+/* are indexed from the oldest (0) to the newest (size() - 1).													*/
+/*																																											*/
+/* A single producer may push from an ISR while loop() reads: the element is stored			*/
+/* before the indexes are published, and readers take the indexes atomically. Use				*/
+/* snapshot() to iterate over a consistent range; if pushes() changed meanwhile, the		*/
+/* oldest elements of the range may have been overwritten by newer ones.								*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T, unsigned int N>
+class RingBuffer
+{
+	public:
+
+		/* Iterates from the oldest to the newest element, reading in place */
+		class Iterator
+		{
+			public:
+				Iterator(const T* data, unsigned int start, unsigned int position) : _data(data), _start(start), _position(position) { }
+
+				const T& operator*() const
+				{
+					unsigned int index = this->_start + this->_position;
+					return this->_data[index >= N ? index - N : index];
+				}
+
+				Iterator& operator++() { this->_position++; return *this; }
+				bool operator==(const Iterator& other) const { return this->_position == other._position; }
+				bool operator!=(const Iterator& other) const { return this->_position != other._position; }
+
+			private:
+				const T* _data;
+				unsigned int _start;
+				unsigned int _position;
+		};
+
+		/* A range of the buffer, fixed when it is taken */
+		class Snapshot
+		{
+			public:
+				Snapshot(const T* data, unsigned int start, unsigned int count) : _data(data), _start(start), _count(count) { }
+
+				unsigned int size() const { return this->_count; }
+				const T& operator[](unsigned int index) const { return *Iterator(this->_data, this->_start, index); }
+				Iterator begin() const { return Iterator(this->_data, this->_start, 0); }
+				Iterator end() const { return Iterator(this->_data, this->_start, this->_count); }
+
+			private:
+				const T* _data;
+				unsigned int _start;
+				unsigned int _count;
+		};
+
+		RingBuffer() : _head(0), _count(0), _pushes(0) { }
+
+		/* push: adds an element, dropping the oldest one if the buffer is full */
+		void push(const T& value)
+		{
+			unsigned int head = this->_head;
+			this->_data[head] = value;
+
+			/* Publish the element only once it is stored */
+			SENSOR_BARRIER();
+			SENSOR_ATOMIC
+			{
+				this->_head = head + 1 == N ? 0 : head + 1;
+				if(this->_count < N)
+				{
+					this->_count = this->_count + 1;
+				}
+				this->_pushes = this->_pushes + 1;
+			}
+		}
+
+		/* clear: empties the buffer. Not to be used while a producer may push */
+		void clear()
+		{
+			SENSOR_ATOMIC
+			{
+				this->_head = 0;
+				this->_count = 0;
+			}
+		}
+
+		unsigned int size() const
+		{
+			unsigned int count;
+			SENSOR_ATOMIC
+			{
+				count = this->_count;
+			}
+			return count;
+		}
+
+		unsigned int capacity() const { return N; }
+		bool empty() const { return this->size() == 0; }
+		bool full() const { return this->size() == N; }
+
+		/* pushes: total number of elements ever pushed, including overwritten ones */
+		unsigned long pushes() const
+		{
+			unsigned long pushes;
+			SENSOR_ATOMIC
+			{
+				pushes = this->_pushes;
+			}
+			return pushes;
+		}
+
+		/* snapshot: the elements currently in the buffer, from the oldest to the newest */
+		Snapshot snapshot() const
+		{
+			unsigned int head;
+			unsigned int count;
+			SENSOR_ATOMIC
+			{
+				head = this->_head;
+				count = this->_count;
+			}
+			unsigned int start = head >= count ? head - count : head + N - count;
+			return Snapshot(this->_data, start, count);
+		}
+
+		/* operator[]: 0 is the oldest element, size() - 1 the newest */
+		const T& operator[](unsigned int index) const { return this->snapshot()[index]; }
+		const T& oldest() const { return (*this)[0]; }
+		const T& newest() const { return (*this)[this->size() - 1]; }
+
+		Iterator begin() const { return this->snapshot().begin(); }
+		Iterator end() const { return this->snapshot().end(); }
+
+	private:
+		T _data[N];
+		volatile unsigned int _head;				// Position of the next push
+		volatile unsigned int _count;				// Elements in the buffer, up to N
+		volatile unsigned long _pushes;
+};
+
+#endif
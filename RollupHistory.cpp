@@ -0,0 +1,221 @@
+#include "Arduino.h"
+#include "RollupHistory.h"
+
+#if MAX_ROLLUP_HISTORIES > 0
+RollupHistory RollupHistory::_pool[MAX_ROLLUP_HISTORIES];
+#endif
+
+RollupHistory::RollupHistory()
+{
+  this->defaultPeriods();
+  this->_used = false;
+  this->clear();
+}
+
+RollupHistory* RollupHistory::acquire()
+{
+#if MAX_ROLLUP_HISTORIES > 0
+  for(int i = 0; i < MAX_ROLLUP_HISTORIES; i++)
+  {
+    if(!_pool[i]._used)
+    {
+      _pool[i].defaultPeriods();
+      _pool[i].clear();
+      _pool[i]._used = true;
+      return &_pool[i];
+    }
+  }
+#endif
+  return NULL;
+}
+
+void RollupHistory::release(RollupHistory* history)
+{
+#if MAX_ROLLUP_HISTORIES > 0
+  for(int i = 0; i < MAX_ROLLUP_HISTORIES; i++)
+  {
+    if(history == &_pool[i])
+    {
+      _pool[i]._used = false;
+    }
+  }
+#endif
+}
+
+unsigned char RollupHistory::historiesInUse()
+{
+  unsigned char count = 0;
+#if MAX_ROLLUP_HISTORIES > 0
+  for(int i = 0; i < MAX_ROLLUP_HISTORIES; i++)
+  {
+    if(_pool[i]._used)
+    {
+      count++;
+    }
+  }
+#endif
+  return count;
+}
+
+bool RollupHistory::setPeriod(unsigned char tier, unsigned long period)
+{
+  if(tier >= ROLLUP_TIERS || period == 0)
+  {
+    return false;
+  }
+  if(tier > 0 && period % this->_periods[tier - 1] != 0)
+  {
+    return false;
+  }
+  if(tier + 1 < ROLLUP_TIERS && this->_periods[tier + 1] % period != 0)
+  {
+    return false;
+  }
+
+  this->_periods[tier] = period;
+  this->clear();
+  return true;
+}
+
+unsigned long RollupHistory::period(unsigned char tier) const
+{
+  return tier < ROLLUP_TIERS ? this->_periods[tier] : 0;
+}
+
+void RollupHistory::defaultPeriods()
+{
+  unsigned long period = ROLLUP_FIRST_PERIOD;
+  for(int i = 0; i < ROLLUP_TIERS; i++)
+  {
+    this->_periods[i] = period;
+    period *= 60;
+  }
+}
+
+void RollupHistory::clear()
+{
+  for(int i = 0; i < ROLLUP_TIERS; i++)
+  {
+    this->_tiers[i].clear();
+    this->_open[i].count = 0;
+  }
+}
+
+void RollupHistory::add(float value, unsigned long time)
+{
+  rollup_bucket reading = { time, value, value, value, 1 };
+  this->fold(0, reading);
+}
+
+const RingBuffer<rollup_bucket, ROLLUP_SLOTS>& RollupHistory::buckets(unsigned char tier) const
+{
+  return this->_tiers[tier < ROLLUP_TIERS ? tier : 0];
+}
+
+const rollup_bucket& RollupHistory::open(unsigned char tier) const
+{
+  return this->_open[tier < ROLLUP_TIERS ? tier : 0];
+}
+
+void RollupHistory::fold(unsigned char tier, const rollup_bucket& bucket)
+{
+  rollup_bucket* open = &this->_open[tier];
+  unsigned long period = this->_periods[tier];
+
+  /* Past the period of the open bucket: close it, and pass it on to the coarser tier */
+  if(open->count > 0 && (long)(bucket.start - open->start) >= (long)period)
+  {
+    this->_tiers[tier].push(*open);
+    if(tier + 1 < ROLLUP_TIERS)
+    {
+      this->fold(tier + 1, *open);
+    }
+    open->count = 0;
+  }
+
+  if(open->count == 0)
+  {
+    *open = bucket;
+    open->start = bucket.start - bucket.start % period;
+    return;
+  }
+  RollupHistory::merge(*open, bucket);
+}
+
+bool RollupHistory::covers(unsigned char tier, unsigned long from) const
+{
+  const RingBuffer<rollup_bucket, ROLLUP_SLOTS>& ring = this->_tiers[tier];
+  if(ring.pushes() == ring.size())
+  {
+    return true;
+  }
+  return (long)(from - ring.oldest().start) >= 0;
+}
+
+int RollupHistory::query(unsigned long from, unsigned long to, rollup_bucket* result) const
+{
+  /* The coarsest tier that answers exactly, else the most precise one that has the whole range */
+  int tier = -1;
+  for(int i = ROLLUP_TIERS - 1; i >= 0 && tier < 0; i--)
+  {
+    if(from % this->_periods[i] == 0 && to % this->_periods[i] == 0 && this->covers(i, from))
+    {
+      tier = i;
+    }
+  }
+  for(int i = 0; i < ROLLUP_TIERS && tier < 0; i++)
+  {
+    if(this->covers(i, from))
+    {
+      tier = i;
+    }
+  }
+  if(tier < 0)
+  {
+    tier = ROLLUP_TIERS - 1;
+  }
+
+  /* Closed buckets of the tier, then the open buckets of the tier and the finer ones, not merged yet */
+  result->start = from;
+  result->count = 0;
+  RingBuffer<rollup_bucket, ROLLUP_SLOTS>::Snapshot closed = this->_tiers[tier].snapshot();
+  for(unsigned int i = 0; i < closed.size(); i++)
+  {
+    if(this->overlaps(tier, closed[i].start, from, to))
+    {
+      RollupHistory::merge(*result, closed[i]);
+    }
+  }
+  for(int i = tier; i >= 0; i--)
+  {
+    if(this->_open[i].count > 0 && this->overlaps(i, this->_open[i].start, from, to))
+    {
+      RollupHistory::merge(*result, this->_open[i]);
+    }
+  }
+  return result->count > 0 ? tier : -1;
+}
+
+bool RollupHistory::overlaps(unsigned char tier, unsigned long start, unsigned long from, unsigned long to) const
+{
+  return (long)(start + this->_periods[tier] - from) > 0 && (long)(to - start) > 0;
+}
+
+void RollupHistory::merge(rollup_bucket& into, const rollup_bucket& bucket)
+{
+  if(into.count == 0)
+  {
+    into.minimum = bucket.minimum;
+    into.maximum = bucket.maximum;
+    into.sum = 0;
+  }
+  into.minimum = bucket.minimum < into.minimum ? bucket.minimum : into.minimum;
+  into.maximum = bucket.maximum > into.maximum ? bucket.maximum : into.maximum;
+  into.sum += bucket.sum;
+  into.count += bucket.count;
+}
+
+float rollupMean(const rollup_bucket& bucket)
+{
+  return bucket.count > 0 ? bucket.sum / bucket.count : 0;
+}
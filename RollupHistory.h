@@ -0,0 +1,109 @@
+#ifndef RollupHistory_h
+#define RollupHistory_h
+
+#include "Arduino.h"
+#include "RingBuffer.h"
+
+/* Tiers of a history, from the finest. Tier i lasts ROLLUP_FIRST_PERIOD * 60^i by default */
+#ifndef ROLLUP_TIERS
+	#define ROLLUP_TIERS					2
+#endif
+#define ROLLUP_FIRST_PERIOD			60000UL			// One minute
+
+/* Closed buckets kept by each tier, and histories in the pool. The pool is empty on AVR by default: a	*/
+/* day of hourly buckets, ROLLUP_SLOTS 24, takes 2 * 24 * 20 + 60 = about 1 KB per history, half the	*/
+/* RAM of an Uno. Sketches that can afford it define MAX_ROLLUP_HISTORIES in their build flags				*/
+#ifndef ROLLUP_SLOTS
+	#define ROLLUP_SLOTS					48
+#endif
+#ifndef MAX_ROLLUP_HISTORIES
+	#if defined(__AVR__)
+		#define MAX_ROLLUP_HISTORIES	0
+	#else
+		#define MAX_ROLLUP_HISTORIES	4
+	#endif
+#endif
+
+/* Aggregate of the readings of a period */
+typedef struct rollup_bucket {
+
+		unsigned long start;						// millis() at the start of the period, a multiple of it
+		float minimum;
+		float maximum;
+		float sum;											// Mean is sum / count
+		unsigned long count;						// Readings, 0 for an empty bucket
+
+	} rollup_bucket;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Readings history at coarser resolutions, e.g. per minute and per hour.								*/
+/*																																											*/
+/* A reading goes into the open bucket of the finest tier. When a reading falls past			*/
+/* its period, the bucket is closed: it is kept in the ring of its tier, and merged into	*/
+/* the open bucket of the next tier, which closes the same way. A reading is thus O(1),	*/
+/* and a tier keeps ROLLUP_SLOTS periods: 48 minutes and 48 hours by default. Periods			*/
+/* with no readings take no bucket. The raw readings are the history of the sensor.			*/
+/*																																											*/
+/* Histories come from a static pool, ROLLUP_TIERS * ROLLUP_SLOTS * 20 bytes each, so		*/
+/* the RAM used is fixed at compile time. A sensor keeps one with setRollup(). A tier		*/
+/* answers ROLLUP_SLOTS periods back: 24 hourly slots are needed for the trend of a day.	*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class RollupHistory
+{
+	public:
+		RollupHistory();
+
+		/* acquire: an empty history from the pool, with the default periods. NULL if the pool is full */
+		static RollupHistory* acquire();
+		static void release(RollupHistory* history);
+		/* Pool histories in use */
+		static unsigned char historiesInUse();
+
+		/* setPeriod: milliseconds of the buckets of a tier, a multiple of the period of the finer tier that divides the	*/
+		/* period of the coarser one. Clears the history. False if the period doesn't fit											*/
+		bool setPeriod(unsigned char tier, unsigned long period);
+		unsigned long period(unsigned char tier) const;
+		void clear();
+
+		/* add: a reading taken at time, in millis() */
+		void add(float value, unsigned long time);
+
+		/* buckets: the closed buckets of a tier, from the oldest */
+		const RingBuffer<rollup_bucket, ROLLUP_SLOTS>& buckets(unsigned char tier) const;
+		/* open: the bucket of a tier in progress, with a count of 0 if there is none */
+		const rollup_bucket& open(unsigned char tier) const;
+
+		/* query: aggregate of the readings of the buckets overlapping from up to to, excluded. Reads the coarsest		*/
+		/* tier whose periods fit the bounds and that still covers from, else the finest that covers it, whose			*/
+		/* buckets may extend past the bounds. Returns the tier read, -1 if there are no readings in the range				*/
+		int query(unsigned long from, unsigned long to, rollup_bucket* result) const;
+
+	private:
+		RingBuffer<rollup_bucket, ROLLUP_SLOTS> _tiers[ROLLUP_TIERS];
+		rollup_bucket _open[ROLLUP_TIERS];
+		unsigned long _periods[ROLLUP_TIERS];
+		bool _used;
+
+#if MAX_ROLLUP_HISTORIES > 0
+		static RollupHistory _pool[MAX_ROLLUP_HISTORIES];
+#endif
+
+		/* Default periods, a minute times 60^tier */
+		void defaultPeriods();
+
+		/* Adds bucket, starting in the period of tier or after it, to the open bucket of tier */
+		void fold(unsigned char tier, const rollup_bucket& bucket);
+		/* True if nothing tier dropped is newer than from */
+		bool covers(unsigned char tier, unsigned long from) const;
+		/* True if the bucket of tier starting at start overlaps from up to to */
+		bool overlaps(unsigned char tier, unsigned long start, unsigned long from, unsigned long to) const;
+		static void merge(rollup_bucket& into, const rollup_bucket& bucket);
+};
+
+/* rollupMean: mean of the readings of a bucket, 0 if it is empty */
+float rollupMean(const rollup_bucket& bucket);
+
+#endif
@@ -0,0 +1,204 @@
+#ifndef RunningStats_h
+#define RunningStats_h
+
+#include <math.h>
+#include "RingBuffer.h"
+
+#define DEFAULT_EWMA_ALPHA		0.2		// Weight of the newest value in the exponentially weighted moving average
+#define STATS_RESYNC_PUSHES		256		// Pushes between two exact recomputations of mean and variance
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Monotonic queue of window positions, used for sliding-window minimum and maximum.		*/
+/*																																											*/
+/* Positions are the low 8 bits of the push count of the window, so the window must be	*/
+/* smaller than 256 elements. Values are read back from the window itself.							*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <unsigned int N>
+class MonotonicQueue
+{
+	public:
+		MonotonicQueue() : _front(0), _count(0) { }
+
+		bool empty() const { return this->_count == 0; }
+		unsigned char front() const { return this->_positions[this->_front]; }
+		unsigned char back() const { return this->_positions[this->index(this->_count - 1)]; }
+		void popFront() { this->_front = this->index(1); this->_count--; }
+		void popBack() { this->_count--; }
+		void pushBack(unsigned char position) { this->_positions[this->index(this->_count)] = position; this->_count++; }
+		void clear() { this->_front = 0; this->_count = 0; }
+
+	private:
+		unsigned char _positions[N];
+		unsigned char _front;
+		unsigned char _count;
+
+		unsigned char index(unsigned char offset) const
+		{
+			unsigned int i = this->_front + offset;
+			return i >= N ? i - N : i;
+		}
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Incremental statistics over a sliding window of readings.														*/
+/*																																											*/
+/* The window is the readings history ring buffer: values are not copied. push() must		*/
+/* be called with each new value right before it is pushed in the window, and costs O(1)	*/
+/* amortised:																																						*/
+/*   - mean and variance are updated with Welford's method, adding the new value and			*/
+/*     removing the one leaving the window. They are recomputed exactly from the window		*/
+/*     every STATS_RESYNC_PUSHES pushes, so rounding errors can't accumulate;							*/
+/*   - minimum and maximum come from monotonic queues of window positions;							*/
+/*   - the EWMA covers all the values ever pushed.																			*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+template <unsigned int N>
+class RunningStats
+{
+	static_assert(N > 0 && N < 256, "RunningStats window must have between 1 and 255 elements");
+
+	public:
+		RunningStats() : _window(NULL), _ewmaAlpha(DEFAULT_EWMA_ALPHA) { this->clear(); }
+
+		/* attach: sets the window the statistics are computed on, and resets them */
+		void attach(const RingBuffer<float, N>* window)
+		{
+			this->_window = window;
+			this->clear();
+		}
+
+		/* push: accounts for value, which is about to be pushed in the window */
+		void push(float value)
+		{
+			const RingBuffer<float, N>& window = *this->_window;
+			unsigned char position = (unsigned char)window.pushes();
+			bool evicting = window.full();
+
+			/* Mean and variance */
+			if(evicting)
+			{
+				float evicted = window.oldest();
+				float mean = this->_mean + (value - evicted) / N;
+				this->_m2 += (value - evicted) * (value - mean + evicted - this->_mean);
+				this->_mean = mean;
+			} else {
+				this->_count++;
+				float delta = value - this->_mean;
+				this->_mean += delta / this->_count;
+				this->_m2 += delta * (value - this->_mean);
+			}
+			if(this->_m2 < 0)
+			{
+				this->_m2 = 0;
+			}
+
+			/* Minimum and maximum: drop the position leaving the window, then the ones that can't be extremes anymore */
+			unsigned char leaving = (unsigned char)(position - N);
+			if(evicting && !this->_minimum.empty() && this->_minimum.front() == leaving)
+			{
+				this->_minimum.popFront();
+			}
+			if(evicting && !this->_maximum.empty() && this->_maximum.front() == leaving)
+			{
+				this->_maximum.popFront();
+			}
+			while(!this->_minimum.empty() && this->valueAt(this->_minimum.back()) >= value)
+			{
+				this->_minimum.popBack();
+			}
+			while(!this->_maximum.empty() && this->valueAt(this->_maximum.back()) <= value)
+			{
+				this->_maximum.popBack();
+			}
+			this->_minimum.pushBack(position);
+			this->_maximum.pushBack(position);
+
+			/* Exponentially weighted moving average */
+			if(this->_ewmaEmpty)
+			{
+				this->_ewma = value;
+				this->_ewmaEmpty = false;
+			} else {
+				this->_ewma += this->_ewmaAlpha * (value - this->_ewma);
+			}
+
+			if(++this->_sinceResync >= STATS_RESYNC_PUSHES && evicting)
+			{
+				this->resync(value);
+			}
+		}
+
+		/* clear: forgets all the values. The window must be cleared too */
+		void clear()
+		{
+			this->_count = 0;
+			this->_mean = 0;
+			this->_m2 = 0;
+			this->_ewma = 0;
+			this->_ewmaEmpty = true;
+			this->_sinceResync = 0;
+			this->_minimum.clear();
+			this->_maximum.clear();
+		}
+
+		/* setEwmaAlpha: weight of the newest value in the EWMA, between 0 and 1 */
+		void setEwmaAlpha(float alpha) { this->_ewmaAlpha = alpha; }
+
+		unsigned int count() const { return this->_count; }
+		float mean() const { return this->_count > 0 ? this->_mean : NAN; }
+		/* variance: sample variance of the window */
+		float variance() const { return this->_count > 1 ? this->_m2 / (this->_count - 1) : 0; }
+		float standardDeviation() const { return sqrt(this->variance()); }
+		float minimum() const { return this->_count > 0 ? this->valueAt(this->_minimum.front()) : NAN; }
+		float maximum() const { return this->_count > 0 ? this->valueAt(this->_maximum.front()) : NAN; }
+		float ewma() const { return this->_ewmaEmpty ? NAN : this->_ewma; }
+
+	private:
+		const RingBuffer<float, N>* _window;
+		unsigned int _count;
+		float _mean;
+		float _m2;
+		float _ewma;
+		float _ewmaAlpha;
+		bool _ewmaEmpty;
+		unsigned int _sinceResync;
+		MonotonicQueue<N> _minimum;
+		MonotonicQueue<N> _maximum;
+
+		/* valueAt: value of the window at a position */
+		float valueAt(unsigned char position) const
+		{
+			const RingBuffer<float, N>& window = *this->_window;
+			unsigned char newest = (unsigned char)(window.pushes() - 1);
+			unsigned char age = (unsigned char)(newest - position);
+			return window[window.size() - 1 - age];
+		}
+
+		/* resync: recomputes mean and variance from the window, plus the value being pushed */
+		void resync(float value)
+		{
+			const RingBuffer<float, N>& window = *this->_window;
+			unsigned int size = window.size();
+			float sum = value;
+			for(unsigned int i = 1; i < size; i++)
+			{
+				sum += window[i];
+			}
+			float mean = sum / this->_count;
+			float m2 = (value - mean) * (value - mean);
+			for(unsigned int i = 1; i < size; i++)
+			{
+				m2 += (window[i] - mean) * (window[i] - mean);
+			}
+			this->_mean = mean;
+			this->_m2 = m2;
+			this->_sinceResync = 0;
+		}
+};
+
+#endif
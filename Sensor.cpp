@@ -2,325 +2,1081 @@
 #include "Arduino.h"
 #include "Sensor.h"
 #include "SensorTypes.h"
+#include "SensorFormat.h"
+#include "ContinuousAdc.h"
+#include "DhtAsync.h"
+#include "CalibrationStore.h"
+
+unsigned char Sensor::_nextId = 0;
 
 Sensor::Sensor(short int inputPin, short int sensorType, const char* label)
+{
+  /* Built-in parameters are read from the table in flash, only while constructing */
+  sensor_params params;
+  memcpy_P(&params, builtInSensorParams(sensorType), sizeof(params));
+
+  this->configure(inputPin, params, label);
+  /* Unknown codes get the parameters of CUSTOM, and say so in telemetry and stored calibrations */
+  this->_typeCode = sensorType < 0 || sensorType > SOIL_MOISTURE_METER ? CUSTOM : sensorType;
+}
+
+Sensor::Sensor(short int inputPin, sensor_params sensorType, const char* label)
+{
+  this->configure(inputPin, sensorType, label);
+  this->_typeCode = CUSTOM;
+}
+
+Sensor::~Sensor()
+{
+  CalibrationTable::release(this->_table);
+  RollupHistory::release(this->_rollup);
+  for(int i = 0; i < MAX_IO_STREAMS; i++)
+  {
+    StreamRegistry::close(this->_streams[i]);
+  }
+}
+
+void Sensor::configure(short int inputPin, const sensor_params& sensorType, const char* label)
 {
   /* Set configuration */
   this->pin = inputPin;
-  switch(sensorType)
-  {
-    case HYGROMETER:
-      this->_sensorType = hygrometer_params;
-      break;
-    case AIR_THERMOMETER:
-      this->_sensorType = air_thermometer_params;
-      break;
-    case CO_SENSOR:
-      this->_sensorType = co_sensor_params;
-      break;
-    case ETOH_SENSOR:
-      this->_sensorType = etoh_sensor_params;
-      break;
-    case NOX_SENSOR:
-      this->_sensorType = nox_sensor_params;
-      break;
-    case VOLUME_SENSOR:
-      this->_sensorType = volume_params;
-      break;
-    case LIGHT_SENSOR:
-      this->_sensorType = light_sensor_params;
-      break;
-    case BLUE_LIGHT_SENSOR:
-      this->_sensorType = blue_light_sensor_params;
-      break;
-    case RED_LIGHT_SENSOR:
-      this->_sensorType = red_light_sensor_params;
-      break;
-    case ULTRAVIOLET_LIGHT_SENSOR:
-      this->_sensorType = ultraviolet_light_sensor_params;
-      break;
-    case ANALOGIC_THERMOMETER:
-      this->_sensorType = analogic_thermometer_params;
-      break;
-    case SOIL_MOISTURE_METER:
-      this->_sensorType = soil_moisture_params;
-      break;
-    default:
-      this->_sensorType = ec_meter_params;
-  }
-
-  this->readingFunction = this->_sensorType.readingFunction;
+  this->readingFunction = sensorType.readingFunction;
+  this->_table = NULL;
+  this->_tableMode = false;
+  this->_typeName = sensorType.name;
+  this->_measureUnit = sensorType.measureUnit;
+  this->_decimals = sensorType.decimals;
 
   if(label == NULL)
   {
-    this->_label = this->_sensorType.name;
+    this->_label = sensorType.name;
   }
   else
   {
-    this->_label = label;
+    this->_label = label;
+  }
+
+
+  /* Set default calibration */
+  this->_numCalibrationPoints = sensorType.numCalibrationPoints;
+  for(int i = 0; i < this->_numCalibrationPoints; i++)
+  {
+    this->_calibrationPoints[i] = sensorType.calibrationPoints[i];
+  }
+
+  this->setCoefficients(sensorType.intercept, sensorType.slope);
+  this->_calibrationModel = CALIBRATION_LINEAR;
+  this->_calibrationProgress.state = CALIBRATION_IDLE;
+  this->_calibrationStream = 0;
+  this->_calibrationCheckpoint = NULL;
+  this->_calibrationTimestamp = 0;
+  /* Global sensors are built before setup() configures the store: the stored calibration is loaded on first use */
+  this->_calibrationPending = true;
+  this->numReadings = sensorType.numReadings;
+  this->_readDelay = sensorType.readDelay;
+  this->_continuous = false;
+  this->setFilter(sensorType.filter);
+
+  /* Initialize streams array */
+  for(int i = 0; i < MAX_IO_STREAMS; i++)
+  {
+    this->_streams[i] = -1;
+    this->_streamStatus[i] = STREAM_NONE;
+  }
+  this->_testedStream = -1;
+
+  /* No reading taken yet */
+  this->_lastValue = 0;
+  this->_lastReadingTime = 0;
+  this->_hasReading = false;
+  this->_statistics.attach(&this->_lastReadings);
+  this->_rollup = NULL;
+  this->_acquisitionState = ACQUISITION_IDLE;
+
+  /* Text output by default */
+  this->_id = Sensor::_nextId++;
+  this->_outputMode = OUTPUT_TEXT;
+  this->_schemaSent = 0;
+  this->_lastRawValue = 0;
+
+  /* Every reading is reported */
+  memset(&this->_reportPolicy, 0, sizeof(this->_reportPolicy));
+  memset(&this->_reportState, 0, sizeof(this->_reportState));
+
+#ifdef SENSOR_INSTRUMENTATION
+  this->resetInstrumentation();
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+/*                                                                                       */
+/* Operational methods																																	 */
+/*                                                                                       */
+///////////////////////////////////////////////////////////////////////////////////////////
+
+float Sensor::collectInput()
+{
+  /* Analogic samples are summed as integers, the average is taken by the conversion */
+  if(this->isAnalogic())
+  {
+    return this->collectAnalogic();
+  }
+
+  /* Do the reading and onvert the result to a useful form, using sensor type properties */
+  float val = this->collectRawInput();
+
+  return this->recordReading(val);
+}
+
+float Sensor::collectInput(unsigned long maxAge)
+{
+  /* Reuse the last reading while it is fresh enough, to spare the hardware */
+  if(this->_hasReading && millis() - this->_lastReadingTime <= maxAge)
+  {
+    return this->_lastValue;
+  }
+
+  return this->collectInput();
+}
+
+float Sensor::collectRawInput()
+{
+  SENSOR_TIME(&this->_instrumentation.rawInput);
+
+  /* Continuous sampling: the queued conversions, or the last raw value if there are none */
+  int channel = this->continuousChannel();
+  if(channel >= 0)
+  {
+    long sum = 0;
+    short int count = 0;
+    uint16_t sample;
+    while(count < this->numReadings && ContinuousAdc::take(channel, &sample))
+    {
+      sum += sample;
+      count++;
+    }
+    return count > 0 ? (float)sum / count : this->_lastRawValue;
+  }
+
+  return this->readingFunction(this->pin,this->numReadings);
+  // return basicReading(this->pin,this->numReadings);
+  // return this->_sensorType.readingFunction(this->pin,this->numReadings);
+  // return basicReading(this->pin,this->numReadings);
+}
+
+bool Sensor::begin()
+{
+  if(this->_acquisitionState == ACQUISITION_RUNNING)
+  {
+    return false;
+  }
+
+  /* The pin is configured once for the whole reading */
+  if(this->isAnalogic())
+  {
+    pinMode(this->pin,INPUT);
+  }
+
+  /* The DHT transaction runs meanwhile, without read2() blocking */
+  if(this->isDht())
+  {
+    DhtAsync::begin(this->pin);
+  }
+
+  this->_acquisitionSum = 0;
+  this->_acquisitionCount = 0;
+  this->_acquisitionDue = millis();
+  this->_acquisitionState = ACQUISITION_RUNNING;
+
+  return true;
+}
+
+bool Sensor::poll()
+{
+  if(this->_acquisitionState != ACQUISITION_RUNNING)
+  {
+    return false;
+  }
+
+  /* Readings that can't be split in samples are done in one step, DHT ones once their transaction is over */
+  if(!this->isAnalogic())
+  {
+    if(this->isDht() && !DhtAsync::poll(this->pin))
+    {
+      return false;
+    }
+    this->recordReading(this->collectRawInput());
+    this->_acquisitionState = ACQUISITION_READY;
+    return true;
+  }
+
+  /* Continuous sampling: the conversions queued since the last poll */
+  int channel = this->continuousChannel();
+  if(channel >= 0)
+  {
+    uint16_t sample;
+    while(ContinuousAdc::take(channel, &sample))
+    {
+      if(this->addSample(sample))
+      {
+        this->_acquisitionState = ACQUISITION_READY;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /* Wait for the next sample deadline, without blocking */
+  unsigned long now = millis();
+  if((long)(now - this->_acquisitionDue) < 0)
+  {
+    return false;
+  }
+
+  if(!this->addSample(oversampledSample(this->pin, this->_filter.oversamplingBits)))
+  {
+    this->_acquisitionDue = now + this->_readDelay;
+    return false;
+  }
+
+  this->_acquisitionState = ACQUISITION_READY;
+  return true;
+}
+
+bool Sensor::addSample(uint16_t sample)
+{
+  /* Samples are summed, or kept for the filter stage */
+  short int window = filterWindow(this->_filter, this->numReadings);
+  if(window > 0)
+  {
+    this->_filterSamples[this->_acquisitionCount] = sample;
+  } else {
+    this->_acquisitionSum += sample;
+  }
+  this->_acquisitionCount++;
+
+  if(this->_acquisitionCount < (window > 0 ? window : this->numReadings))
+  {
+    return false;
+  }
+
+  this->finishSamples();
+  return true;
+}
+
+float Sensor::finishSamples()
+{
+  if(filterWindow(this->_filter, this->numReadings) > 0)
+  {
+    long sum;
+    short int divisor;
+    filterSamples(this->_filter, this->_filterSamples, this->_acquisitionCount, &sum, &divisor);
+    return this->recordReading(sum, divisor);
+  }
+  return this->recordReading(this->_acquisitionSum, this->_acquisitionCount << this->_filter.oversamplingBits);
+}
+
+void Sensor::scanBegin()
+{
+  this->_acquisitionSum = 0;
+  this->_acquisitionCount = 0;
+}
+
+bool Sensor::scanSample(uint16_t sample)
+{
+  if(!this->isAnalogic() || this->_acquisitionCount >= this->samplesPerReading())
+  {
+    return false;
+  }
+  return this->addSample(sample);
+}
+
+short int Sensor::samplesPerReading()
+{
+  short int window = filterWindow(this->_filter, this->numReadings);
+  return window > 0 ? window : this->numReadings;
+}
+
+bool Sensor::ready()
+{
+  return this->_acquisitionState == ACQUISITION_READY;
+}
+
+float Sensor::collectAnalogic()
+{
+  /* Continuous sampling: no conversion, the reading is kept if none was queued */
+  if(this->continuousChannel() >= 0)
+  {
+    this->collectContinuous();
+    return this->_lastValue;
+  }
+
+  /* The samples are reduced to a sum and a divisor, then converted: the conversion is timed on its own */
+  long sum;
+  short int divisor;
+  {
+    SENSOR_TIME(&this->_instrumentation.rawInput);
+    this->sampleAnalogic(&sum, &divisor);
+  }
+  return this->recordReading(sum, divisor);
+}
+
+void Sensor::sampleAnalogic(long* sum, short int* divisor)
+{
+  /* Plain average: the samples are only summed */
+  unsigned char bits = this->_filter.oversamplingBits;
+  short int window = filterWindow(this->_filter, this->numReadings);
+  if(this->_filter.stage == FILTER_MEAN && bits == 0)
+  {
+    *sum = analogicSum(this->pin, this->numReadings);
+    *divisor = this->numReadings;
+  } else if(window == 0) {
+    pinMode(this->pin,INPUT);
+    *sum = 0;
+    for(short int i = 0; i < this->numReadings; i++)
+    {
+      *sum += oversampledSample(this->pin, bits);
+    }
+    *divisor = this->numReadings << bits;
+  } else {
+    pinMode(this->pin,INPUT);
+    for(short int i = 0; i < window; i++)
+    {
+      this->_filterSamples[i] = oversampledSample(this->pin, bits);
+    }
+    filterSamples(this->_filter, this->_filterSamples, window, sum, divisor);
+  }
+}
+
+bool Sensor::collectContinuous()
+{
+  /* Conversions are samples of the filter, without oversampling (see setContinuous) */
+  this->scanBegin();
+  int channel = this->continuousChannel();
+  uint16_t sample;
+  while(ContinuousAdc::take(channel, &sample))
+  {
+    if(this->addSample(sample))
+    {
+      return true;
+    }
+  }
+
+  /* Fewer conversions than samples: a reading from those there are */
+  if(this->_acquisitionCount == 0)
+  {
+    return false;
+  }
+  this->finishSamples();
+  return true;
+}
+
+float Sensor::recordReading(float rawValue)
+{
+  this->loadPendingCalibration();
+  float value;
+  {
+    SENSOR_TIME(&this->_instrumentation.conversion);
+    value = this->convertInput(rawValue);
+  }
+  return this->storeReading(rawValue, value);
+}
+
+float Sensor::recordReading(long rawSum, short int count)
+{
+  this->loadPendingCalibration();
+  float rawValue;
+  float value;
+  {
+    /* Every path of a reading is timed, averaging included */
+    SENSOR_TIME(&this->_instrumentation.conversion);
+    if(this->_table != NULL)
+    {
+      /* A lookup, whatever the calibration model */
+      rawValue = (float)rawSum / count;
+      value = this->_table->lookup(rawSum, count);
+    }
+#ifdef SENSOR_FIXED_POINT
+    else if(this->_calibration.model() == CALIBRATION_LINEAR)
+    {
+      /* Average and conversion without soft-float, only the results are turned into floats */
+      fixed_t fixedRawValue = fixedFromRatio(rawSum, count);
+      rawValue = fixedToFloat(fixedRawValue);
+      value = fixedToFloat(this->convertInputFixed(fixedRawValue));
+    }
+#endif
+    else
+    {
+      rawValue = (float)rawSum / count;
+      value = this->convertInput(rawValue);
+    }
+  }
+  return this->storeReading(rawValue, value);
+}
+
+float Sensor::storeReading(float rawValue, float value)
+{
+  this->_lastRawValue = rawValue;
+
+  /* Record the value in the readings history. */
+  this->pushLastReadings(value);
+  this->_lastValue = value;
+  this->_lastReadingTime = millis();
+  this->_hasReading = true;
+  if(this->_rollup != NULL)
+  {
+    this->_rollup->add(value, this->_lastReadingTime);
+  }
+
+  return value;
+}
+
+bool Sensor::isAnalogic()
+{
+  return this->readingFunction == &basicAnalogicReading;
+}
+
+bool Sensor::isDht()
+{
+  return this->readingFunction == &dhtHumidityReading || this->readingFunction == &dhtTemperatureReading;
+}
+
+String Sensor::formattedReading()
+{
+  return this->formattedReading(this->collectInput());
+}
+
+String Sensor::formattedReading(float val)
+{
+  char message[SENSOR_MESSAGE_SIZE];
+  this->formattedReading(message, sizeof(message), val);
+
+  // Convert it to String, otherwise the pointer will be discarded
+  return (String)message;
+}
+
+size_t Sensor::formattedReading(char* buffer, size_t size)
+{
+  return this->formattedReading(buffer, size, this->collectInput());
+}
+
+size_t Sensor::formattedReading(char* buffer, size_t size, float val)
+{
+  SENSOR_TIME(&this->_instrumentation.format);
+
+  /* Label, reading with the decimals of the sensor type, measure unit */
+  FormatBuffer message(buffer, size);
+  message.print(this->_label).pad(SENSOR_LABEL_WIDTH).print(": ");
+  message.print(val, this->_decimals).print(this->getMeasureUnit());
+
+  return message.length();
+}
+
+void Sensor::printReading(int stream)
+{
+  if(this->_outputMode == OUTPUT_BINARY)
+  {
+    this->collectInput();
+    this->printFrames(stream, stream + 1);
+    return;
+  }
+
+  char message[SENSOR_MESSAGE_SIZE];
+  this->formattedReading(message, sizeof(message));
+  SENSOR_TIME(stream < INSTRUMENTED_STREAMS ? &this->_instrumentation.output[stream] : NULL);
+  StreamRegistry::println(this->_streams[stream], message);
+}
+
+void Sensor::printAll()
+{
+  /* One acquisition and one formatting for all the streams, so they all show the same value */
+  float value = this->collectInput();
+  if(!reportDue(this->_reportPolicy, this->_reportState, value, this->_lastReadingTime))
+  {
+    return;
+  }
+
+  if(this->_outputMode == OUTPUT_BINARY)
+  {
+    this->printFrames(0, MAX_IO_STREAMS);
+    return;
+  }
+
+  char message[SENSOR_MESSAGE_SIZE];
+  this->formattedReading(message, sizeof(message), value);
+
+  for(int i = 0; i < MAX_IO_STREAMS; i++)
+  {
+
+    if(this->channel(i) != NULL)
+    {
+      SENSOR_TIME(i < INSTRUMENTED_STREAMS ? &this->_instrumentation.output[i] : NULL);
+      StreamRegistry::println(this->_streams[i], message);
+    }
+  }
+
+}
+
+void Sensor::setReportPolicy(const report_policy& policy)
+{
+  this->_reportPolicy = policy;
+  reportReset(this->_reportState);
+}
+
+const report_policy& Sensor::getReportPolicy()
+{
+  return this->_reportPolicy;
+}
+
+unsigned long Sensor::getReportsSent()
+{
+  return this->_reportState.sent;
+}
+
+unsigned long Sensor::getReportsSuppressed()
+{
+  return this->_reportState.suppressed;
+}
+
+void Sensor::setOutputMode(unsigned char mode)
+{
+  this->_outputMode = mode;
+}
+
+unsigned char Sensor::getOutputMode()
+{
+  return this->_outputMode;
+}
+
+void Sensor::resendSchema()
+{
+  this->_schemaSent = 0;
+}
+
+void Sensor::printFrames(int first, int last)
+{
+  byte frame[TELEMETRY_MAX_FRAME];
+  size_t length = 0;
+
+  /* Streams that don't know this sensor yet get its schema first, built once */
+  for(int i = first; i < last; i++)
+  {
+    if(this->channel(i) != NULL && !(this->_schemaSent & (1 << i)))
+    {
+      if(length == 0)
+      {
+        length = telemetrySchemaFrame(frame, this->_id, this->_typeCode, this->_decimals, SENSOR_LABEL_WIDTH, this->_label, this->getMeasureUnit());
+      }
+      this->writeFrame(i, frame, length);
+      this->_schemaSent |= 1 << i;
+    }
+  }
+
+  length = telemetrySampleFrame(frame, this->_id, this->_typeCode, this->_lastReadingTime, this->_lastRawValue, this->_lastValue);
+  for(int i = first; i < last; i++)
+  {
+    if(this->channel(i) != NULL)
+    {
+      this->writeFrame(i, frame, length);
+    }
+  }
+}
+
+void Sensor::writeFrame(int stream, const byte* frame, size_t length)
+{
+  SENSOR_TIME(stream < INSTRUMENTED_STREAMS ? &this->_instrumentation.output[stream] : NULL);
+  StreamRegistry::write(this->_streams[stream], frame, length);
+}
+
+#ifdef SENSOR_INSTRUMENTATION
+const sensor_instrumentation& Sensor::getInstrumentation()
+{
+  return this->_instrumentation;
+}
+
+void Sensor::resetInstrumentation()
+{
+  histogramClear(this->_instrumentation.rawInput);
+  histogramClear(this->_instrumentation.conversion);
+  histogramClear(this->_instrumentation.format);
+  for(int i = 0; i < INSTRUMENTED_STREAMS; i++)
+  {
+    histogramClear(this->_instrumentation.output[i]);
+  }
+}
+
+void Sensor::reportInstrumentation(int handle)
+{
+  /* Label, then the stages that ran, the streams by index */
+  char line[INSTRUMENTATION_LINE_SIZE];
+  FormatBuffer title(line, sizeof(line));
+  title.print(this->_label).print(F(" timings"));
+  StreamRegistry::println(handle, line);
+
+  histogramFormat(line, sizeof(line), "raw", this->_instrumentation.rawInput);
+  StreamRegistry::println(handle, line);
+  histogramFormat(line, sizeof(line), "convert", this->_instrumentation.conversion);
+  StreamRegistry::println(handle, line);
+  histogramFormat(line, sizeof(line), "format", this->_instrumentation.format);
+  StreamRegistry::println(handle, line);
+  for(int i = 0; i < INSTRUMENTED_STREAMS; i++)
+  {
+    if(this->_instrumentation.output[i].count > 0)
+    {
+      char name[12];
+      FormatBuffer(name, sizeof(name)).print(F("stream ")).print((long)i);
+      histogramFormat(line, sizeof(line), name, this->_instrumentation.output[i]);
+      StreamRegistry::println(handle, line);
+    }
+  }
+}
+#endif
+
+void Sensor::calibrate()
+{
+  /* Blocking calibration, for sketches that have no loop() to poll from */
+  if(!this->calibrationBegin(0))
+  {
+    return;
+  }
+  while(!this->calibrationPoll())
+  {
+    delay(1);
+  }
+}
+
+bool Sensor::calibrationBegin(int stream)
+{
+  if(this->calibrationRunning() || stream < 0 || stream >= MAX_IO_STREAMS || this->channel(stream) == NULL)
+  {
+    return false;
   }
 
+  this->loadPendingCalibration();
+  this->_calibrationStream = stream;
+  this->_calibrationProgress.model = this->_calibrationModel;
+  this->_calibrationProgress.point = 0;
+  this->_calibrationProgress.points = this->_numCalibrationPoints;
+  this->_calibrationProgress.samples = 0;
 
-  /* Set default calibration */
-  this->_numCalibrationPoints = this->_sensorType.numCalibrationPoints;
-  for(int i = 0; i < this->_numCalibrationPoints; i++)
+  char text[SENSOR_MESSAGE_SIZE];
+  FormatBuffer message(text, sizeof(text));
+  message.print(F("sensor N° ")).print(this->_label).print(F("; Calibration points ")).print((long)this->_numCalibrationPoints).print(F("; samples per point ")).print((long)CALIBRATION_SAMPLES); // put the sensor in the reference...
+  StreamRegistry::println(this->_streams[stream], text);
+
+  this->calibrationWait();
+  return true;
+}
+
+bool Sensor::calibrationResume(const calibration_progress& progress, int stream)
+{
+  /* Only progress of this sensor's calibration points can be resumed */
+  if(this->calibrationRunning() || stream < 0 || stream >= MAX_IO_STREAMS || this->channel(stream) == NULL
+    || progress.points != this->_numCalibrationPoints || progress.point < 0 || progress.point > progress.points)
   {
-    this->_calibrationPoints[i] = this->_sensorType.calibrationPoints[i];
+    return false;
   }
+  this->loadPendingCalibration();
 
-  this->_intercept = this->_sensorType.intercept;
-  this->_slope = this->_sensorType.slope;
-  this->numReadings = this->_sensorType.numReadings;
-  this->_readDelay = this->_sensorType.readDelay;
+  this->_calibrationStream = stream;
+  this->_calibrationProgress = progress;
+  this->_calibrationProgress.samples = 0;
 
-  /* Initialize streams array */
-  for(int i; i < MAX_IO_STREAMS; i++)
+  if(progress.point == progress.points)
   {
-    this->streams[i] = NULL;
+    this->calibrationFinish();
+    return true;
   }
 
+  char text[SENSOR_MESSAGE_SIZE];
+  FormatBuffer message(text, sizeof(text));
+  message.print(F("Calibration of ")).print(this->_label).print(F(" resumed"));
+  StreamRegistry::println(this->_streams[stream], text);
+
+  this->calibrationWait();
+  return true;
 }
 
-Sensor::Sensor(short int inputPin, sensor_params sensorType, const char* label)
+bool Sensor::calibrationPoll()
 {
-  /* Set configuration */
-  this->pin = inputPin;
+  /* Nothing left to wait for: done, failed, aborted or never begun */
+  if(!this->calibrationRunning())
+  {
+    return true;
+  }
 
-  this->_sensorType = sensorType;
+  calibration_progress& progress = this->_calibrationProgress;
+  InteractionChannel* stream = this->channel(this->_calibrationStream);
+  unsigned long now = millis();
 
-  this->readingFunction = this->_sensorType.readingFunction;
+  char text[SENSOR_MESSAGE_SIZE];
+  FormatBuffer message(text, sizeof(text));
 
-  if(label == NULL)
+  if(progress.state == CALIBRATION_WAITING)
   {
-    this->_label = this->_sensorType.name;
+    /* One key per poll: C acquires the point */
+    char key = stream->read();
+    if(key == 'c' || key == 'C')
+    {
+      if(this->isAnalogic())
+      {
+        pinMode(this->pin,INPUT);
+      }
+      progress.state = CALIBRATION_ACQUIRING;
+      progress.samples = 0;
+      this->_calibrationSum = 0;
+      this->_calibrationDue = now;
+      return false;
+    }
+
+    /* Show the reading from time to time, so the user knows when it is stable */
+    if((long)(now - this->_calibrationDue) >= 0)
+    {
+      float inputRawValue = this->calibrationSample();
+      message.print(F("Raw value = ")).print(inputRawValue, 2).print(F("; Current value = ")).print(this->convertInput(inputRawValue), 2);
+      StreamRegistry::println(this->_streams[this->_calibrationStream], text);
+      this->_calibrationDue = now + CALIBRATION_DISPLAY_INTERVAL;
+    }
+    return false;
   }
-  else
+
+  if(progress.state != CALIBRATION_ACQUIRING || (long)(now - this->_calibrationDue) < 0)
   {
-    this->_label = label;
+    return false;
   }
 
-
-  /* Set default calibration */
-  this->_numCalibrationPoints = this->_sensorType.numCalibrationPoints;
-  for(int i = 0; i < this->_numCalibrationPoints; i++)
+  /* One sample per poll, readDelay milliseconds apart */
+  this->_calibrationSum += this->calibrationSample();
+  progress.samples++;
+  this->_calibrationDue = now + this->_readDelay;
+  if(progress.samples < CALIBRATION_SAMPLES)
   {
-    this->_calibrationPoints[i] = this->_sensorType.calibrationPoints[i];
+    return false;
   }
 
-  this->_intercept = this->_sensorType.intercept;
-  this->_slope = this->_sensorType.slope;
-  this->numReadings = this->_sensorType.numReadings;
-  this->_readDelay = this->_sensorType.readDelay;
+  progress.rawValues[progress.point] = this->_calibrationSum / progress.samples;
+  progress.point++;
+  message.print(F("Reference point ")).print((long)progress.point).print(F(" acquired"));
+  StreamRegistry::println(this->_streams[this->_calibrationStream], text);
 
-  /* Initialize streams array */
-  for(int i; i < MAX_IO_STREAMS; i++)
+#ifdef DEBUG_linearCalibration
+  message.clear().print(F("x = ")).print(progress.rawValues[progress.point - 1], 2);
+  StreamRegistry::println(this->_streams[this->_calibrationStream], text);
+  message.clear().print(F("y = ")).print(this->_calibrationPoints[progress.point - 1], 2);
+  StreamRegistry::println(this->_streams[this->_calibrationStream], text);
+#endif
+
+  if(progress.point < progress.points)
   {
-    this->streams[i] = NULL;
+    this->calibrationWait();
+    return false;
   }
 
+  this->calibrationFinish();
+  return true;
 }
 
-///////////////////////////////////////////////////////////////////////////////////////////
-/*                                                                                       */
-/* Operational methods																																	 */
-/*                                                                                       */
-///////////////////////////////////////////////////////////////////////////////////////////
-
-float Sensor::collectInput()
+float Sensor::calibrationSample()
 {
-  /* Do the reading and onvert the result to a useful form, using sensor type properties */
-  float val = this->collectRawInput();
-  float value = this->convertInputLinear(val);
-
-  /* Record the value in the readings history. */
-  //pushLastReadings(value);
-
-  return value;
+  /* Analogic samples are raw readings, through the filter, so the points match what is later converted */
+  if(this->isAnalogic())
+  {
+    long sum;
+    short int divisor;
+    this->sampleAnalogic(&sum, &divisor);
+    return (float)sum / divisor;
+  }
+  return this->collectRawInput();
 }
 
-float Sensor::collectRawInput()
+void Sensor::calibrationWait()
 {
+  calibration_progress& progress = this->_calibrationProgress;
+  progress.state = CALIBRATION_WAITING;
+  progress.samples = 0;
+  this->_calibrationDue = millis();
 
-  return this->readingFunction(this->pin,this->numReadings);
-  // return basicReading(this->pin,this->numReadings);
-  // return this->_sensorType.readingFunction(this->pin,this->numReadings);
-  // return basicReading(this->pin,this->numReadings);
+  /* Acquired points are saved, so that calibration can resume from the next one */
+  if(this->_calibrationCheckpoint != NULL)
+  {
+    this->_calibrationCheckpoint(this, &progress);
+  }
+
+  char text[SENSOR_MESSAGE_SIZE];
+  FormatBuffer message(text, sizeof(text));
+  message.print(F("Insert the sensor in calibration point ")).print((long)(progress.point + 1)).print(F(". Press C to acquire")); // put the sensor in the reference...
+  StreamRegistry::println(this->_streams[this->_calibrationStream], text);
 }
 
-String Sensor::formattedReading()
+void Sensor::calibrationFinish()
 {
+  calibration_progress& progress = this->_calibrationProgress;
+  char text[SENSOR_MESSAGE_SIZE];
+  FormatBuffer message(text, sizeof(text));
 
-  /* Prepare message */
-  char message[50];
-  for(int i; i < 50; i++)
+  unsigned char model = this->_calibrationModel;
+  this->_calibrationModel = progress.model;
+  bool fitted = this->fitCalibration(progress.rawValues);
+  this->_calibrationModel = model;
+  progress.state = fitted ? CALIBRATION_DONE : CALIBRATION_FAILED;
+
+  if(this->_calibrationCheckpoint != NULL)
   {
-    message[i] = 0x00;
+    this->_calibrationCheckpoint(this, &progress);
   }
 
-  const char* mu = this->getMeasureUnit();
-  const char* label = this->_label;
-  float val = this->collectInput();
+  if(!fitted)
+  {
+    message.print(F("Calibration failed: not enough distinct readings"));
+  } else if(this->_calibration.model() == CALIBRATION_LINEAR) {
+    message.print(F("Slope =  ")).print(this->_slope, 4).print(F("; Intercept = ")).print(this->_intercept, 4);
+  } else {
+    message.print(F("Calibration model ")).print((long)this->_calibration.model()).print(F(" fitted"));
+  }
+  StreamRegistry::println(this->_streams[this->_calibrationStream], text);
 
-  #ifdef ARDUINO_DUE
+  /* Kept across resets */
+  if(fitted)
+  {
+    this->saveCalibration();
+  }
+}
 
-  sprintf(message,"%-20s: %f%s",label,val,mu);
+void Sensor::calibrationAbort()
+{
+  if(!this->calibrationRunning())
+  {
+    return;
+  }
+  this->_calibrationProgress.state = CALIBRATION_IDLE;
+  StreamRegistry::println(this->_streams[this->_calibrationStream], "Calibration aborted");
+}
 
-  #else
+bool Sensor::calibrationRunning()
+{
+  return this->_calibrationProgress.state == CALIBRATION_WAITING || this->_calibrationProgress.state == CALIBRATION_ACQUIRING;
+}
 
-  // Arduino inplementation does not include %f, therefore transform the value to string
-  char str_val[8];
-  dtostrf(val, 4, 3, str_val);
+const calibration_progress& Sensor::getCalibrationProgress()
+{
+  return this->_calibrationProgress;
+}
 
-  sprintf(message,"%-7s: %s%s",label,str_val,mu);
+void Sensor::setCalibrationCheckpoint(void (*checkpoint)(Sensor* sensor, const calibration_progress* progress))
+{
+  this->_calibrationCheckpoint = checkpoint;
+}
 
-  #endif
+bool Sensor::fitCalibration(const float* rawValues)
+{
+  if(!this->_calibration.fit(this->_calibrationModel, rawValues, this->_calibrationPoints, this->_numCalibrationPoints))
+  {
+    return false;
+  }
 
-  // Convert it to String, otherwise the pointer will be discarded
-  return (String)message;
+  /* Lines keep going through slope and intercept, and their fixed-point copies */
+  if(this->_calibration.model() == CALIBRATION_LINEAR)
+  {
+    this->setCoefficients(this->_calibration.intercept(), this->_calibration.slope());
+  } else {
+    this->refreshCalibrationTable();
+  }
 
+  /* The raw values of the fit are kept for saveCalibration() */
+  memcpy(this->_fittedRawValues, rawValues, this->_numCalibrationPoints * sizeof(float));
+  return true;
 }
 
-void Sensor::printReading(int stream)
+bool Sensor::saveCalibration()
 {
-  this->streams[stream]->println(this->formattedReading());
+  this->loadPendingCalibration();
+  calibration_record record;
+  memset(&record, 0, sizeof(record));
+  record.type = this->_typeCode;
+  record.pin = this->pin;
+  record.model = this->_calibration.model();
+  record.points = this->_numCalibrationPoints;
+  record.intercept = this->_intercept;
+  record.slope = this->_slope;
+  memcpy(record.references, this->_calibrationPoints, this->_numCalibrationPoints * sizeof(float));
+
+  /* Other models are fitted again on load, from the raw values of their fit: they are only set by fitCalibration() */
+  if(record.model != CALIBRATION_LINEAR)
+  {
+    memcpy(record.rawValues, this->_fittedRawValues, this->_numCalibrationPoints * sizeof(float));
+  }
+
+  if(!CalibrationStore::save(&record))
+  {
+    return false;
+  }
+  this->_calibrationTimestamp = record.timestamp;
+  return true;
 }
 
-void Sensor::printAll()
+bool Sensor::loadCalibration()
 {
-  for(int i = 0; i < MAX_IO_STREAMS; i++)
+  this->_calibrationPending = false;
+
+  /* Records of a sensor with other calibration points, e.g. from an older firmware, are ignored */
+  calibration_record record;
+  if(!CalibrationStore::load(this->_typeCode, this->pin, &record) || record.points != this->_numCalibrationPoints)
   {
+    return false;
+  }
 
-    if(this->streams[i] != NULL)
+  if(record.model == CALIBRATION_LINEAR)
+  {
+    this->setCoefficients(record.intercept, record.slope);
+  } else {
+    float references[MAX_CALIBRATION_POINTS];
+    memcpy(references, this->_calibrationPoints, sizeof(references));
+    memcpy(this->_calibrationPoints, record.references, sizeof(references));
+
+    unsigned char model = this->_calibrationModel;
+    this->_calibrationModel = record.model;
+    bool fitted = this->fitCalibration(record.rawValues);
+    this->_calibrationModel = model;
+    if(!fitted)
     {
-      this->printReading(i);
+      memcpy(this->_calibrationPoints, references, sizeof(references));
+      return false;
     }
   }
 
+  memcpy(this->_calibrationPoints, record.references, this->_numCalibrationPoints * sizeof(float));
+  this->_calibrationTimestamp = record.timestamp;
+  return true;
 }
 
-void Sensor::calibrate()
+void Sensor::loadPendingCalibration()
 {
-  short int pointsNumber = this->_numCalibrationPoints;
-  float arrayY[pointsNumber];
-  float arrayY2[pointsNumber];
-  float arrayX[pointsNumber];
-  float arrayX2[pointsNumber];
-  float arrayXY[pointsNumber];
-
-  float inputRawValue;
-  char customKey;
+  if(this->_calibrationPending)
+  {
+    this->loadCalibration();
+  }
+}
 
+unsigned long Sensor::getCalibrationTimestamp()
+{
+  this->loadPendingCalibration();
+  return this->_calibrationTimestamp;
+}
 
-  String message = "";
-  message = String("sensor N° " + String(this->_label) + F("; Calibration points ") + String(pointsNumber) + F("; readings per  point ") + String(this->numReadings)); // put the sensor in the reference...
-  this->streams[0]->println(message);
-  // HC06.println(message);
+bool Sensor::useCalibrationTable(bool enabled)
+{
+  CalibrationTable::release(this->_table);
+  this->_table = NULL;
+  this->_tableMode = false;
 
-  for (int i = 0; i < pointsNumber; i++)                   // for every calibration point do:
+  if(enabled && this->isAnalogic())
   {
-    message = "";
-    message = String("Insert the sensor in calibration point " + String(i + 1) + ". Press C to acquire"); // put the sensor in the reference...
-    this->streams[0]->println(message);
-    // HC06.println(message);
-
-    customKey = NULL;
-    while (customKey != 'c' && customKey != 'C')                                  //read and print the sensor value and
-    {
-      customKey = this->streams[0]->read();
+    this->_table = CalibrationTable::acquire(this->_calibration);
+    this->_tableMode = this->_table != NULL;
+  }
+  return this->_tableMode == enabled;
+}
 
-      inputRawValue = this->collectRawInput();
+void Sensor::setCalibrationTable(const CalibrationTable* table)
+{
+  CalibrationTable::release(this->_table);
+  this->_table = table;
+  this->_tableMode = false;
+}
 
-      arrayX[i] = inputRawValue;
-      arrayY[i] = this->_calibrationPoints[i];
-      message = "";
-      message = String("Raw value = " + String(inputRawValue) + "; Current value = " + String(this->convertInputLinear(inputRawValue))); //
-      this->streams[0]->println(message);
+const CalibrationTable* Sensor::getCalibrationTable()
+{
+  return this->_table;
+}
 
-      delay(100);
-    }
-    delay(3000);
-    message = "";
-    message = String("Reference point " + String(i + 1) + " acquired");        // AFTER data acquisition calculate the arrays
-    this->streams[0]->println(message);
+void Sensor::refreshCalibrationTable()
+{
+  CalibrationTable::release(this->_table);
+  this->_table = NULL;
+  if(this->_tableMode)
+  {
+    this->_table = CalibrationTable::acquire(this->_calibration);
+    this->_tableMode = this->_table != NULL;
+  }
+}
 
-    arrayX2[i] = arrayX[i] * arrayX[i];
-    arrayY2[i] = arrayY[i] * arrayY[i];
-    arrayXY[i] = arrayX[i] * arrayY[i];
+void Sensor::setFilter(const sensor_filter& filter)
+{
+  this->_filter = filter;
+  if(this->_filter.oversamplingBits > MAX_OVERSAMPLING_BITS)
+  {
+    this->_filter.oversamplingBits = MAX_OVERSAMPLING_BITS;
+  }
+  /* A continuous sensor gets single conversions, which can't be oversampled */
+  if(this->_continuous)
+  {
+    this->_filter.oversamplingBits = 0;
+  }
+}
 
-#ifdef DEBUG_linearCalibration
-    message = String("x = " + String(arrayX[i]));
-    this->streams[0]->println(message);
-    // HC06.println(message);
-    message = String("x2 = " + String(arrayX2[i]));
-    this->streams[0]->println(message);
-    // HC06.println(message);
-    message = String("y = " + String(arrayY[i]));
-    this->streams[0]->println(message);
-    // HC06.println(message);
-    message = String("y2 = " + String(arrayY2[i]));
-    this->streams[0]->println(message);
-    // HC06.println(message);
-    message = String("xy = " + String(arrayXY[i]));
-    this->streams[0]->println(message);
-    // HC06.println(message);
-#endif
+bool Sensor::setContinuous(bool enabled)
+{
+  if(!enabled)
+  {
+    this->_continuous = false;
+    return true;
+  }
+  if(!this->isAnalogic() || this->_filter.oversamplingBits > 0)
+  {
+    return false;
   }
 
-  float sumX, sumY, sumX2, sumY2, sumXY = 0;        // sum of array's elements
-  for (int ii = 0; ii < pointsNumber; ii++)
+  /* Sensors of the same pin share its channel, and so its conversions */
+  int channel = ContinuousAdc::channelOf(this->pin);
+  if(channel < 0)
   {
-    sumX = sumX + arrayX[ii];
-    sumY = sumY + arrayY[ii];
-    sumX2 = sumX2 + arrayX2[ii];
-    sumY2 = sumY2 + arrayY2[ii];
-    sumXY = sumXY + arrayXY[ii];
+    channel = ContinuousAdc::add(this->pin);
   }
+  if(channel < 0)
+  {
+    return false;
+  }
+  this->_continuous = true;
+  return true;
+}
+
+bool Sensor::isContinuous()
+{
+  return this->continuousChannel() >= 0;
+}
 
-  this->_intercept = (sumY * sumX2 - sumX * sumXY) / ((pointsNumber) * sumX2 - sumX * sumX);             //calculation of slope and intercept
-  this->_slope = ((pointsNumber) * sumXY  - sumX * sumY) / ((pointsNumber) * sumX2 - sumX * sumX);
-  // sensorsMatrix[sensorNumber][slopeCol] = slope;
-  // sensorsMatrix[sensorNumber][interceptCol] = intercept;
+int Sensor::continuousChannel()
+{
+  /* Resolved at each use: the channels are numbered again after ContinuousAdc::clear() */
+  return this->_continuous ? ContinuousAdc::channelOf(this->pin) : -1;
+}
 
-#ifdef DEBUG_EEPROM
-  EEPROM.write(sensorNumber, this->_slope);
-  EEPROM.write(sensorNumber + 100, this->_intercept);
-#endif
+const sensor_filter& Sensor::getFilter()
+{
+  return this->_filter;
+}
 
-  message = String("Slope =  " + String(this->_slope, 4) + "; Intercept = " + String(this->_intercept, 4));
-  this->streams[0]->println(message);
-  // HC06.println(message);
+void Sensor::setCalibrationModel(unsigned char model)
+{
+  this->_calibrationModel = model;
+}
 
-#ifdef DEBUG_linearCalibration
-  message = String("sum X = " + String(sumX, 4));
-  this->streams[0]->println(message);
-  // HC06.println(message);
-  message = String("sum X2 = " + String(sumX2, 4));
-  this->streams[0]->println(message);
-  // HC06.println(message);
-  message = String("sum Y = " + String(sumY, 4));
-  this->streams[0]->println(message);
-  // HC06.println(message);
-  message = String("sum Y2 = " + String(sumY2, 4));
-  this->streams[0]->println(message);
-  // HC06.println(message);
-  message = String("sum XY = " + String(sumXY, 4));
-  this->streams[0]->println(message);
-  // HC06.println(message);
-  message = String("slope = " + String(this->_slope, 4));
-  this->streams[0]->println(message);
-  // HC06.println(message);
-  message = String("intercept = " + String(this->_intercept, 4));
-  this->streams[0]->println(message);
-  // HC06.println(message);
-#endif
+unsigned char Sensor::getCalibrationModel()
+{
+  return this->_calibrationModel;
+}
 
+const Calibration& Sensor::getCalibration()
+{
+  this->loadPendingCalibration();
+  return this->_calibration;
 }
 
 /* setValues: resets calibration to specified values, if intercept and slope are not given, they will not be modified */
 void Sensor::setValues(float calibrationPoints[10], float intercept, float slope)
 {
   // this->_calibrationPoints = calibrationPoints;
-  for(int i = 0; i < sizeof(calibrationPoints); i++)
+  for(int i = 0; i < this->_numCalibrationPoints; i++)
   {
     this->_calibrationPoints[i] = calibrationPoints[i];
   }
@@ -333,6 +1089,21 @@ void Sensor::setValues(float calibrationPoints[10], float intercept, float slope
   {
     this->_slope = slope;
   }
+  this->setCoefficients(this->_intercept, this->_slope);
+}
+
+void Sensor::setCoefficients(float intercept, float slope)
+{
+  /* A calibration set by the sketch is not replaced by the stored one */
+  this->_calibrationPending = false;
+  this->_intercept = intercept;
+  this->_slope = slope;
+  this->_calibration.setLinear(intercept, slope);
+  this->refreshCalibrationTable();
+#ifdef SENSOR_FIXED_POINT
+  this->_fixedIntercept = fixedFromFloat(intercept);
+  this->_fixedSlope = fixedFromFloat(slope);
+#endif
 }
 
 float Sensor::convertInputLinear(float inputRawValue)
@@ -340,35 +1111,101 @@ float Sensor::convertInputLinear(float inputRawValue)
   return this->_slope * inputRawValue + this->_intercept;
 }
 
+float Sensor::convertInput(float inputRawValue)
+{
+  this->loadPendingCalibration();
+  if(this->_calibration.model() == CALIBRATION_LINEAR)
+  {
+    return this->convertInputLinear(inputRawValue);
+  }
+  return this->_calibration.evaluate(inputRawValue);
+}
+
+fixed_t Sensor::convertInputFixed(fixed_t inputRawValue)
+{
+#ifdef SENSOR_FIXED_POINT
+  fixed_t value = fixedMultiply(this->_fixedSlope, inputRawValue);
+  /* Saturated sum */
+  if(this->_fixedIntercept > 0 && value > FIXED_MAX - this->_fixedIntercept)
+  {
+    return FIXED_MAX;
+  }
+  if(this->_fixedIntercept < 0 && value < FIXED_MIN - this->_fixedIntercept)
+  {
+    return FIXED_MIN;
+  }
+  return value + this->_fixedIntercept;
+#else
+  return fixedFromFloat(this->convertInputLinear(fixedToFloat(inputRawValue)));
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////
 /*																																											*/
 /* I/O management																																				*/
 /*																																											*/
 //////////////////////////////////////////////////////////////////////////////////////////
 
-int Sensor::streamPush(InteractionChannel* ioChannel)
+int Sensor::streamPush(int handle)
 {
 
+  if(handle < 0)
+  {
+    return -1;
+  }
+
+  /* A channel the sensor already has keeps its slot, so it gets each reading once */
+  for(int i = 0; i < MAX_IO_STREAMS; i++)
+  {
+    if(this->_streams[i] == handle)
+    {
+      StreamRegistry::close(handle);
+      return i;
+    }
+  }
   int p = 0;
-  while(this->streams[p] != NULL && p < MAX_IO_STREAMS) { p++; }
+  while(p < MAX_IO_STREAMS && this->_streams[p] >= 0) { p++; }
 
-  /* If there's room for a new stream add it */
+  /* If there's room for a new stream add it, registration is immediate: streams are tested on request */
   if(p < MAX_IO_STREAMS)
   {
-    this->streams[p] = ioChannel;
+    this->_streams[p] = handle;
+    this->_streamStatus[p] = STREAM_UNTESTED;
   } else {
-    // Probably best would be to throw an exception
+    StreamRegistry::close(handle);
+    return -1;
   }
   return p;
 
 }
 
+InteractionChannel* Sensor::channel(int stream)
+{
+  if(stream < 0 || stream >= MAX_IO_STREAMS)
+  {
+    return NULL;
+  }
+  return StreamRegistry::channel(this->_streams[stream]);
+}
+
+int Sensor::getStreamHandle(int stream)
+{
+  return this->channel(stream) != NULL ? this->_streams[stream] : -1;
+}
+
+int Sensor::streamAttach(int handle)
+{
+  if(!StreamRegistry::retain(handle))
+  {
+    return -1;
+  }
+  return this->streamPush(handle);
+}
+
 int Sensor::streamAdd(Stream &stream)
 {
 
-  InteractionChannel* ioChannel = new InteractionChannel(stream);
-  int i = this->streamPush(ioChannel);
-  this->streamTest(i);
+  int i = this->streamPush(StreamRegistry::open(stream));
 
   return i;
 
@@ -377,9 +1214,7 @@ int Sensor::streamAdd(Stream &stream)
 int Sensor::streamAdd(Stream &stream,char (*getKey)())
 {
 
-  InteractionChannel* ioChannel = new InteractionChannel(stream,getKey);
-  int i = this->streamPush(ioChannel);
-  this->streamTest(i);
+  int i = this->streamPush(StreamRegistry::open(stream,getKey));
 
   return i;
 
@@ -388,9 +1223,7 @@ int Sensor::streamAdd(Stream &stream,char (*getKey)())
 int Sensor::streamAdd(Stream &stream,void (*writeChar)(String s))
 {
 
-  InteractionChannel* ioChannel = new InteractionChannel(stream,writeChar);
-  int i = this->streamPush(ioChannel);
-  this->streamTest(i);
+  int i = this->streamPush(StreamRegistry::open(stream,writeChar));
 
   return i;
 
@@ -399,9 +1232,7 @@ int Sensor::streamAdd(Stream &stream,void (*writeChar)(String s))
 int Sensor::streamAdd(char (*getKey)(),void (*writeChar)(String s))
 {
 
-  InteractionChannel* ioChannel = new InteractionChannel(getKey,writeChar);
-  int i = this->streamPush(ioChannel);
-  this->streamTest(i);
+  int i = this->streamPush(StreamRegistry::open(getKey,writeChar));
 
   return i;
 
@@ -413,18 +1244,14 @@ int Sensor::streamAdd(char (*getKey)(),void (*writeChar)(String s))
 /* Keypad and LCD constructors */
 int Sensor::streamAdd(Stream &_stream,Keypad* keypad)
 {
-  InteractionChannel* ioChannel = new InteractionChannel(_stream,keypad);
-  int i = this->streamPush(ioChannel);
-  this->streamTest(i);
+  int i = this->streamPush(StreamRegistry::open(_stream,keypad));
 
   return i;
 
 }
 int Sensor::streamAdd(Stream &_stream,LiquidCrystal* lcd)
 {
-  InteractionChannel* ioChannel = new InteractionChannel(_stream,lcd);
-  int i = this->streamPush(ioChannel);
-  this->streamTest(i);
+  int i = this->streamPush(StreamRegistry::open(_stream,lcd));
 
   return i;
 
@@ -433,9 +1260,7 @@ int Sensor::streamAdd(Stream &_stream,LiquidCrystal* lcd)
 int Sensor::streamAdd(Keypad* keypad,LiquidCrystal* lcd)
 {
 
-  InteractionChannel* ioChannel = new InteractionChannel(keypad,lcd);
-  int i = this->streamPush(ioChannel);
-  this->streamTest(i);
+  int i = this->streamPush(StreamRegistry::open(keypad,lcd));
 
   return i;
 
@@ -445,23 +1270,75 @@ int Sensor::streamAdd(Keypad* keypad,LiquidCrystal* lcd)
 
 void Sensor::streamTest(int stream)
 {
-  this->streams[stream]->println("Testing stream " + String(stream) + ". Press 'c' to exit.");
+  /* Blocking test, until the exit character or the timeout */
+  if(!this->streamTestBegin(stream))
+  {
+    return;
+  }
+  while(!this->streamTestPoll())
+  {
+    delay(1);
+  }
+}
+
+bool Sensor::streamTestBegin(int stream)
+{
+  if(this->_testedStream >= 0 || stream < 0 || stream >= MAX_IO_STREAMS || this->channel(stream) == NULL)
+  {
+    return false;
+  }
 
-  /* This is required to clean the serial cache */
-  this->streams[stream]->read();
+  char text[SENSOR_MESSAGE_SIZE];
+  FormatBuffer message(text, sizeof(text));
+  message.print(F("Testing stream ")).print((long)stream).print(F(". Press 'c' to exit."));
+  StreamRegistry::println(this->_streams[stream], text);
+
+  this->_testedStream = stream;
+  this->_streamTestStart = millis();
+  this->_streamStatus[stream] = STREAM_TESTING;
+  return true;
+}
 
-  /* Read and print on the stream until exit character is pressed */
-  char c;
-  while(c != 'c' && c != 'C')
+bool Sensor::streamTestPoll()
+{
+  if(this->_testedStream < 0)
   {
+    return false;
+  }
+  int stream = this->_testedStream;
 
-    while((c = this->streams[stream]->read()) < 1) {  }
-    this->streams[stream]->println(c);
+  /* Print the input back on the stream until exit character is pressed */
+  char c = this->channel(stream)->read();
+  if(c >= 1)
+  {
+    StreamRegistry::print(this->_streams[stream], c);
+  }
 
+  char text[SENSOR_MESSAGE_SIZE];
+  FormatBuffer message(text, sizeof(text));
+  if(c == 'c' || c == 'C')
+  {
+    this->_streamStatus[stream] = STREAM_OK;
+    message.print(F("Testing of stream ")).print((long)stream).print(F(" complete.\n"));
+  } else if(millis() - this->_streamTestStart >= STREAM_TEST_TIMEOUT) {
+    this->_streamStatus[stream] = STREAM_TIMEOUT;
+    message.print(F("Testing of stream ")).print((long)stream).print(F(" timed out."));
+  } else {
+    return false;
   }
 
-  this->streams[stream]->println("Testing of stream " + String(stream) + " complete.\n");
+  StreamRegistry::println(this->_streams[stream], text);
+  this->_testedStream = -1;
+  return true;
+}
 
+unsigned char Sensor::getStreamStatus(int stream)
+{
+  if(stream < 0 || stream >= MAX_IO_STREAMS || this->channel(stream) == NULL)
+  {
+    return STREAM_NONE;
+  }
+  return this->_streamStatus[stream];
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -472,11 +1349,13 @@ void Sensor::streamTest(int stream)
 
 float* Sensor::getCalibrationPoints()
 {
+  this->loadPendingCalibration();
   return this->_calibrationPoints;
 }
 
 float Sensor::getIntercept()
 {
+  this->loadPendingCalibration();
   return this->_intercept;
 }
 
@@ -485,11 +1364,96 @@ const char* Sensor::getLabel()
   return this->_label;
 }
 
-float* Sensor::getLastReadings()
+const RingBuffer<float, MAX_LAST_READINGS>& Sensor::getLastReadings()
 {
   return this->_lastReadings;
 }
 
+float Sensor::getLastValue()
+{
+  return this->_lastValue;
+}
+
+float Sensor::getLastRawValue()
+{
+  return this->_lastRawValue;
+}
+
+short int Sensor::getTypeCode()
+{
+  return this->_typeCode;
+}
+
+void Sensor::setId(unsigned char id)
+{
+  this->_id = id;
+}
+
+unsigned char Sensor::getId()
+{
+  return this->_id;
+}
+
+unsigned long Sensor::getLastReadingTime()
+{
+  return this->_lastReadingTime;
+}
+
+float Sensor::getMean()
+{
+  return this->_statistics.mean();
+}
+
+float Sensor::getVariance()
+{
+  return this->_statistics.variance();
+}
+
+float Sensor::getStandardDeviation()
+{
+  return this->_statistics.standardDeviation();
+}
+
+float Sensor::getMinimum()
+{
+  return this->_statistics.minimum();
+}
+
+float Sensor::getMaximum()
+{
+  return this->_statistics.maximum();
+}
+
+float Sensor::getEwma()
+{
+  return this->_statistics.ewma();
+}
+
+void Sensor::setEwmaAlpha(float alpha)
+{
+  this->_statistics.setEwmaAlpha(alpha);
+}
+
+bool Sensor::setRollup(bool enabled)
+{
+  if(!enabled)
+  {
+    RollupHistory::release(this->_rollup);
+    this->_rollup = NULL;
+    return true;
+  }
+  if(this->_rollup == NULL)
+  {
+    this->_rollup = RollupHistory::acquire();
+  }
+  return this->_rollup != NULL;
+}
+
+RollupHistory* Sensor::getRollup()
+{
+  return this->_rollup;
+}
+
 short int Sensor::getPin()
 {
   return this->pin;
@@ -497,21 +1461,26 @@ short int Sensor::getPin()
 
 float Sensor::getSlope()
 {
+  this->loadPendingCalibration();
   return this->_slope;
 }
 
 const char* Sensor::getMeasureUnit()
 {
-  return this->_sensorType.measureUnit;
+  return this->_measureUnit;
+}
+
+const char* Sensor::getSensorType()
+{
+  return this->_typeName;
 }
+
 /* Readings history rotation */
 void Sensor::pushLastReadings(float value)
 {
-  /* Record the value in last readings. */
-  //this->_lastReadings->push(value);
+  /* Update the statistics first, they need the value leaving the history */
+  this->_statistics.push(value);
 
-  /* If the buffer is full, drop the oldest value */
-  if(sizeof(this->_lastReadings) > MAX_LAST_READINGS){
-    //this->_lastReadings->pop();
-  }
+  /* Record the value in last readings. If the buffer is full, the oldest value is overwritten */
+  this->_lastReadings.push(value);
 }
@@ -4,23 +4,58 @@
 #include "Arduino.h"
 #include "SoftwareSerial.h"
 #include "InteractionChannel.h"
+#include "RingBuffer.h"
+#include "RunningStats.h"
+#include "Telemetry.h"
+#include "FixedPoint.h"
+#include "Calibration.h"
+#include "CalibrationTable.h"
+#include "StreamRegistry.h"
+#include "SensorFilter.h"
+#include "SensorInstrumentation.h"
+#include "ReportPolicy.h"
+#include "RollupHistory.h"
 
 #define MAX_LAST_READINGS 20
 #define MAX_IO_STREAMS		10
+#define SENSOR_MESSAGE_SIZE	64		// Room for a formatted reading or a calibration message
 
-#define CUSTOM					0x00
-#define HYGROMETER 			0x01
-#define AIR_THERMOMETER 0x02
-#define CO_SENSOR				0x03
-#define NOX_SENSOR			0x04
-#define ETOH_SENSOR			0x05
-#define VOLUME_SENSOR		0x06
-#define LIGHT_SENSOR		0x07
-#define RED_LIGHT_SENSOR		0x08
-#define BLUE_LIGHT_SENSOR		0x09
-#define ULTRAVIOLET_LIGHT_SENSOR		0x0A
-#define ANALOGIC_THERMOMETER				0x0B
-#define SOIL_MOISTURE_METER					0x0C
+/* Width the label is padded to in formatted readings */
+#ifdef ARDUINO_DUE
+	#define SENSOR_LABEL_WIDTH	20
+#else
+	#define SENSOR_LABEL_WIDTH	7
+#endif
+
+/* Output modes of printReading and printAll */
+#define OUTPUT_TEXT					0x00		// One formatted text line per reading
+#define OUTPUT_BINARY				0x01		// Telemetry frames, see Telemetry.h
+
+/* States of an asynchronous reading */
+#define ACQUISITION_IDLE		0x00
+#define ACQUISITION_RUNNING	0x01
+#define ACQUISITION_READY		0x02
+
+/* Status of a stream, see streamTestBegin */
+#define STREAM_NONE					0x00		// No stream in the slot
+#define STREAM_UNTESTED			0x01
+#define STREAM_TESTING			0x02
+#define STREAM_OK						0x03		// The exit character was received
+#define STREAM_TIMEOUT			0x04		// Nothing came back within STREAM_TEST_TIMEOUT
+
+#define STREAM_TEST_TIMEOUT	30000		// Milliseconds a stream test waits for the exit character
+
+/* States of a calibration */
+#define CALIBRATION_IDLE				0x00
+#define CALIBRATION_WAITING			0x01		// Waiting for the key that acquires the current point
+#define CALIBRATION_ACQUIRING		0x02		// Averaging the samples of the current point
+#define CALIBRATION_DONE				0x03
+#define CALIBRATION_FAILED			0x04
+
+#define CALIBRATION_SAMPLES						32			// Raw samples averaged per calibration point
+#define CALIBRATION_DISPLAY_INTERVAL	1000		// Milliseconds between two readings shown while waiting
+
+/* Type codes of the built-in sensors (CUSTOM...SOIL_MOISTURE_METER) are in Telemetry.h, which sends them */
 
 /* This struct defines the params a sensor needs to translate raw signal into a known measure unit */
 typedef struct sensor_params {
@@ -35,8 +70,28 @@ typedef struct sensor_params {
 		const char* measureUnit;
 		short int decimals;
 		float (*readingFunction)(short int pin, short int numReadings);
+		sensor_filter filter;						// Left out of an initializer, readings are plain averages
+
+	} sensor_params;
+
+/* Built-in reading functions, defined in SensorTypes.h, to be used in custom sensor_params */
+long analogicSum(short int pin, short int numReadings);
+float basicAnalogicReading(short int pin, short int numReadings);
+float basicDigitalReading(short int pin, short int numReadings);
+float dhtHumidityReading(short int pin, short int numReadings);
+float dhtTemperatureReading(short int pin, short int numReadings);
+
+/* Progress of a calibration. It can be saved by a checkpoint callback, and given back to calibrationResume */
+typedef struct calibration_progress {
 
-	};
+		unsigned char state;													// CALIBRATION_...
+		unsigned char model;													// Calibration model being fitted
+		short int point;															// Calibration point being acquired, from 0
+		short int points;															// Calibration points of the sensor
+		short int samples;														// Samples averaged so far for the current point
+		float rawValues[MAX_CALIBRATION_POINTS];			// Average raw values of the acquired points
+
+	} calibration_progress;
 
 #ifndef InteractionChannel_h
 
@@ -151,6 +206,10 @@ class Sensor
 		/* Constructor, takes connected pin, params of the correct sensor type, and an optional name for display */
 		Sensor(short int inputPin,short int sensorType, const char label[]);
 		Sensor(short int inputPin, sensor_params sensorType, const char label[]);
+		~Sensor();
+		/* Not copyable: stream handles, the calibration table and the rollup history are released by the destructor */
+		Sensor(const Sensor&) = delete;
+		Sensor& operator=(const Sensor&) = delete;
 
 		///////////////////////////////////////////////////////////////////////////////////////////
 		/*                                                                                       */
@@ -161,35 +220,153 @@ class Sensor
 		/* collectInput: does one reading and returns a transformed value. It also pushes it in lastReadings */
 		float collectInput();
 
+		/* collectInput: returns the last reading if it is at most maxAge milliseconds old, otherwise does a new one */
+		float collectInput(unsigned long maxAge);
+
 		/* collectRawInput: does a reading and returns a raw value */
 		float collectRawInput();
 
+		/* Asynchronous reading: begin() starts it, then poll() must be called from loop() until it returns true.	*/
+		/* Analogic samples are taken one per poll, readDelay milliseconds apart, so the loop is never blocked.		*/
+		/* The value is converted and recorded as collectInput() does, and is then available from getLastValue().	*/
+		/* DHT readings run a DhtAsync transaction (see DhtAsync.h): poll() is false until its frame is decoded.	*/
+		bool begin();
+		bool poll();
+		bool ready();
+
+		/* Readings from samples taken by an AnalogScanner (see AnalogScanner.h): scanBegin() starts one, and		*/
+		/* scanSample() adds a sample, returning true once the reading is complete and recorded. Each sample is		*/
+		/* of 4^bits conversions with oversampling, samplesPerReading() of them make a reading										*/
+		void scanBegin();
+		bool scanSample(uint16_t sample);
+		short int samplesPerReading();
+
+		/* Continuous sampling (see ContinuousAdc.h): readings take the conversions queued by the interrupt,		*/
+		/* oldest first, instead of converting. A reading takes up to samplesPerReading() of them, and with		*/
+		/* none queued there is no new reading. setContinuous(true) adds the pin before ContinuousAdc::begin().	*/
+		/* Conversions can't be oversampled: it fails with oversampling bits, which setFilter() then ignores			*/
+		bool setContinuous(bool enabled);
+		bool isContinuous();
+
 		/* calibrate: loops through all the calibration points and reads values to calibrate.		*/
-		/* Then it resets slope and intercept of the sensor.																		*/
+		/* Then it fits the calibration model, for lines it resets slope and intercept.				*/
+		/* It blocks until done: calibrationBegin and calibrationPoll do the same from loop().	*/
 		void calibrate();
 
-		/* setValues: resets calibration to specified values, if intercept and slope are not given, they will not be modified */
+		/* Non-blocking calibration: calibrationBegin() starts it on a stream, then calibrationPoll() must be called	*/
+		/* from loop() until it returns true: once the model has been fitted (or failed to), after calibrationAbort(),	*/
+		/* or when none was begun, getCalibrationProgress().state tells which. Each poll reads one key							*/
+		/* or takes one sample, so other sensors keep being read meanwhile. At every point the user presses C, then		*/
+		/* CALIBRATION_SAMPLES raw samples are averaged, readDelay milliseconds apart. Analogic samples are raw		*/
+		/* readings through the filter, so spikes are rejected at the points as they are in readings.							*/
+		bool calibrationBegin(int stream);
+		bool calibrationPoll();
+		void calibrationAbort();
+		bool calibrationRunning();
+		const calibration_progress& getCalibrationProgress();
+
+		/* setCalibrationCheckpoint: checkpoint is called with the progress before every point and at the end, e.g.	*/
+		/* to save it in EEPROM. After a reset, calibrationResume() goes on from the first point not acquired.			*/
+		void setCalibrationCheckpoint(void (*checkpoint)(Sensor* sensor, const calibration_progress* progress));
+		bool calibrationResume(const calibration_progress& progress, int stream);
+
+		/* fitCalibration: fits the calibration model to raw values read at the calibration points, without	*/
+		/* interaction. Returns false, keeping the current calibration, if the values don't fit the model		*/
+		bool fitCalibration(const float* rawValues);
+
+		/* Calibrations kept in EEPROM across resets (see CalibrationStore.h). The latest one saved for the type		*/
+		/* and pin of the sensor is loaded at the first reading or calibration access, unless the sketch set one		*/
+		/* before, and every successful calibrate() saves it. saveCalibration also saves set values							*/
+		bool saveCalibration();
+		bool loadCalibration();
+		/* getCalibrationTimestamp: when the loaded or saved calibration was saved, 0 if it never was */
+		unsigned long getCalibrationTimestamp();
+
+		/* Calibration model used by the next calibration: CALIBRATION_LINEAR (default), CALIBRATION_QUADRATIC,	*/
+		/* CALIBRATION_CUBIC or CALIBRATION_PIECEWISE, see Calibration.h																					*/
+		void setCalibrationModel(unsigned char model);
+		unsigned char getCalibrationModel();
+		const Calibration& getCalibration();
+
+		/* useCalibrationTable: converts analogic readings through a lookup table of the calibration (see		*/
+		/* CalibrationTable.h), shared with the sensors that have the same one, and rebuilt when it changes.	*/
+		/* Returns false, leaving the mode off, for sensors that are not analogic or when the pool is full		*/
+		bool useCalibrationTable(bool enabled);
+
+		/* setCalibrationTable: converts through a given table, e.g. in flash, until the calibration changes.	*/
+		/* NULL goes back to evaluating the calibration																										*/
+		void setCalibrationTable(const CalibrationTable* table);
+		const CalibrationTable* getCalibrationTable();
+
+		/* setValues: resets calibration to specified values, if intercept and slope are not given, they will not be modified.	*/
+		/* The calibration becomes linear.																																			*/
 		void setValues(float calibrationPoints[10], float intercept, float slope);
 
+		/* setFilter: acquisition filter of analogic readings, as the filter of sensor_params (see SensorFilter.h) */
+		void setFilter(const sensor_filter& filter);
+		const sensor_filter& getFilter();
+
 		/* convertInputLinear: transforms a raw value to one in the correct measure unit */
 		float convertInputLinear(float input);
 
+		/* convertInput: transforms a raw value with the current calibration model */
+		float convertInput(float input);
+
+		/* convertInputFixed: as convertInputLinear, in Q16.16 fixed point */
+		fixed_t convertInputFixed(fixed_t input);
+
 		/* formattedReading: returns a formatted string with sensor's name, reading and measure unit */
 		String formattedReading();
 
+		/* formattedReading: formats an already collected value, without reading the sensor */
+		String formattedReading(float value);
+
+		/* formattedReading: as above, into a caller-provided buffer, without using the heap. Returns the length written */
+		size_t formattedReading(char* buffer, size_t size);
+		size_t formattedReading(char* buffer, size_t size, float value);
+
 		/* printReading: prints formatted reading on specified printChannels. Null forall channels. */
 		void printReading(int stream);
 
-		/* printAll: prints formatted reading on all printChannels. */
+		/* printAll: does one reading and prints the same formatted reading on all printChannels, if the report policy sends it. */
 		void printAll();
 
+		/* setReportPolicy: when printAll() sends a reading (see ReportPolicy.h), every time by default. The next reading is sent */
+		void setReportPolicy(const report_policy& policy);
+		const report_policy& getReportPolicy();
+		/* Readings printAll() sent, and those it held back */
+		unsigned long getReportsSent();
+		unsigned long getReportsSuppressed();
+
+		/* setOutputMode: OUTPUT_TEXT (default) or OUTPUT_BINARY. In binary mode every stream gets the schema frame of the	*/
+		/* sensor (label, unit, decimals) once, then only sample frames. Binary output needs streams that accept write()		*/
+		void setOutputMode(unsigned char mode);
+		unsigned char getOutputMode();
+
+		/* resendSchema: sends the schema frame again before the next sample, e.g. when a receiver reconnects */
+		void resendSchema();
+
+		/* Id of the sensor in telemetry frames. Sensors are numbered in order of construction, unless set */
+		void setId(unsigned char id);
+		unsigned char getId();
+
+#ifdef SENSOR_INSTRUMENTATION
+		/* Timings of the hot path, see SensorInstrumentation.h */
+		const sensor_instrumentation& getInstrumentation();
+		void resetInstrumentation();
+		/* reportInstrumentation: prints the timings, one line per stage, on a handle of StreamRegistry, e.g. getStreamHandle(0) */
+		void reportInstrumentation(int handle);
+#endif
+
 		//////////////////////////////////////////////////////////////////////////////////////////
 		/*																																											*/
 		/* I/O management																																				*/
 		/*																																											*/
 		//////////////////////////////////////////////////////////////////////////////////////////
 
-		/* Add an I/O stream to the sensor */
+		/* Add an I/O stream to the sensor. Registration is immediate, it returns the index of the stream, -1 if all	*/
+		/* MAX_IO_STREAMS are in use or StreamRegistry is full. Streams are not tested: see streamTestBegin.					*/
+		/* Channels are shared through StreamRegistry: adding a channel the sensor already has returns its index			*/
 		int streamAdd(Stream &stream);
 		int streamAdd(Stream &stream,char (*getKey)());
 		int streamAdd(Stream &stream,void (*writeChar)(String s));
@@ -205,9 +382,21 @@ class Sensor
 
 		// #endif
 
-		/* Test a stream (prints input to the output of an I/O stream) */
+		/* streamAttach: subscribes to a channel opened with StreamRegistry::open(), which the caller keeps */
+		int streamAttach(int handle);
+
+		/* getStreamHandle: StreamRegistry handle of a stream, e.g. to buffer its output. -1 for an empty slot */
+		int getStreamHandle(int stream);
+
+		/* Test a stream (prints input to the output of an I/O stream), blocking until 'c' or STREAM_TEST_TIMEOUT */
 		void streamTest(int stream);
 
+		/* Asynchronous stream test: streamTestBegin() starts it, then streamTestPoll() must be called from loop()	*/
+		/* until it returns true. One stream at a time is tested. The outcome is given by getStreamStatus()				*/
+		bool streamTestBegin(int stream);
+		bool streamTestPoll();
+		unsigned char getStreamStatus(int stream);
+
 		//////////////////////////////////////////////////////////////////////////////////////////
 		/*																																											*/
 		/* Getters																																							*/
@@ -222,27 +411,136 @@ class Sensor
 		const char* getSensorType();
 		short int getNumRedings();
 		float* getCalibrationPoints();
-		float* getLastReadings();
+		/* getLastReadings: readings history, iterable from the oldest to the newest reading */
+		const RingBuffer<float, MAX_LAST_READINGS>& getLastReadings();
+		float getLastValue();
+		float getLastRawValue();
+		/* getTypeCode: the sensor type constant given to the constructor, CUSTOM for custom sensor_params or unknown codes */
+		short int getTypeCode();
+		unsigned long getLastReadingTime();
+
+		/* Statistics of the readings history, updated at every reading */
+		float getMean();
+		float getVariance();
+		float getStandardDeviation();
+		float getMinimum();
+		float getMaximum();
+		float getEwma();
+		/* setEwmaAlpha: weight of the newest reading in the exponentially weighted moving average, between 0 and 1 */
+		void setEwmaAlpha(float alpha);
+
+		/* setRollup: keeps the readings per minute and per hour as well, in a history of the pool (see RollupHistory.h),	*/
+		/* or gives it back. False if the pool is full																																	*/
+		bool setRollup(bool enabled);
+		/* getRollup: the history of the sensor, for its periods and range queries. NULL without setRollup(true) */
+		RollupHistory* getRollup();
+
 		float (*readingFunction)(short int pin, short int numReadings);
 		void (*printingFunction)(char* message);
 		void (*controlFunction)(char* message);
 
 		short int numReadings;
 		short int pin;							// the pin the sensor is connected to
+	protected:
+		/* Converts a raw value and records it as the last reading */
+		float recordReading(float rawValue);
+		/* As above, from the sum of count analogic samples, converted in fixed point if SENSOR_FIXED_POINT is set */
+		float recordReading(long rawSum, short int count);
+		/* Takes the samples of an analogic reading through the filter, and records it */
+		float collectAnalogic();
+		/* As above without recording: the raw value of the reading is sum / divisor */
+		void sampleAnalogic(long* sum, short int* divisor);
+		/* Adds a sample to the reading in progress, records the reading and returns true with the last one */
+		bool addSample(uint16_t sample);
+		/* Records the reading from the samples taken so far */
+		float finishSamples();
 	private:
 		float _intercept;						// TODO: complete comments
 		float _slope;								// TODO: complete comments
+#ifdef SENSOR_FIXED_POINT
+		fixed_t _fixedIntercept;		// _intercept in Q16.16
+		fixed_t _fixedSlope;				// _slope in Q16.16
+#endif
 		float _calibrationPoints[10];	// TODO: complete comments
 		short int _numCalibrationPoints;
-		float _lastReadings[MAX_LAST_READINGS];			// Last taken readings of the sensor
+		Calibration _calibration;				// Current calibration, linear ones mirror _slope and _intercept
+		unsigned char _calibrationModel;	// Model of the next calibration
+		const CalibrationTable* _table;		// Lookup table of the calibration, NULL to evaluate it
+		bool _tableMode;									// Keep a pool table of the calibration
+		calibration_progress _calibrationProgress;	// Progress of the current calibration
+		short int _calibrationStream;							// Stream the calibration talks on
+		float _calibrationSum;										// Sum of the samples of the current point
+		unsigned long _calibrationDue;						// millis() of the next sample or reading shown
+		void (*_calibrationCheckpoint)(Sensor* sensor, const calibration_progress* progress);
+		unsigned long _calibrationTimestamp;			// Timestamp of the stored calibration, 0 if none
+		bool _calibrationPending;									// The stored calibration is not loaded yet
+		float _fittedRawValues[MAX_CALIBRATION_POINTS];	// Raw values of the last fit, stored with non-linear models
+		RingBuffer<float, MAX_LAST_READINGS> _lastReadings;	// Last taken readings of the sensor
+		RunningStats<MAX_LAST_READINGS> _statistics;				// Statistics of _lastReadings
+		RollupHistory* _rollup;					// Readings at coarser resolutions, NULL if not kept
+		float _lastValue;								// Value of the last reading
+		float _lastRawValue;						// Raw value of the last reading
+		unsigned long _lastReadingTime;	// millis() at the last reading
+		bool _hasReading;								// False until the first reading is taken
 		const char* _label;							// Label, for the display
-		sensor_params _sensorType;	// Sensor type
+		const char* _typeName;					// Name of the sensor type
+		const char* _measureUnit;				// Measure unit symbol
+		short int _decimals;						// Decimals of formatted readings
 		int _readDelay;							// Delay between readings
-		InteractionChannel* streams[MAX_IO_STREAMS];
+		signed char _streams[MAX_IO_STREAMS];				// Handles in StreamRegistry, -1 for an empty slot
+		unsigned char _streamStatus[MAX_IO_STREAMS];	// STREAM_... of each slot
+		short int _testedStream;						// Stream being tested, -1 if none
+		unsigned long _streamTestStart;			// millis() at the start of the stream test
 		// InteractionChannel* defaultStream;
-		/* Add to the redings history. If the buffer is full rotate */
+		unsigned char _acquisitionState;		// State of the asynchronous reading
+		long _acquisitionSum;								// Sum of the samples taken so far
+		short int _acquisitionCount;				// Samples taken so far
+		unsigned long _acquisitionDue;			// millis() at which the next sample is due
+		sensor_filter _filter;							// Acquisition filter of analogic readings
+		uint16_t _filterSamples[MAX_FILTER_SAMPLES];	// Samples of the reading, for the stages that sort them
+		bool _continuous;										// Reads the conversions ContinuousAdc queues for the pin
+		short int _typeCode;						// Sensor type constant, CUSTOM for custom sensor_params
+		unsigned char _id;							// Id in telemetry frames
+		unsigned char _outputMode;			// OUTPUT_TEXT or OUTPUT_BINARY
+		unsigned short _schemaSent;			// Bit i is set once stream i got the schema frame
+		report_policy _reportPolicy;		// When printAll() sends a reading
+		report_state _reportState;			// Last report, and the counters
+#ifdef SENSOR_INSTRUMENTATION
+		sensor_instrumentation _instrumentation;	// Timings of the hot path
+#endif
+		static unsigned char _nextId;		// Id of the next sensor constructed
+		/* Sends the last reading as telemetry frames to the streams from first to last, excluded */
+		void printFrames(int first, int last);
+		void writeFrame(int stream, const byte* frame, size_t length);
+		/* Records an already converted reading */
+		float storeReading(float rawValue, float value);
+		/* Takes the queued conversions of a continuous reading, records it and returns true if there were any */
+		bool collectContinuous();
+		/* Channel of the pin in ContinuousAdc, -1 when converting on demand or if the pin was removed */
+		int continuousChannel();
+		/* Shared by the constructors: takes the parameters of the type, only the mutable ones are kept */
+		void configure(short int inputPin, const sensor_params& sensorType, const char* label);
+		/* Sets intercept and slope, and their fixed-point copies */
+		void setCoefficients(float intercept, float slope);
+		/* Calibration steps: prompt for the current point, and fit once all points are acquired */
+		void calibrationWait();
+		void calibrationFinish();
+		/* One sample of a calibration point */
+		float calibrationSample();
+		/* Follows a calibration change: drops the table, and acquires a new one in table mode */
+		void refreshCalibrationTable();
+		/* Loads the stored calibration at the first use of the calibration */
+		void loadPendingCalibration();
+		/* True for sensors read by basicAnalogicReading, whose readings can be split in samples */
+		bool isAnalogic();
+		/* True for sensors read from a DHT device, whose transactions can run in the background */
+		bool isDht();
+		/* Add to the redings history. If the buffer is full the oldest reading is dropped */
 		void pushLastReadings(float value);
-		int streamPush(InteractionChannel* ioChannel);
+		/* Subscribes to an open handle of StreamRegistry, closing it if the sensor already has it or is full */
+		int streamPush(int handle);
+		/* Channel of a stream of the sensor, NULL for an empty slot */
+		InteractionChannel* channel(int stream);
 };
 
 
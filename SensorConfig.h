@@ -0,0 +1,39 @@
+#ifndef SensorConfig_h
+#define SensorConfig_h
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Portability helpers shared by the library modules.																		*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+/* SENSOR_ATOMIC { ... }: runs the block with interrupts disabled where multi-byte			*/
+/* accesses are not atomic (AVR), restoring the previous interrupt state on exit.				*/
+#if defined(__AVR__)
+	#include <util/atomic.h>
+	#define SENSOR_ATOMIC ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#else
+	/* Word-sized loads and stores are atomic on ARM and on the host */
+	#define SENSOR_ATOMIC
+#endif
+
+/* Compiler barrier: memory accesses are not reordered across it */
+#define SENSOR_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/* SENSOR_FIXED_POINT: analogic readings are averaged and converted in Q16.16 fixed point	*/
+/* (see FixedPoint.h) instead of software floating point, which dominates the read path	*/
+/* on AVR. Calibration coefficients are kept in both forms. Only the conversion changes:	*/
+/* the converted value is stored, and its statistics kept, in float as before. Define it	*/
+/* in the build flags of the whole sketch, so that every file sees the same Sensor layout.	*/
+// #define SENSOR_FIXED_POINT
+
+/* SENSOR_INSTRUMENTATION: sensors time the stages of their hot path into log2 histograms	*/
+/* (see SensorInstrumentation.h), reported by Sensor::reportInstrumentation(). Without it	*/
+/* the timers compile to nothing. Like SENSOR_FIXED_POINT, define it for the whole sketch.	*/
+// #define SENSOR_INSTRUMENTATION
+
+/* SENSOR_CONTINUOUS_ADC: compiles the queues and the Timer1 and ADC interrupts of					*/
+/* ContinuousAdc. Without it no RAM is reserved for them and ADC_vect is left to the sketch.	*/
+// #define SENSOR_CONTINUOUS_ADC
+
+#endif
@@ -0,0 +1,103 @@
+#include "Arduino.h"
+#include "SensorFilter.h"
+
+/* Insertion sort: few samples, in place, and fast on the nearly sorted samples of a steady signal */
+static void sortSamples(uint16_t* samples, short int count)
+{
+  for(short int i = 1; i < count; i++)
+  {
+    uint16_t sample = samples[i];
+    short int j = i;
+    while(j > 0 && samples[j - 1] > sample)
+    {
+      samples[j] = samples[j - 1];
+      j--;
+    }
+    samples[j] = sample;
+  }
+}
+
+/* Median of sorted samples, as a sum over a divisor of 1 or 2 */
+static void sortedMedian(const uint16_t* samples, short int count, long* sum, short int* divisor)
+{
+  if(count % 2 == 1)
+  {
+    *sum = samples[count / 2];
+    *divisor = 1;
+  } else {
+    *sum = (long)samples[count / 2 - 1] + samples[count / 2];
+    *divisor = 2;
+  }
+}
+
+/* Median absolute deviation of sorted samples from median. The deviations below and above the	*/
+/* median are each sorted, so the k-th smallest is found by merging them, without a buffer			*/
+static long medianDeviation(const uint16_t* samples, short int count, long median)
+{
+  short int below = count / 2 - 1;
+  short int above = count / 2;
+  long deviation = 0;
+  for(short int k = 0; k <= (count - 1) / 2; k++)
+  {
+    long low = below >= 0 ? median - samples[below] : -1;
+    long high = above < count ? samples[above] - median : -1;
+    if(high < 0 || (low >= 0 && low <= high))
+    {
+      deviation = low;
+      below--;
+    } else {
+      deviation = high;
+      above++;
+    }
+  }
+  return deviation;
+}
+
+void filterSamples(const sensor_filter& filter, uint16_t* samples, short int count, long* sum, short int* divisor)
+{
+  *sum = 0;
+  *divisor = count;
+  if(filter.stage == FILTER_MEAN || count < 3)
+  {
+    for(short int i = 0; i < count; i++)
+    {
+      *sum += samples[i];
+    }
+  } else {
+    sortSamples(samples, count);
+
+    if(filter.stage == FILTER_MEDIAN || (filter.stage == FILTER_TRIMMED_MEAN && 2 * filter.trim >= count))
+    {
+      sortedMedian(samples, count, sum, divisor);
+    } else if(filter.stage == FILTER_TRIMMED_MEAN) {
+      for(short int i = filter.trim; i < count - filter.trim; i++)
+      {
+        *sum += samples[i];
+      }
+      *divisor = count - 2 * filter.trim;
+    } else {
+      /* Hampel: samples further than threshold scaled MADs from the median count as the median.	*/
+      /* The MAD is at least one unit, so that quantisation alone never makes outliers						*/
+      long median = samples[count / 2];
+      long deviation = medianDeviation(samples, count, median);
+      long limit = (long)(filter.threshold * HAMPEL_MAD_SCALE * (deviation > 0 ? deviation : 1));
+      for(short int i = 0; i < count; i++)
+      {
+        long distance = samples[i] > median ? samples[i] - median : median - samples[i];
+        *sum += distance > limit ? median : samples[i];
+      }
+    }
+  }
+
+  /* Back to ADC codes */
+  *divisor <<= filter.oversamplingBits;
+}
+
+short int filterWindow(const sensor_filter& filter, short int numReadings)
+{
+  if(filter.stage == FILTER_MEAN)
+  {
+    return 0;
+  }
+  return numReadings > MAX_FILTER_SAMPLES ? MAX_FILTER_SAMPLES : numReadings;
+}
@@ -0,0 +1,59 @@
+#ifndef SensorFilter_h
+#define SensorFilter_h
+
+#include "Arduino.h"
+
+/* Stages combining the samples of a reading */
+#define FILTER_MEAN						0x00		// Arithmetic mean, the default
+#define FILTER_MEDIAN					0x01		// Median, a spike never moves it
+#define FILTER_TRIMMED_MEAN		0x02		// Mean of the samples left once trim are dropped at each end
+#define FILTER_HAMPEL					0x03		// Mean of the samples, outliers replaced by the median
+
+#define MAX_OVERSAMPLING_BITS	4				// 4^4 = 256 conversions per sample
+
+/* Samples a reading keeps for the stages other than the mean, which only sums them */
+#ifndef MAX_FILTER_SAMPLES
+	#if defined(__AVR__)
+		#define MAX_FILTER_SAMPLES	9
+	#else
+		#define MAX_FILTER_SAMPLES	32
+	#endif
+#endif
+
+#define HAMPEL_MAD_SCALE			1.4826	// MAD to standard deviation, for normal noise
+
+/* Acquisition filter of an analogic sensor, the last field of sensor_params. Zero is a plain average */
+typedef struct sensor_filter {
+
+		unsigned char stage;						// FILTER_...
+		unsigned char oversamplingBits;	// Each sample sums 4^bits conversions, decimated by 2^bits: bits more of resolution
+		unsigned char trim;							// FILTER_TRIMMED_MEAN: samples dropped at each end
+		float threshold;								// FILTER_HAMPEL: outliers are further than threshold standard deviations from the median
+
+	} sensor_filter;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Filter pipeline of analogic readings.																								*/
+/*																																											*/
+/* A reading takes numReadings samples. With oversampling each sample is the sum of			*/
+/* 4^bits conversions shifted right by bits, which gives bits more bits of resolution		*/
+/* when the signal carries at least one LSB of noise. The stage then reduces the				*/
+/* samples, sorted in place, to a sum and a count whose ratio is the raw value in ADC		*/
+/* codes, so readings go on through the integer conversion paths.												*/
+/*																																											*/
+/* Stages other than the mean keep at most MAX_FILTER_SAMPLES samples, and sort them		*/
+/* with an insertion sort: time is bounded by MAX_FILTER_SAMPLES^2 comparisons.					*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+/* oversampledSample: one sample of the pin, with filter.oversamplingBits more bits */
+uint16_t oversampledSample(short int pin, unsigned char bits);
+
+/* filterSamples: reduces count samples (reordered) with the stage of filter. The raw value is *sum / *divisor */
+void filterSamples(const sensor_filter& filter, uint16_t* samples, short int count, long* sum, short int* divisor);
+
+/* filterWindow: samples kept by a reading of numReadings samples, 0 when the stage only sums them */
+short int filterWindow(const sensor_filter& filter, short int numReadings);
+
+#endif
@@ -0,0 +1,174 @@
+#include "Arduino.h"
+#include "SensorFormat.h"
+
+FormatBuffer::FormatBuffer(char* buffer, size_t size)
+{
+  this->_buffer = buffer;
+  this->_size = size;
+  this->clear();
+}
+
+FormatBuffer& FormatBuffer::clear()
+{
+  this->_length = 0;
+  this->_overflowed = this->_size == 0;
+  if(this->_size > 0)
+  {
+    this->_buffer[0] = 0x00;
+  }
+  return *this;
+}
+
+FormatBuffer& FormatBuffer::print(char c)
+{
+  if(this->_length + 1 < this->_size)
+  {
+    this->_buffer[this->_length++] = c;
+    this->_buffer[this->_length] = 0x00;
+  } else {
+    this->_overflowed = true;
+  }
+  return *this;
+}
+
+FormatBuffer& FormatBuffer::print(const char* text)
+{
+  if(text == NULL)
+  {
+    return *this;
+  }
+  while(*text)
+  {
+    this->print(*text++);
+  }
+  return *this;
+}
+
+FormatBuffer& FormatBuffer::print(const __FlashStringHelper* text)
+{
+  const char* p = reinterpret_cast<const char*>(text);
+  if(p == NULL)
+  {
+    return *this;
+  }
+  char c;
+  while((c = pgm_read_byte(p++)) != 0x00)
+  {
+    this->print(c);
+  }
+  return *this;
+}
+
+FormatBuffer& FormatBuffer::print(long value)
+{
+  char digits[11];
+  int n = 0;
+  unsigned long magnitude = value < 0 ? -(unsigned long)value : (unsigned long)value;
+
+  do
+  {
+    digits[n++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while(magnitude > 0);
+
+  if(value < 0)
+  {
+    this->print('-');
+  }
+  while(n > 0)
+  {
+    this->print(digits[--n]);
+  }
+  return *this;
+}
+
+FormatBuffer& FormatBuffer::print(float value, short int decimals)
+{
+  if(isnan(value))
+  {
+    return this->print("nan");
+  }
+  if(isinf(value))
+  {
+    return this->print(value < 0 ? "-inf" : "inf");
+  }
+
+  if(decimals < 0)
+  {
+    decimals = 0;
+  }
+  if(decimals > MAX_FORMAT_DECIMALS)
+  {
+    decimals = MAX_FORMAT_DECIMALS;
+  }
+
+  if(value < 0)
+  {
+    this->print('-');
+    value = -value;
+  }
+
+  /* Round at the last decimal shown */
+  unsigned long scale = 1;
+  for(short int i = 0; i < decimals; i++)
+  {
+    scale *= 10;
+  }
+  value += 0.5 / scale;
+
+  /* Like Print::printFloat, integer parts beyond unsigned long are not formatted */
+  if(value >= 4294967040.0)
+  {
+    return this->print("ovf");
+  }
+
+  unsigned long integer = (unsigned long)value;
+  unsigned long fraction = (unsigned long)((value - integer) * scale);
+  if(fraction >= scale)
+  {
+    fraction = scale - 1;
+  }
+
+  char digits[10];
+  int n = 0;
+  do
+  {
+    digits[n++] = '0' + integer % 10;
+    integer /= 10;
+  } while(integer > 0);
+  while(n > 0)
+  {
+    this->print(digits[--n]);
+  }
+
+  if(decimals > 0)
+  {
+    this->print('.');
+    for(short int i = decimals - 1; i >= 0; i--)
+    {
+      digits[i] = '0' + fraction % 10;
+      fraction /= 10;
+    }
+    for(short int i = 0; i < decimals; i++)
+    {
+      this->print(digits[i]);
+    }
+  }
+
+  return *this;
+}
+
+FormatBuffer& FormatBuffer::pad(size_t width)
+{
+  while(this->_length < width && !this->_overflowed)
+  {
+    this->print(' ');
+  }
+  return *this;
+}
+
+size_t formatFloat(char* buffer, size_t size, float value, short int decimals)
+{
+  FormatBuffer text(buffer, size);
+  return text.print(value, decimals).length();
+}
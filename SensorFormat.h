@@ -0,0 +1,49 @@
+#ifndef SensorFormat_h
+#define SensorFormat_h
+
+#include "Arduino.h"
+
+#define MAX_FORMAT_DECIMALS		6
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Heap-free text formatting into a caller-provided buffer.															*/
+/*																																											*/
+/* The buffer is always NUL terminated; text that does not fit is truncated and					*/
+/* overflowed() reports it. Floats are formatted with integer arithmetic, without				*/
+/* sprintf or dtostrf, with any number of decimals up to MAX_FORMAT_DECIMALS.						*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class FormatBuffer
+{
+	public:
+		FormatBuffer(char* buffer, size_t size);
+
+		FormatBuffer& print(const char* text);
+		FormatBuffer& print(const __FlashStringHelper* text);
+		FormatBuffer& print(char c);
+		FormatBuffer& print(long value);
+		FormatBuffer& print(float value, short int decimals);
+
+		/* pad: appends spaces up to width characters from the start of the buffer */
+		FormatBuffer& pad(size_t width);
+
+		/* clear: empties the buffer, to build another message in it */
+		FormatBuffer& clear();
+
+		const char* c_str() const { return this->_buffer; }
+		size_t length() const { return this->_length; }
+		bool overflowed() const { return this->_overflowed; }
+
+	private:
+		char* _buffer;
+		size_t _size;
+		size_t _length;
+		bool _overflowed;
+};
+
+/* formatFloat: writes value with the given decimals in buffer, returns the length written */
+size_t formatFloat(char* buffer, size_t size, float value, short int decimals);
+
+#endif
@@ -0,0 +1,255 @@
+#include "Arduino.h"
+#include "SensorHub.h"
+
+SensorHub::SensorHub()
+{
+  this->_heapSize = 0;
+  this->_count = 0;
+  this->_onReading = NULL;
+  this->resetStatistics();
+}
+
+int SensorHub::add(Sensor* sensor, unsigned long period, unsigned char priority, unsigned long jitter)
+{
+  if(this->_count >= MAX_HUB_SENSORS)
+  {
+    return -1;
+  }
+
+  unsigned char id = this->_count++;
+  hub_slot* slot = &this->_slots[id];
+  slot->sensor = sensor;
+  slot->period = period;
+  slot->jitter = jitter;
+  slot->priority = priority;
+  slot->deadline = millis();
+  slot->running = false;
+  slot->readings = 0;
+  slot->missed = 0;
+  slot->maxLateness = 0;
+
+  this->heapPush(id);
+  return id;
+}
+
+void SensorHub::run()
+{
+  unsigned long started = micros();
+  /* What the readings print during the cycle reaches each port in one write */
+  StreamRegistry::beginBatch();
+
+  /* Poll the readings in progress */
+  for(unsigned char id = 0; id < this->_count; id++)
+  {
+    if(this->_slots[id].running && this->_slots[id].sensor->poll())
+    {
+      this->complete(id);
+    }
+  }
+
+  /* Take the due sensors out of the heap, then order them by priority, then deadline */
+  unsigned long now = millis();
+  unsigned char due[MAX_HUB_SENSORS];
+  unsigned char dueCount = 0;
+  while(this->_heapSize > 0 && (long)(now - this->_slots[this->_heap[0]].deadline) >= 0)
+  {
+    unsigned char id = this->heapPop();
+    unsigned char i = dueCount++;
+    while(i > 0 && this->urgent(id, due[i - 1]))
+    {
+      due[i] = due[i - 1];
+      i--;
+    }
+    due[i] = id;
+  }
+
+  /* However overdue, a lower priority sensor doesn't start before a higher priority one */
+  for(unsigned char i = 0; i < dueCount; i++)
+  {
+    this->start(due[i], now);
+  }
+  StreamRegistry::endBatch();
+
+  this->_busyMicros += micros() - started;
+}
+
+void SensorHub::setCallback(void (*onReading)(Sensor* sensor, float value))
+{
+  this->_onReading = onReading;
+}
+
+unsigned long SensorHub::nextDeadline()
+{
+  return this->_heapSize > 0 ? this->_slots[this->_heap[0]].deadline : millis();
+}
+
+void SensorHub::start(unsigned char id, unsigned long now)
+{
+  hub_slot* slot = &this->_slots[id];
+
+  unsigned long lateness = now - slot->deadline;
+  if(lateness > slot->maxLateness)
+  {
+    slot->maxLateness = lateness;
+  }
+  if(lateness > slot->jitter)
+  {
+    slot->missed++;
+  }
+
+  /* Next deadline one period later, unless a whole period was lost: then restart from now */
+  if(lateness >= slot->period)
+  {
+    slot->deadline = now + slot->period;
+  } else {
+    slot->deadline += slot->period;
+  }
+
+  slot->running = true;
+  slot->sensor->begin();
+
+  /* The first sample is taken right away, quick readings may already be complete */
+  if(slot->sensor->poll())
+  {
+    this->complete(id);
+  }
+}
+
+void SensorHub::complete(unsigned char id)
+{
+  hub_slot* slot = &this->_slots[id];
+  slot->running = false;
+  slot->readings++;
+
+  if(this->_onReading != NULL)
+  {
+    this->_onReading(slot->sensor, slot->sensor->getLastValue());
+  }
+
+  this->heapPush(id);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Statistics																																						*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int SensorHub::getSensorsCount()
+{
+  return this->_count;
+}
+
+const hub_slot* SensorHub::getSlot(int id)
+{
+  if(id < 0 || id >= this->_count)
+  {
+    return NULL;
+  }
+  return &this->_slots[id];
+}
+
+unsigned long SensorHub::getMissedDeadlines()
+{
+  unsigned long missed = 0;
+  for(unsigned char id = 0; id < this->_count; id++)
+  {
+    missed += this->_slots[id].missed;
+  }
+  return missed;
+}
+
+float SensorHub::getUtilisation()
+{
+  unsigned long elapsed = micros() - this->_statisticsStart;
+  if(elapsed == 0)
+  {
+    return 0;
+  }
+  return (float)this->_busyMicros / elapsed;
+}
+
+void SensorHub::resetStatistics()
+{
+  this->_busyMicros = 0;
+  this->_statisticsStart = micros();
+  for(unsigned char id = 0; id < this->_count; id++)
+  {
+    this->_slots[id].readings = 0;
+    this->_slots[id].missed = 0;
+    this->_slots[id].maxLateness = 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Deadline heap																																				*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+bool SensorHub::earlier(unsigned char a, unsigned char b)
+{
+  long difference = (long)(this->_slots[a].deadline - this->_slots[b].deadline);
+  if(difference != 0)
+  {
+    return difference < 0;
+  }
+  return this->_slots[a].priority < this->_slots[b].priority;
+}
+
+bool SensorHub::urgent(unsigned char a, unsigned char b)
+{
+  if(this->_slots[a].priority != this->_slots[b].priority)
+  {
+    return this->_slots[a].priority < this->_slots[b].priority;
+  }
+  return (long)(this->_slots[a].deadline - this->_slots[b].deadline) < 0;
+}
+
+void SensorHub::heapPush(unsigned char id)
+{
+  unsigned char i = this->_heapSize++;
+  while(i > 0)
+  {
+    unsigned char parent = (i - 1) / 2;
+    if(!this->earlier(id, this->_heap[parent]))
+    {
+      break;
+    }
+    this->_heap[i] = this->_heap[parent];
+    i = parent;
+  }
+  this->_heap[i] = id;
+}
+
+unsigned char SensorHub::heapPop()
+{
+  unsigned char top = this->_heap[0];
+  unsigned char last = this->_heap[--this->_heapSize];
+  unsigned char i = 0;
+
+  while(true)
+  {
+    unsigned char child = 2 * i + 1;
+    if(child >= this->_heapSize)
+    {
+      break;
+    }
+    if(child + 1 < this->_heapSize && this->earlier(this->_heap[child + 1], this->_heap[child]))
+    {
+      child++;
+    }
+    if(!this->earlier(this->_heap[child], last))
+    {
+      break;
+    }
+    this->_heap[i] = this->_heap[child];
+    i = child;
+  }
+  if(this->_heapSize > 0)
+  {
+    this->_heap[i] = last;
+  }
+
+  return top;
+}
@@ -0,0 +1,87 @@
+#ifndef SensorHub_h
+#define SensorHub_h
+
+#include "Arduino.h"
+#include "Sensor.h"
+
+#define MAX_HUB_SENSORS		16
+
+/* Scheduling state of a sensor in the hub */
+typedef struct hub_slot {
+
+		Sensor* sensor;
+		unsigned long period;						// Milliseconds between the starts of two readings
+		unsigned long jitter;						// Lateness tolerated before a deadline counts as missed
+		unsigned char priority;					// Among due sensors, lower starts first, whatever their deadlines
+		unsigned long deadline;					// millis() at which the next reading must start
+		bool running;										// A reading is in progress
+		unsigned long readings;					// Completed readings
+		unsigned long missed;						// Readings started later than deadline + jitter
+		unsigned long maxLateness;			// Worst lateness seen, in milliseconds
+
+	} hub_slot;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Scheduler for many sensors, driven from loop().																			*/
+/*																																											*/
+/* Every sensor has its own period. Idle sensors wait in a min-heap ordered by deadline	*/
+/* and then priority. The sensors due at a run() start by priority, and by deadline			*/
+/* within a priority, so overdue low priority sensors can't delay a high priority one.	*/
+/* A due sensor starts an asynchronous reading (Sensor::begin())													*/
+/* that the hub polls at every run() until it completes. Deadlines advance by whole			*/
+/* periods, so readings don't drift; a sensor late by more than a period is realigned		*/
+/* on the current time. Output written during a run(), e.g. by the callback, is					*/
+/* coalesced per port (see StreamRegistry::beginBatch()).																*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class SensorHub
+{
+	public:
+		SensorHub();
+
+		/* add: schedules a sensor, its first reading starts at the next run(). Returns its id, -1 if the hub is full */
+		int add(Sensor* sensor, unsigned long period, unsigned char priority, unsigned long jitter);
+
+		/* run: starts the due readings and polls the ones in progress. Call it at every loop() */
+		void run();
+
+		/* setCallback: function called with every completed reading */
+		void setCallback(void (*onReading)(Sensor* sensor, float value));
+
+		/* nextDeadline: millis() at which the earliest idle sensor is due */
+		unsigned long nextDeadline();
+
+		//////////////////////////////////////////////////////////////////////////////////////////
+		/*																																											*/
+		/* Statistics																																						*/
+		/*																																											*/
+		//////////////////////////////////////////////////////////////////////////////////////////
+
+		int getSensorsCount();
+		const hub_slot* getSlot(int id);
+		unsigned long getMissedDeadlines();
+		/* getUtilisation: fraction of the time spent in run() doing sensors work, since the last reset */
+		float getUtilisation();
+		void resetStatistics();
+
+	private:
+		hub_slot _slots[MAX_HUB_SENSORS];
+		unsigned char _heap[MAX_HUB_SENSORS];			// Ids of the idle sensors, earliest deadline first
+		unsigned char _heapSize;
+		unsigned char _count;
+		void (*_onReading)(Sensor* sensor, float value);
+		unsigned long _busyMicros;
+		unsigned long _statisticsStart;
+
+		void start(unsigned char id, unsigned long now);
+		void complete(unsigned char id);
+		bool earlier(unsigned char a, unsigned char b);
+		/* urgent: a starts before b when both are due */
+		bool urgent(unsigned char a, unsigned char b);
+		void heapPush(unsigned char id);
+		unsigned char heapPop();
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "Arduino.h"
+#include "SensorInstrumentation.h"
+#include "SensorFormat.h"
+
+void histogramAdd(timing_histogram& histogram, unsigned long duration)
+{
+  histogram.count++;
+  histogram.total += duration;
+  if(duration > histogram.maximum)
+  {
+    histogram.maximum = duration;
+  }
+
+  unsigned char bucket = histogramBucket(duration);
+  if(histogram.buckets[bucket] < 0xFFFF)
+  {
+    histogram.buckets[bucket]++;
+  }
+}
+
+void histogramClear(timing_histogram& histogram)
+{
+  memset(&histogram, 0, sizeof(histogram));
+}
+
+unsigned char histogramBucket(unsigned long duration)
+{
+  unsigned char bucket = 0;
+  while(duration > 1 && bucket < INSTRUMENTATION_BUCKETS - 1)
+  {
+    duration >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+size_t histogramFormat(char* buffer, size_t size, const char* name, const timing_histogram& histogram)
+{
+  FormatBuffer line(buffer, size);
+  line.print(name).print(F(" n=")).print((long)histogram.count);
+  line.print(F(" avg=")).print((long)(histogram.count > 0 ? histogram.total / histogram.count : 0));
+  line.print(F(" max=")).print((long)histogram.maximum);
+
+  /* Empty buckets after the last used one are left out */
+  int last = INSTRUMENTATION_BUCKETS - 1;
+  while(last >= 0 && histogram.buckets[last] == 0)
+  {
+    last--;
+  }
+  line.print(F(" |"));
+  for(int i = 0; i <= last; i++)
+  {
+    line.print(' ').print((long)histogram.buckets[i]);
+  }
+
+  return line.length();
+}
@@ -0,0 +1,89 @@
+#ifndef SensorInstrumentation_h
+#define SensorInstrumentation_h
+
+#include "Arduino.h"
+
+#ifndef INSTRUMENTATION_BUCKETS
+#define INSTRUMENTATION_BUCKETS		16		// Bucket i counts durations from 2^i to 2^(i+1) - 1, the last one all longer ones
+#endif
+
+/* Streams of a sensor whose output is timed, the first ones */
+#ifndef INSTRUMENTED_STREAMS
+	#if defined(__AVR__)
+		#define INSTRUMENTED_STREAMS	1
+	#else
+		#define INSTRUMENTED_STREAMS	10		// All MAX_IO_STREAMS
+	#endif
+#endif
+
+/* Clock of the timings: micros() by default, or e.g. the DWT cycle counter of a Cortex-M */
+#ifndef INSTRUMENTATION_CLOCK
+#define INSTRUMENTATION_CLOCK()		micros()
+#endif
+
+#define INSTRUMENTATION_LINE_SIZE	112		// Room for a line of the report
+
+/* Durations of a stage */
+typedef struct timing_histogram {
+
+		unsigned long count;
+		unsigned long total;													// Sum of the durations, for the mean
+		unsigned long maximum;
+		unsigned short buckets[INSTRUMENTATION_BUCKETS];		// Saturate at 65535
+
+	} timing_histogram;
+
+/* Stages of the hot path of a sensor */
+typedef struct sensor_instrumentation {
+
+		timing_histogram rawInput;										// collectRawInput(), and the sampling of analogic readings
+		timing_histogram conversion;									// Average and calibration of each reading, whatever the model or table
+		timing_histogram format;											// formattedReading()
+		timing_histogram output[INSTRUMENTED_STREAMS];	// println() of a reading, or its frames, on each stream
+
+	} sensor_instrumentation;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Timings of the hot path, for SENSOR_INSTRUMENTATION builds (see SensorConfig.h).			*/
+/*																																											*/
+/* Each stage keeps a count, the total and the maximum of its durations, and a log2			*/
+/* histogram of them: adding a duration is a few shifts, and the histogram shows the		*/
+/* outliers a mean hides, e.g. a println() stalled by a full serial buffer. Without the	*/
+/* flag SENSOR_TIME() expands to nothing and sensors have no instrumentation fields.		*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+/* histogramAdd: counts a duration, in INSTRUMENTATION_CLOCK() ticks */
+void histogramAdd(timing_histogram& histogram, unsigned long duration);
+void histogramClear(timing_histogram& histogram);
+/* histogramBucket: bucket of a duration, floor(log2(duration)) up to the last bucket. 0 and 1 are in bucket 0 */
+unsigned char histogramBucket(unsigned long duration);
+/* histogramFormat: "name n=count avg=mean max=maximum | buckets", up to the last non-empty bucket. Returns the length */
+size_t histogramFormat(char* buffer, size_t size, const char* name, const timing_histogram& histogram);
+
+/* Times the rest of the scope it is declared in, into histogram unless it is NULL */
+class InstrumentationTimer
+{
+	public:
+		InstrumentationTimer(timing_histogram* histogram) : _histogram(histogram), _started(INSTRUMENTATION_CLOCK()) {}
+		~InstrumentationTimer()
+		{
+			if(this->_histogram != NULL)
+			{
+				histogramAdd(*this->_histogram, INSTRUMENTATION_CLOCK() - this->_started);
+			}
+		}
+
+	private:
+		timing_histogram* _histogram;
+		unsigned long _started;
+};
+
+#ifdef SENSOR_INSTRUMENTATION
+	#define SENSOR_TIME(histogram)	InstrumentationTimer instrumentationTimer(histogram)
+#else
+	#define SENSOR_TIME(histogram)
+#endif
+
+#endif
@@ -2,6 +2,7 @@
 #define SensorTypes_h
 
 #include <SimpleDHT.h>
+#include "DhtCache.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////
 /*																																											*/
@@ -9,7 +10,8 @@
 /*																																											*/
 //////////////////////////////////////////////////////////////////////////////////////////
 
-float basicAnalogicReading(short int pin, short int numReadings)
+/* Sum of numReadings analogic samples. Integers add up exactly and without soft-float */
+long analogicSum(short int pin, short int numReadings)
 {
 	pinMode(pin,INPUT);
 	/* When using Arduino Due, change resolution */
@@ -18,7 +20,7 @@ float basicAnalogicReading(short int pin, short int numReadings)
 		analogReadResolution(12);
 	#endif
 
-	float rawValuesSum = 0;
+	long rawValuesSum = 0;
 
 	for (short int i = 0; i < numReadings; i++)
 	{
@@ -32,11 +34,43 @@ float basicAnalogicReading(short int pin, short int numReadings)
 		analogReadResolution(10);
 	#endif
 
+	return rawValuesSum;
+}
+
+float basicAnalogicReading(short int pin, short int numReadings)
+{
 	/* Return the average of the readings */
-	return rawValuesSum / numReadings;
+	return (float)analogicSum(pin, numReadings) / numReadings;
 
 }
 
+/* A single analogic sample, at the highest resolution available, as taken by basicAnalogicReading */
+int analogicSample(short int pin)
+{
+	#ifdef ARDUINO_DUE
+		analogReadResolution(12);
+	#endif
+
+	int value = analogRead(pin);
+
+	#ifdef ARDUINO_DUE
+		analogReadResolution(10);
+	#endif
+
+	return value;
+}
+
+/* A sample with bits more bits of resolution: 4^bits conversions, decimated by 2^bits */
+uint16_t oversampledSample(short int pin, unsigned char bits)
+{
+	long sum = 0;
+	for(long i = 0; i < (1L << (2 * bits)); i++)
+	{
+		sum += analogicSample(pin);
+	}
+	return (uint16_t)(sum >> bits);
+}
+
 float basicDigitalReading(short int pin, short int numReadings)
 {
 	pinMode(pin,INPUT);
@@ -45,50 +79,17 @@ float basicDigitalReading(short int pin, short int numReadings)
 
 }
 
+/* Both DHT readings are served by the shared per-pin transaction cache: a HYGROMETER and an	*/
+/* AIR_THERMOMETER on the same pin cost a single read2() per DHT_MIN_INTERVAL.							*/
 float dhtHumidityReading(short int pin, short int numReadings)
 {
-	pinMode(pin,INPUT);
-	float rawValuesSum = 0;
-	byte data[40];
-	float humidity2 = 0;
-	float temperature2 = 0;
-	SimpleDHT11 dht((int)pin);
-
-	// for (short int i = 0; i < numReadings; i++)
-	// {
-	// 	/* Read input and add it to the values sum */
-	// 	dht.read2(&temperature,&humidity,data);
-	// 	rawValuesSum += humidity;
-	// }
-	dht.read2(&temperature2,&humidity2,NULL);
-	/* Return the average of the readings */
-	// return rawValuesSum / numReadings;
-	return humidity2;
-
+	return DhtCache::read(pin)->humidity;
 }
 
 
 float dhtTemperatureReading(short int pin, short int numReadings)
 {
-
-	pinMode(pin,INPUT);
-	float rawValuesSum = 0;
-	byte data[40];
-	float humidity = 0;
-	float temperature = 0;
-	SimpleDHT11 dht((int)pin);
-
-	// for (short int i = 0; i < numReadings; i++)
-	// {
-	// 	/* Read input and add it to the values sum */
-	// 	dht.read2(&temperature,&humidity,data);
-	// 	rawValuesSum += temperature;
-	// }
-	dht.read2(&temperature,&humidity,data);
-	/* Return the average of the readings */
-	// return rawValuesSum / numReadings;
-	return temperature;
-
+	return DhtCache::read(pin)->temperature;
 }
 
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -106,27 +107,55 @@ float dhtTemperatureReading(short int pin, short int numReadings)
 	/* measure_unit (string containing a measure unit symbol, array of chars)																					*/
 	/* decimals (presentation decimals numbers, short int)																														*/
 	/* readingFunction (function to be used to read, float (*readingFunction)(short int pin, short int numReadings))	*/
+	/* filter (optional, acquisition filter of analogic sensors, sensor_filter, see SensorFilter.h)										*/
 	/*																																																								*/
 	/* TODO: set correct defaults for all sensor types																																*/
 	/*																																																								*/
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// sensor_params anemometer_params = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Anemometer", "m/s", &basicReading };
-	sensor_params ec_meter_params = { 1, 0, 100, 10, 2, {400.0, 2000.0}, "EC meter", "uS/cm",0, &basicAnalogicReading };						// TODO: use utf-8 characters for maths and chemistry symbols
-	sensor_params hygrometer_params = { 1, 0, 100, 10, 2, {4.0, 7.0}, "Hygrometer", "%",1, &dhtHumidityReading };
-	sensor_params light_sensor_params = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Light intensity", "xx",0, &basicAnalogicReading };
-	sensor_params red_light_sensor_params = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Red light intensity", "xx",0, &basicAnalogicReading };
-	sensor_params blue_light_sensor_params = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Blue light intensity", "xx",0, &basicAnalogicReading };
-	sensor_params ultraviolet_light_sensor_params = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Ultraviolet light intensity", "xx",0, &basicAnalogicReading };
+	const sensor_params ec_meter_params PROGMEM = { 1, 0, 100, 10, 2, {400.0, 2000.0}, "EC meter", "uS/cm",0, &basicAnalogicReading, {} };						// TODO: use utf-8 characters for maths and chemistry symbols
+	const sensor_params hygrometer_params PROGMEM = { 1, 0, 100, 10, 2, {4.0, 7.0}, "Hygrometer", "%",1, &dhtHumidityReading, {} };
+	const sensor_params light_sensor_params PROGMEM = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Light intensity", "xx",0, &basicAnalogicReading, {} };
+	const sensor_params red_light_sensor_params PROGMEM = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Red light intensity", "xx",0, &basicAnalogicReading, {} };
+	const sensor_params blue_light_sensor_params PROGMEM = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Blue light intensity", "xx",0, &basicAnalogicReading, {} };
+	const sensor_params ultraviolet_light_sensor_params PROGMEM = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Ultraviolet light intensity", "xx",0, &basicAnalogicReading, {} };
 	// sensor_params lux_meter_params = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Lux meter", "pH", &basicReading };
 	// sensor_params ph_meter_params = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "PH meter", "pH", &basicReading };
-	sensor_params soil_moisture_params = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Soil moisture meter", "%",2, &basicAnalogicReading };
-	sensor_params analogic_thermometer_params = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Thermometer", "C",1, &basicAnalogicReading  };		// TODO: use utf-8 characters for maths and chemistry symbols
-	sensor_params air_thermometer_params = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Air thermometer", "C",1, &dhtTemperatureReading  };		// TODO: use utf-8 characters for maths and chemistry symbols
-	sensor_params co_sensor_params = { 1, 0, 100, 10, 2, {0.0, 100.0}, "CO sensor", "ppm",0, &basicAnalogicReading  };		// TODO: use utf-8 characters for maths and chemistry symbols
-	sensor_params nox_sensor_params = { 1, 0, 100, 10, 2, {4.0, 7.0}, "NOx sensor", "ppm",0, &basicAnalogicReading  };		// TODO: use utf-8 characters for maths and chemistry symbols
-	sensor_params etoh_sensor_params = { 1, 0, 100, 10, 2, {4.0, 7.0}, "EtOH sensor", "ppm",0, &basicAnalogicReading  };		// TODO: use utf-8 characters for maths and chemistry symbols
+	const sensor_params soil_moisture_params PROGMEM = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Soil moisture meter", "%",2, &basicAnalogicReading, {} };
+	const sensor_params analogic_thermometer_params PROGMEM = { 1, 0, 100, 10, 2, {0.0, 100.0}, "Thermometer", "C",1, &basicAnalogicReading, {}  };		// TODO: use utf-8 characters for maths and chemistry symbols
+	const sensor_params air_thermometer_params PROGMEM = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Air thermometer", "C",1, &dhtTemperatureReading, {}  };		// TODO: use utf-8 characters for maths and chemistry symbols
+	const sensor_params co_sensor_params PROGMEM = { 1, 0, 100, 10, 2, {0.0, 100.0}, "CO sensor", "ppm",0, &basicAnalogicReading, {}  };		// TODO: use utf-8 characters for maths and chemistry symbols
+	const sensor_params nox_sensor_params PROGMEM = { 1, 0, 100, 10, 2, {4.0, 7.0}, "NOx sensor", "ppm",0, &basicAnalogicReading, {}  };		// TODO: use utf-8 characters for maths and chemistry symbols
+	const sensor_params etoh_sensor_params PROGMEM = { 1, 0, 100, 10, 2, {4.0, 7.0}, "EtOH sensor", "ppm",0, &basicAnalogicReading, {}  };		// TODO: use utf-8 characters for maths and chemistry symbols
 	// sensor_params thermometer_soil_params = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Soil thermometer", "C", &basicReading };  // TODO: use utf-8 characters for maths and chemistry symbols
 	// sensor_params thermometer_water_params = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Water thermometer", "C", &basicReading };// TODO: use utf-8 characters for maths and chemistry symbols
-	sensor_params volume_params = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Volume meter", "Db",1, &basicAnalogicReading };
+	const sensor_params volume_params PROGMEM = { -0.0273, 19.655, 100, 10, 2, {4.0, 7.0}, "Volume meter", "Db",1, &basicAnalogicReading, {} };
+
+	/* Built-in types by type code. CUSTOM and unknown codes get the EC meter, as they always did, and become CUSTOM */
+	const sensor_params* const builtInSensorTypes[] PROGMEM = {
+		&ec_meter_params,											// CUSTOM
+		&hygrometer_params,										// HYGROMETER
+		&air_thermometer_params,							// AIR_THERMOMETER
+		&co_sensor_params,										// CO_SENSOR
+		&nox_sensor_params,										// NOX_SENSOR
+		&etoh_sensor_params,									// ETOH_SENSOR
+		&volume_params,												// VOLUME_SENSOR
+		&light_sensor_params,									// LIGHT_SENSOR
+		&red_light_sensor_params,							// RED_LIGHT_SENSOR
+		&blue_light_sensor_params,						// BLUE_LIGHT_SENSOR
+		&ultraviolet_light_sensor_params,			// ULTRAVIOLET_LIGHT_SENSOR
+		&analogic_thermometer_params,					// ANALOGIC_THERMOMETER
+		&soil_moisture_params									// SOIL_MOISTURE_METER
+	};
+
+	/* builtInSensorParams: address in flash of the parameters of a type, to be read with memcpy_P */
+	const sensor_params* builtInSensorParams(short int sensorType)
+	{
+		if(sensorType < 0 || sensorType > SOIL_MOISTURE_METER)
+		{
+			sensorType = CUSTOM;
+		}
+		return (const sensor_params*)pgm_read_ptr(&builtInSensorTypes[sensorType]);
+	}
 
 #endif
@@ -0,0 +1,408 @@
+#include <new>
+#include "Arduino.h"
+#include "StreamRegistry.h"
+
+shared_channel StreamRegistry::_channels[MAX_SHARED_STREAMS];
+OutputBuffer StreamRegistry::_buffers[MAX_OUTPUT_BUFFERS];
+byte StreamRegistry::_batch[STREAM_BATCH_SIZE];
+unsigned int StreamRegistry::_batchLength = 0;
+signed char StreamRegistry::_batchHandle = -1;
+unsigned char StreamRegistry::_batchDepth = 0;
+
+int StreamRegistry::open(Stream &stream)
+{
+  return StreamRegistry::acquire(CHANNEL_STREAM, &stream, NULL, NULL, NULL, NULL);
+}
+
+int StreamRegistry::open(Stream &stream,char (*getKey)())
+{
+  return StreamRegistry::acquire(CHANNEL_STREAM_KEY, &stream, NULL, NULL, getKey, NULL);
+}
+
+int StreamRegistry::open(Stream &stream,void (*writeChar)(String s))
+{
+  return StreamRegistry::acquire(CHANNEL_STREAM_WRITE, &stream, NULL, NULL, NULL, writeChar);
+}
+
+int StreamRegistry::open(char (*getKey)(),void (*writeChar)(String s))
+{
+  return StreamRegistry::acquire(CHANNEL_KEY_WRITE, NULL, NULL, NULL, getKey, writeChar);
+}
+
+int StreamRegistry::open(Stream &stream,Keypad* keypad)
+{
+  return StreamRegistry::acquire(CHANNEL_STREAM_KEYPAD, &stream, keypad, NULL, NULL, NULL);
+}
+
+int StreamRegistry::open(Stream &stream,LiquidCrystal* lcd)
+{
+  return StreamRegistry::acquire(CHANNEL_STREAM_LCD, &stream, NULL, lcd, NULL, NULL);
+}
+
+int StreamRegistry::open(Keypad* keypad,LiquidCrystal* lcd)
+{
+  return StreamRegistry::acquire(CHANNEL_KEYPAD_LCD, NULL, keypad, lcd, NULL, NULL);
+}
+
+int StreamRegistry::acquire(unsigned char kind, Stream* stream, Keypad* keypad, LiquidCrystal* lcd, char (*getKey)(), void (*writeChar)(String s))
+{
+  int handle = StreamRegistry::find(kind, stream, keypad, lcd, getKey, writeChar);
+  if(handle < 0 || _channels[handle].users++ > 0)
+  {
+    return handle;
+  }
+
+  /* First user: the channel is built with the constructor of its kind */
+  void* storage = _channels[handle].storage;
+  switch(kind)
+  {
+    case CHANNEL_STREAM:
+      new (storage) InteractionChannel(*stream);
+      break;
+    case CHANNEL_STREAM_KEY:
+      new (storage) InteractionChannel(*stream, getKey);
+      break;
+    case CHANNEL_STREAM_WRITE:
+      new (storage) InteractionChannel(*stream, writeChar);
+      break;
+    case CHANNEL_KEY_WRITE:
+      new (storage) InteractionChannel(getKey, writeChar);
+      break;
+    case CHANNEL_STREAM_KEYPAD:
+      new (storage) InteractionChannel(*stream, keypad);
+      break;
+    case CHANNEL_STREAM_LCD:
+      new (storage) InteractionChannel(*stream, lcd);
+      break;
+    case CHANNEL_KEYPAD_LCD:
+      new (storage) InteractionChannel(keypad, lcd);
+      break;
+  }
+  return handle;
+}
+
+int StreamRegistry::find(unsigned char kind, Stream* stream, Keypad* keypad, LiquidCrystal* lcd, char (*getKey)(), void (*writeChar)(String s))
+{
+  int free = -1;
+  for(int i = 0; i < MAX_SHARED_STREAMS; i++)
+  {
+    shared_channel* channel = &_channels[i];
+    if(channel->users == 0)
+    {
+      free = free < 0 ? i : free;
+    }
+    else if(channel->kind == kind && channel->stream == stream && channel->keypad == keypad && channel->lcd == lcd
+      && channel->getKey == getKey && channel->writeChar == writeChar)
+    {
+      /* The count of users must not wrap */
+      return channel->users < 255 ? i : -1;
+    }
+  }
+
+  if(free >= 0)
+  {
+    _channels[free].kind = kind;
+    _channels[free].stream = stream;
+    _channels[free].keypad = keypad;
+    _channels[free].lcd = lcd;
+    _channels[free].getKey = getKey;
+    _channels[free].writeChar = writeChar;
+    _channels[free].buffer = -1;
+  }
+  return free;
+}
+
+bool StreamRegistry::retain(int handle)
+{
+  if(StreamRegistry::channel(handle) == NULL || _channels[handle].users == 255)
+  {
+    return false;
+  }
+  _channels[handle].users++;
+  return true;
+}
+
+void StreamRegistry::close(int handle)
+{
+  InteractionChannel* channel = StreamRegistry::channel(handle);
+  if(channel != NULL && _channels[handle].users == 1)
+  {
+    StreamRegistry::sendBatch(handle);
+    StreamRegistry::setUnbuffered(handle);
+  }
+  if(channel != NULL && --_channels[handle].users == 0)
+  {
+    channel->~InteractionChannel();
+    _channels[handle].kind = 0;
+  }
+}
+
+InteractionChannel* StreamRegistry::channel(int handle)
+{
+  if(handle < 0 || handle >= MAX_SHARED_STREAMS || _channels[handle].users == 0)
+  {
+    return NULL;
+  }
+  return reinterpret_cast<InteractionChannel*>(_channels[handle].storage);
+}
+
+unsigned char StreamRegistry::users(int handle)
+{
+  return StreamRegistry::channel(handle) != NULL ? _channels[handle].users : 0;
+}
+
+unsigned char StreamRegistry::channelsInUse()
+{
+  unsigned char count = 0;
+  for(int i = 0; i < MAX_SHARED_STREAMS; i++)
+  {
+    if(_channels[i].users > 0)
+    {
+      count++;
+    }
+  }
+  return count;
+}
+
+bool StreamRegistry::setBuffered(int handle, unsigned char policy, unsigned int lowWatermark, unsigned int highWatermark, unsigned long maxDelay)
+{
+  if(StreamRegistry::channel(handle) == NULL || _channels[handle].writeChar != NULL)
+  {
+    return false;
+  }
+
+  /* A buffer is free when no channel uses it */
+  int buffer = _channels[handle].buffer;
+  for(int b = 0; b < MAX_OUTPUT_BUFFERS && buffer < 0; b++)
+  {
+    bool used = false;
+    for(int i = 0; i < MAX_SHARED_STREAMS; i++)
+    {
+      used = used || (_channels[i].users > 0 && _channels[i].buffer == b);
+    }
+    buffer = used ? -1 : b;
+  }
+  if(buffer < 0)
+  {
+    return false;
+  }
+
+  StreamRegistry::sendBatch(handle);
+  StreamRegistry::flush(handle);
+  _buffers[buffer].configure(policy, lowWatermark, highWatermark, maxDelay);
+  _channels[handle].buffer = buffer;
+  _channels[handle].drainBudget = OUTPUT_DRAIN_BUDGET;
+  return true;
+}
+
+void StreamRegistry::setUnbuffered(int handle)
+{
+  if(StreamRegistry::buffer(handle) != NULL)
+  {
+    StreamRegistry::flush(handle);
+    _channels[handle].buffer = -1;
+  }
+}
+
+OutputBuffer* StreamRegistry::buffer(int handle)
+{
+  if(StreamRegistry::channel(handle) == NULL || _channels[handle].buffer < 0)
+  {
+    return NULL;
+  }
+  return &_buffers[_channels[handle].buffer];
+}
+
+void StreamRegistry::print(int handle, const char* text)
+{
+  if(StreamRegistry::buffer(handle) != NULL)
+  {
+    StreamRegistry::write(handle, (const byte*)text, strlen(text));
+  }
+  else if(StreamRegistry::output(handle) != NULL)
+  {
+    StreamRegistry::emit(handle, (const byte*)text, strlen(text));
+  }
+  else if(StreamRegistry::channel(handle) != NULL)
+  {
+    StreamRegistry::channel(handle)->print(String(text));
+  }
+}
+
+void StreamRegistry::print(int handle, char c)
+{
+  if(StreamRegistry::buffer(handle) != NULL)
+  {
+    StreamRegistry::write(handle, (const byte*)&c, 1);
+  }
+  else if(StreamRegistry::output(handle) != NULL)
+  {
+    StreamRegistry::emit(handle, (const byte*)&c, 1);
+  }
+  else if(StreamRegistry::channel(handle) != NULL)
+  {
+    StreamRegistry::channel(handle)->print(c);
+  }
+}
+
+void StreamRegistry::println(int handle, const char* text)
+{
+  if(StreamRegistry::buffer(handle) != NULL)
+  {
+    StreamRegistry::write(handle, (const byte*)text, strlen(text));
+    StreamRegistry::write(handle, (const byte*)"\r\n", 2);
+  }
+  else if(StreamRegistry::output(handle) != NULL)
+  {
+    StreamRegistry::emit(handle, (const byte*)text, strlen(text));
+    StreamRegistry::emit(handle, (const byte*)"\r\n", 2);
+  }
+  else if(StreamRegistry::channel(handle) != NULL)
+  {
+    StreamRegistry::channel(handle)->println(String(text));
+  }
+}
+
+void StreamRegistry::write(int handle, const byte* data, size_t length)
+{
+  InteractionChannel* channel = StreamRegistry::channel(handle);
+  OutputBuffer* buffer = StreamRegistry::buffer(handle);
+  if(buffer == NULL)
+  {
+    if(StreamRegistry::output(handle) != NULL)
+    {
+      StreamRegistry::emit(handle, data, length);
+      return;
+    }
+    for(size_t i = 0; channel != NULL && i < length; i++)
+    {
+      channel->write(data[i]);
+    }
+    return;
+  }
+
+  size_t written = buffer->write(data, length);
+
+  /* Blocking policy: the sink takes the oldest bytes until the rest fits */
+  while(buffer->policy() == OUTPUT_BLOCK && written < length)
+  {
+    channel->write(buffer->take());
+    written += buffer->write(data + written, length - written);
+  }
+}
+
+void StreamRegistry::beginBatch()
+{
+  _batchDepth++;
+}
+
+void StreamRegistry::endBatch()
+{
+  if(_batchDepth > 0 && --_batchDepth == 0)
+  {
+    StreamRegistry::sendBatch(-1);
+  }
+}
+
+void StreamRegistry::emit(int handle, const byte* data, size_t length)
+{
+  if(_batchDepth == 0)
+  {
+    StreamRegistry::output(handle)->write(data, length);
+    return;
+  }
+
+  /* Bytes of another channel, or too many, go out first */
+  if(_batchHandle != handle || _batchLength + length > STREAM_BATCH_SIZE)
+  {
+    StreamRegistry::sendBatch(-1);
+  }
+  if(length > STREAM_BATCH_SIZE)
+  {
+    StreamRegistry::output(handle)->write(data, length);
+    return;
+  }
+  memcpy(_batch + _batchLength, data, length);
+  _batchLength += length;
+  _batchHandle = handle;
+}
+
+void StreamRegistry::sendBatch(int handle)
+{
+  if(_batchHandle < 0 || (handle >= 0 && handle != _batchHandle))
+  {
+    return;
+  }
+  Print* output = StreamRegistry::output(_batchHandle);
+  if(output != NULL)
+  {
+    output->write(_batch, _batchLength);
+  }
+  _batchLength = 0;
+  _batchHandle = -1;
+}
+
+Print* StreamRegistry::output(int handle)
+{
+  /* As InteractionChannel: a writeChar function takes everything, otherwise the LCD, otherwise the stream */
+  if(StreamRegistry::channel(handle) == NULL || _channels[handle].writeChar != NULL)
+  {
+    return NULL;
+  }
+  if(_channels[handle].lcd != NULL)
+  {
+    return _channels[handle].lcd;
+  }
+  return _channels[handle].stream;
+}
+
+void StreamRegistry::setDrainBudget(int handle, unsigned char bytes)
+{
+  if(StreamRegistry::buffer(handle) != NULL)
+  {
+    _channels[handle].drainBudget = bytes;
+  }
+}
+
+void StreamRegistry::drain()
+{
+  for(int i = 0; i < MAX_SHARED_STREAMS; i++)
+  {
+    if(StreamRegistry::buffer(i) == NULL)
+    {
+      continue;
+    }
+    int budget = _channels[i].drainBudget;
+    if(budget == DRAIN_TX_ROOM)
+    {
+      budget = StreamRegistry::output(i)->availableForWrite();
+    }
+    if(budget > 0)
+    {
+      StreamRegistry::drain(i, budget);
+    }
+  }
+}
+
+size_t StreamRegistry::drain(int handle, size_t budget)
+{
+  OutputBuffer* buffer = StreamRegistry::buffer(handle);
+  size_t sent = 0;
+  while(buffer != NULL && sent < budget && buffer->due())
+  {
+    StreamRegistry::channel(handle)->write(buffer->take());
+    sent++;
+  }
+  return sent;
+}
+
+void StreamRegistry::flush(int handle)
+{
+  OutputBuffer* buffer = StreamRegistry::buffer(handle);
+  if(buffer == NULL)
+  {
+    return;
+  }
+  buffer->flush();
+  while(StreamRegistry::drain(handle, OUTPUT_DRAIN_BUDGET) > 0) { }
+}
@@ -0,0 +1,155 @@
+#ifndef StreamRegistry_h
+#define StreamRegistry_h
+
+#include "Arduino.h"
+#include "InteractionChannel.h"
+#include "OutputBuffer.h"
+
+#ifndef MAX_SHARED_STREAMS
+	#define MAX_SHARED_STREAMS	10		// As MAX_IO_STREAMS, so that one sensor can fill all its slots
+#endif
+
+#ifndef MAX_OUTPUT_BUFFERS
+	#if defined(__AVR__)
+		#define MAX_OUTPUT_BUFFERS	2
+	#else
+		#define MAX_OUTPUT_BUFFERS	4
+	#endif
+#endif
+
+#ifndef OUTPUT_DRAIN_BUDGET
+	#define OUTPUT_DRAIN_BUDGET		16		// Default bytes sent per channel by each drain()
+#endif
+#define DRAIN_TX_ROOM					0			// Drain budget: what the sink's availableForWrite() takes without blocking
+
+/* Bytes coalesced by a batch before they are sent, shared by all the channels */
+#ifndef STREAM_BATCH_SIZE
+	#if defined(__AVR__)
+		#define STREAM_BATCH_SIZE	64
+	#else
+		#define STREAM_BATCH_SIZE	256
+	#endif
+#endif
+
+/* Kinds of channel, one per InteractionChannel constructor */
+#define CHANNEL_STREAM					0x01
+#define CHANNEL_STREAM_KEY			0x02
+#define CHANNEL_STREAM_WRITE		0x03
+#define CHANNEL_KEY_WRITE				0x04
+#define CHANNEL_STREAM_KEYPAD		0x05
+#define CHANNEL_STREAM_LCD			0x06
+#define CHANNEL_KEYPAD_LCD			0x07
+
+/* A channel of the pool and what it was opened with, to find it again */
+typedef struct shared_channel {
+
+		unsigned char kind;							// CHANNEL_..., 0 for a free slot
+		unsigned char users;						// Handles open on the channel
+		signed char buffer;							// Output buffer of the channel, -1 if it writes directly
+		unsigned char drainBudget;			// Bytes sent by each drain(), or DRAIN_TX_ROOM
+		Stream* stream;
+		Keypad* keypad;
+		LiquidCrystal* lcd;
+		char (*getKey)();
+		void (*writeChar)(String s);
+		alignas(InteractionChannel) unsigned char storage[sizeof(InteractionChannel)];
+
+	} shared_channel;
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Node-wide registry of I/O channels.																									*/
+/*																																											*/
+/* Channels are built in a static pool instead of the heap, and shared: opening a				*/
+/* channel with the same arguments as an open one returns its handle and counts one			*/
+/* more user. Ten sensors printing on Serial use one channel, and each keeps a one byte	*/
+/* handle per stream. A channel is destroyed when its last handle is closed.						*/
+/*																																											*/
+/* Writes to a shared channel are coalesced between beginBatch() and endBatch(), e.g.		*/
+/* around a SensorHub cycle: consecutive writes to the same port are gathered in one		*/
+/* buffer and sent with a single write(), so ten sensors printing on Serial make one		*/
+/* write of all their lines. Writing to another channel, or a full batch, sends the			*/
+/* pending bytes first, so every port gets its bytes in order. Bytes written to a port	*/
+/* without the registry during a batch can overtake the pending ones.										*/
+/*																																											*/
+/* Output to a slow sink (SoftwareSerial, Bluetooth modules, I2C LCDs) can go through		*/
+/* an OutputBuffer: messages are then only copied, and drain() sends them from loop(),	*/
+/* so readings are not stalled by the sink. Draining is not interrupt safe.							*/
+/* Each drain() sends at most the drain budget of a channel: a write to a full sink			*/
+/* blocks until it takes the byte, so the budget bounds the time a pass can stall. With	*/
+/* DRAIN_TX_ROOM a pass only sends what availableForWrite() reports, which never blocks	*/
+/* on HardwareSerial. SoftwareSerial reports 0 and sends each byte in the foreground,		*/
+/* about 1 ms per byte at 9600 bauds: give it a small byte budget instead.							*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class StreamRegistry
+{
+	public:
+		/* open: handle of the channel built with these arguments, -1 if the pool is full or the channel has 255 users.	*/
+		/* Every handle must be closed																																			*/
+		static int open(Stream &stream);
+		static int open(Stream &stream,char (*getKey)());
+		static int open(Stream &stream,void (*writeChar)(String s));
+		static int open(char (*getKey)(),void (*writeChar)(String s));
+		static int open(Stream &stream,Keypad* keypad);
+		static int open(Stream &stream,LiquidCrystal* lcd);
+		static int open(Keypad* keypad,LiquidCrystal* lcd);
+
+		/* retain: one more user of an open handle, e.g. a sensor subscribing to it */
+		static bool retain(int handle);
+		static void close(int handle);
+
+		/* channel: the channel of an open handle, NULL otherwise */
+		static InteractionChannel* channel(int handle);
+		static unsigned char users(int handle);
+		static unsigned char channelsInUse();
+
+		/* setBuffered: queues the output of the channel in a buffer of the pool, see OutputBuffer.h. False if no		*/
+		/* buffer is free, or for channels with a writeChar function, which decide themselves how they send				*/
+		static bool setBuffered(int handle, unsigned char policy, unsigned int lowWatermark, unsigned int highWatermark, unsigned long maxDelay);
+		/* setUnbuffered: sends what is queued and goes back to writing directly */
+		static void setUnbuffered(int handle);
+		/* buffer: the output buffer of the channel, for its level and dropped bytes. NULL if it writes directly */
+		static OutputBuffer* buffer(int handle);
+		/* setDrainBudget: bytes sent by each drain() on a buffered channel, DRAIN_TX_ROOM to send only what the sink takes without blocking */
+		static void setDrainBudget(int handle, unsigned char bytes);
+
+		/* beginBatch/endBatch: coalesce the writes in between, see above. Batches nest, the outermost end sends */
+		static void beginBatch();
+		static void endBatch();
+
+		/* Output of the sensors, queued on buffered channels */
+		static void print(int handle, const char* text);
+		static void print(int handle, char c);
+		static void println(int handle, const char* text);
+		static void write(int handle, const byte* data, size_t length);
+
+		/* drain: sends up to its drain budget of due bytes on every buffered channel. Call it at every loop() */
+		static void drain();
+		/* drain: sends up to budget due bytes of a channel, from loop() only. Returns the bytes sent */
+		static size_t drain(int handle, size_t budget);
+		/* flush: sends all the bytes queued on the channel, blocking */
+		static void flush(int handle);
+
+	private:
+		static shared_channel _channels[MAX_SHARED_STREAMS];
+		static OutputBuffer _buffers[MAX_OUTPUT_BUFFERS];
+		static byte _batch[STREAM_BATCH_SIZE];			// Pending bytes of _batchHandle
+		static unsigned int _batchLength;
+		static signed char _batchHandle;						// -1 when nothing is pending
+		static unsigned char _batchDepth;						// Nested beginBatch() calls
+
+		/* output: the Print a channel writes to, written directly so that no String is built for the	*/
+		/* InteractionChannel interface. NULL for writeChar channels, whose function takes a String			*/
+		static Print* output(int handle);
+		/* acquire: handle of the channel opened with these arguments, built in a free slot if there is none */
+		static int acquire(unsigned char kind, Stream* stream, Keypad* keypad, LiquidCrystal* lcd, char (*getKey)(), void (*writeChar)(String s));
+		static int find(unsigned char kind, Stream* stream, Keypad* keypad, LiquidCrystal* lcd, char (*getKey)(), void (*writeChar)(String s));
+		/* emit: writes to the Print of a channel, coalesced while a batch is open */
+		static void emit(int handle, const byte* data, size_t length);
+		/* sendBatch: writes the pending bytes, if they belong to handle (any handle if -1) */
+		static void sendBatch(int handle);
+};
+
+#endif
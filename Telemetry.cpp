@@ -0,0 +1,117 @@
+#include "Arduino.h"
+#include "Telemetry.h"
+
+unsigned short crc16(const byte* data, size_t length)
+{
+  unsigned short crc = 0xFFFF;
+  while(length--)
+  {
+    crc ^= (unsigned short)(*data++) << 8;
+    for(int bit = 0; bit < 8; bit++)
+    {
+      crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+size_t cobsEncode(const byte* input, size_t length, byte* output)
+{
+  size_t codePosition = 0;
+  size_t written = 1;
+  byte code = 1;
+
+  for(size_t i = 0; i < length; i++)
+  {
+    if(input[i] == 0x00)
+    {
+      output[codePosition] = code;
+      codePosition = written++;
+      code = 1;
+      continue;
+    }
+
+    output[written++] = input[i];
+    code++;
+    if(code == 0xFF)
+    {
+      /* Longest run: start a new block */
+      output[codePosition] = code;
+      codePosition = written++;
+      code = 1;
+    }
+  }
+  output[codePosition] = code;
+
+  return written;
+}
+
+/* Little-endian field writers, return the position after the field */
+static size_t putLong(byte* record, size_t position, unsigned long value)
+{
+  for(int i = 0; i < 4; i++)
+  {
+    record[position++] = (value >> (8 * i)) & 0xFF;
+  }
+  return position;
+}
+
+static size_t putFloat(byte* record, size_t position, float value)
+{
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return putLong(record, position, bits);
+}
+
+static size_t putText(byte* record, size_t position, const char* text)
+{
+  for(int i = 0; text != NULL && text[i] != 0x00 && i < TELEMETRY_MAX_TEXT; i++)
+  {
+    record[position++] = text[i];
+  }
+  record[position++] = 0x00;
+  return position;
+}
+
+/* Appends the CRC, encodes and terminates the frame */
+static size_t seal(byte* record, size_t length, byte* frame)
+{
+  unsigned short crc = crc16(record, length);
+  record[length++] = crc & 0xFF;
+  record[length++] = crc >> 8;
+
+  size_t encoded = cobsEncode(record, length, frame);
+  frame[encoded++] = 0x00;
+  return encoded;
+}
+
+size_t telemetrySampleFrame(byte* frame, unsigned char sensorId, unsigned char typeCode, unsigned long timestamp, float rawValue, float value)
+{
+  byte record[TELEMETRY_MAX_RECORD];
+  size_t length = 0;
+
+  record[length++] = TELEMETRY_SAMPLE;
+  record[length++] = sensorId;
+  record[length++] = typeCode;
+  length = putLong(record, length, timestamp);
+  length = putFloat(record, length, rawValue);
+  length = putFloat(record, length, value);
+
+  return seal(record, length, frame);
+}
+
+size_t telemetrySchemaFrame(byte* frame, unsigned char sensorId, unsigned char typeCode, unsigned char decimals, unsigned char labelWidth, const char* label, const char* measureUnit)
+{
+  byte record[TELEMETRY_MAX_RECORD];
+  size_t length = 0;
+
+  record[length++] = TELEMETRY_SCHEMA;
+  record[length++] = sensorId;
+  record[length++] = typeCode;
+  record[length++] = decimals;
+  record[length++] = labelWidth;
+  length = putText(record, length, label);
+  length = putText(record, length, measureUnit);
+
+  return seal(record, length, frame);
+}
@@ -0,0 +1,57 @@
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include "Arduino.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Compact binary telemetry frames.																											*/
+/*																																											*/
+/* A frame is a record followed by its CRC-16/CCITT (poly 0x1021, init 0xFFFF, sent			*/
+/* little-endian), COBS encoded and terminated by a 0x00 delimiter, so a receiver can		*/
+/* resynchronise on any zero byte. All multi-byte fields are little-endian.							*/
+/*																																											*/
+/* Sample record (15 bytes, 19 on the wire):																						*/
+/*   frame type (TELEMETRY_SAMPLE), sensor id, type code (HYGROMETER...),								*/
+/*   timestamp (millis(), uint32), raw value (float32), calibrated value (float32)				*/
+/*																																											*/
+/* Schema record, sent once per stream before the first sample of a sensor:							*/
+/*   frame type (TELEMETRY_SCHEMA), sensor id, type code, decimals, label width (the			*/
+/*   SENSOR_LABEL_WIDTH of the sender, which depends on the board), label (NUL					*/
+/*   terminated), measure unit (NUL terminated)																					*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define TELEMETRY_SAMPLE				0x01
+#define TELEMETRY_SCHEMA				0x02
+
+/* Type codes of the built-in sensors, sent in every frame */
+#define CUSTOM					0x00
+#define HYGROMETER 			0x01
+#define AIR_THERMOMETER 0x02
+#define CO_SENSOR				0x03
+#define NOX_SENSOR			0x04
+#define ETOH_SENSOR			0x05
+#define VOLUME_SENSOR		0x06
+#define LIGHT_SENSOR		0x07
+#define RED_LIGHT_SENSOR		0x08
+#define BLUE_LIGHT_SENSOR		0x09
+#define ULTRAVIOLET_LIGHT_SENSOR		0x0A
+#define ANALOGIC_THERMOMETER				0x0B
+#define SOIL_MOISTURE_METER					0x0C
+
+#define TELEMETRY_MAX_TEXT			32		// Longest label or measure unit in a schema, longer ones are truncated
+#define TELEMETRY_MAX_RECORD		(5 + 2 * (TELEMETRY_MAX_TEXT + 1) + 2)
+#define TELEMETRY_MAX_FRAME			(TELEMETRY_MAX_RECORD + TELEMETRY_MAX_RECORD / 254 + 2)
+
+/* crc16: CRC-16/CCITT-FALSE of data */
+unsigned short crc16(const byte* data, size_t length);
+
+/* cobsEncode: encodes length bytes of input in output, which needs length + length / 254 + 1 bytes. Returns the encoded length */
+size_t cobsEncode(const byte* input, size_t length, byte* output);
+
+/* Build a complete frame, delimiter included, in frame (TELEMETRY_MAX_FRAME bytes). Return its length */
+size_t telemetrySampleFrame(byte* frame, unsigned char sensorId, unsigned char typeCode, unsigned long timestamp, float rawValue, float value);
+size_t telemetrySchemaFrame(byte* frame, unsigned char sensorId, unsigned char typeCode, unsigned char decimals, unsigned char labelWidth, const char* label, const char* measureUnit);
+
+#endif
@@ -0,0 +1,74 @@
+#include <chrono>
+#include <stdio.h>
+#include "Calibration.h"
+#include "CalibrationTable.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Conversion cost of the calibration models, evaluated or looked up in a table.				*/
+/*																																											*/
+/* Each conversion takes the sum of 10 samples, as collectInput() does. The error column	*/
+/* is the largest difference between lookup and evaluation over all the codes.					*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define ITERATIONS 2000000
+#define NUM_READINGS 10
+
+static volatile float sink;
+
+template <typename Function>
+static double nanosPerCall(Function function, long iterations)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(long i = 0; i < iterations; i++)
+  {
+    function(i);
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+static void compare(const char* name, const Calibration& calibration)
+{
+  static int16_t entries[CALIBRATION_TABLE_CODES];
+  float scale;
+  float offset;
+  CalibrationTable::generate(calibration, entries, &scale, &offset);
+  CalibrationTable table(entries, scale, offset);
+
+  double maxError = 0;
+  for(long sum = 0; sum <= (long)(CALIBRATION_TABLE_CODES - 1) * NUM_READINGS; sum++)
+  {
+    double error = table.lookup(sum, NUM_READINGS) - calibration.evaluate((float)sum / NUM_READINGS);
+    error = error < 0 ? -error : error;
+    maxError = error > maxError ? error : maxError;
+  }
+
+  /* Sums spread over the whole range */
+  long span = (long)(CALIBRATION_TABLE_CODES - 1) * NUM_READINGS;
+  double evaluated = nanosPerCall([&](long i) { sink = calibration.evaluate((float)((i * 7919) % span) / NUM_READINGS); }, ITERATIONS);
+  double looked = nanosPerCall([&](long i) { sink = table.lookup((i * 7919) % span, NUM_READINGS); }, ITERATIONS);
+
+  printf("%-12s %14.1f %14.1f %12.6f\n", name, evaluated, looked, maxError);
+}
+
+int main()
+{
+  float raw[] = { 40, 150, 320, 480, 610, 790, 900, 1010 };
+  float reference[] = { 0, 80, 260, 500, 820, 1300, 1650, 2000 };
+
+  printf("%-12s %14s %14s %12s\n", "model", "evaluate ns", "lookup ns", "max error");
+  Calibration calibration;
+  calibration.fit(CALIBRATION_LINEAR, raw, reference, 8);
+  compare("linear", calibration);
+  calibration.fit(CALIBRATION_QUADRATIC, raw, reference, 8);
+  compare("quadratic", calibration);
+  calibration.fit(CALIBRATION_CUBIC, raw, reference, 8);
+  compare("cubic", calibration);
+  calibration.fit(CALIBRATION_PIECEWISE, raw, reference, 8);
+  compare("piecewise", calibration);
+  printf("table size: %u bytes\n", (unsigned int)(CALIBRATION_TABLE_CODES * sizeof(int16_t)));
+
+  return 0;
+}
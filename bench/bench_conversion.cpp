@@ -0,0 +1,123 @@
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "HostSim.h"
+#include "Sensor.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Accuracy and latency of the read path on recorded ADC traces.												*/
+/*																																											*/
+/* Built twice: bench_conversion against the float library, bench_conversion_fixed			*/
+/* against the SENSOR_FIXED_POINT one. Each trace of bench/traces is replayed through		*/
+/* collectInput(), and the readings are compared with the same average and conversion		*/
+/* done in double. Latencies are host nanoseconds: the host has a hardware FPU, so they	*/
+/* understate the gain of the fixed-point path on AVR, where floats are emulated.				*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define A0_PIN 14
+#define REPLAYS 200
+
+#ifdef SENSOR_FIXED_POINT
+	#define READ_PATH "fixed"
+#else
+	#define READ_PATH "float"
+#endif
+
+typedef struct trace_case {
+
+		const char* file;
+		short int sensorType;
+		float intercept;
+		float slope;
+
+	} trace_case;
+
+static volatile float sink;
+
+static bool loadTrace(const char* file, std::vector<int>& samples)
+{
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", SENSOR_TRACES_DIR, file);
+  FILE* input = fopen(path, "r");
+  if(input == NULL)
+  {
+    return false;
+  }
+  char line[256];
+  while(fgets(line, sizeof(line), input) != NULL)
+  {
+    if(line[0] != '#')
+    {
+      samples.push_back(atoi(line));
+    }
+  }
+  fclose(input);
+  return true;
+}
+
+int main()
+{
+  trace_case traces[] = {
+    { "soil_moisture.csv", SOIL_MOISTURE_METER, 19.655, -0.0273 },
+    { "light.csv", LIGHT_SENSOR, 0, 1 },
+    { "thermometer.csv", ANALOGIC_THERMOMETER, -50, 0.1221 }
+  };
+
+  printf("read path: %s\n", READ_PATH);
+  printf("%-20s %10s %12s %12s %12s\n", "trace", "readings", "max error", "mean error", "ns/reading");
+
+  for(size_t t = 0; t < sizeof(traces) / sizeof(traces[0]); t++)
+  {
+    std::vector<int> samples;
+    if(!loadTrace(traces[t].file, samples))
+    {
+      printf("%-20s missing\n", traces[t].file);
+      continue;
+    }
+
+    HostSim::reset();
+    Sensor sensor(A0_PIN, traces[t].sensorType, NULL);
+    float points[10] = { 0, 100 };
+    sensor.setValues(points, traces[t].intercept, traces[t].slope);
+    int numReadings = sensor.numReadings;
+    size_t readings = samples.size() / numReadings;
+
+    /* Accuracy, against double */
+    HostSim::scriptAnalog(A0_PIN, &samples[0], readings * numReadings);
+    double maxError = 0;
+    double sumError = 0;
+    for(size_t r = 0; r < readings; r++)
+    {
+      long sum = 0;
+      for(int i = 0; i < numReadings; i++)
+      {
+        sum += samples[r * numReadings + i];
+      }
+      double expected = (double)traces[t].slope * ((double)sum / numReadings) + traces[t].intercept;
+      double error = fabs(sensor.collectInput() - expected);
+      maxError = error > maxError ? error : maxError;
+      sumError += error;
+    }
+
+    /* Latency, over several replays of the trace */
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int replay = 0; replay < REPLAYS; replay++)
+    {
+      HostSim::scriptAnalog(A0_PIN, &samples[0], readings * numReadings);
+      for(size_t r = 0; r < readings; r++)
+      {
+        sink = sensor.collectInput();
+      }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double nanos = std::chrono::duration<double, std::nano>(end - start).count() / (REPLAYS * readings);
+
+    printf("%-20s %10u %12.6f %12.6f %12.1f\n", traces[t].file, (unsigned int)readings, maxError, sumError / readings, nanos);
+  }
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "HostSim.h"
+#include "Sensor.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Noise rejection of the filter stages against the conversions and time they cost.			*/
+/*																																											*/
+/* bench/traces/gas_sensor.csv gives each sample with the level it was drawn around, so	*/
+/* every reading is compared with the mean level of the samples it took. Readings are		*/
+/* of 9 samples. Latencies are host nanoseconds per reading, with a simulated ADC: on a	*/
+/* board the conversions dominate (about 112 us each on AVR).														*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define A0_PIN 14
+#define NUM_READINGS 9
+#define REPLAYS 20
+
+typedef struct filter_case {
+
+		const char* name;
+		sensor_filter filter;
+
+	} filter_case;
+
+static volatile float sink;
+
+static bool loadTrace(const char* file, std::vector<int>& samples, std::vector<double>& levels)
+{
+  char path[256];
+  snprintf(path, sizeof(path), "%s/%s", SENSOR_TRACES_DIR, file);
+  FILE* input = fopen(path, "r");
+  if(input == NULL)
+  {
+    return false;
+  }
+  char line[256];
+  while(fgets(line, sizeof(line), input) != NULL)
+  {
+    if(line[0] != '#')
+    {
+      samples.push_back(atoi(line));
+      const char* level = strchr(line, ',');
+      levels.push_back(level != NULL ? atof(level + 1) : samples.back());
+    }
+  }
+  fclose(input);
+  return true;
+}
+
+int main()
+{
+  std::vector<int> samples;
+  std::vector<double> levels;
+  if(!loadTrace("gas_sensor.csv", samples, levels))
+  {
+    printf("gas_sensor.csv missing\n");
+    return 1;
+  }
+
+  filter_case cases[] = {
+    { "mean", { FILTER_MEAN, 0, 0, 0 } },
+    { "median", { FILTER_MEDIAN, 0, 0, 0 } },
+    { "trimmed mean 2", { FILTER_TRIMMED_MEAN, 0, 2, 0 } },
+    { "hampel 3", { FILTER_HAMPEL, 0, 0, 3.0 } },
+    { "mean, 2 bits", { FILTER_MEAN, 2, 0, 0 } },
+    { "hampel 3, 2 bits", { FILTER_HAMPEL, 2, 0, 3.0 } }
+  };
+
+  printf("%-18s %10s %12s %12s %12s %12s\n", "filter", "readings", "conversions", "rms error", "max error", "ns/reading");
+  for(size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+  {
+    HostSim::reset();
+    sensor_params params = { 1, 0, 0, NUM_READINGS, 2, {0.0, 1023.0}, "Gas", "ppm", 1, &basicAnalogicReading, cases[c].filter };
+    Sensor sensor(A0_PIN, params, NULL);
+    size_t conversions = (size_t)NUM_READINGS << (2 * cases[c].filter.oversamplingBits);
+    size_t readings = samples.size() / conversions;
+
+    /* Accuracy, against the mean level of the samples of each reading */
+    double sumSquares = 0;
+    double maxError = 0;
+    for(size_t r = 0; r < readings; r++)
+    {
+      HostSim::scriptAnalog(A0_PIN, &samples[r * conversions], conversions);
+      double level = 0;
+      for(size_t i = 0; i < conversions; i++)
+      {
+        level += levels[r * conversions + i];
+      }
+      double error = fabs(sensor.collectInput() - level / conversions);
+      sumSquares += error * error;
+      maxError = error > maxError ? error : maxError;
+    }
+
+    /* Latency, over several replays of the trace, scripted by as many readings as the simulator holds */
+    size_t chunk = HOST_MAX_SCRIPT / conversions;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int replay = 0; replay < REPLAYS; replay++)
+    {
+      for(size_t r = 0; r < readings; r++)
+      {
+        if(r % chunk == 0)
+        {
+          size_t count = readings - r < chunk ? readings - r : chunk;
+          HostSim::scriptAnalog(A0_PIN, &samples[r * conversions], count * conversions);
+        }
+        sink = sensor.collectInput();
+      }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double nanos = std::chrono::duration<double, std::nano>(end - start).count() / (REPLAYS * readings);
+
+    printf("%-18s %10u %12u %12.3f %12.3f %12.1f\n", cases[c].name, (unsigned int)readings, (unsigned int)conversions,
+      sqrt(sumSquares / readings), maxError, nanos);
+  }
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <chrono>
+#include <stdio.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "HostSim.h"
+#include "Sensor.h"
+#include "SensorFormat.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Cost of formatting one reading.																											*/
+/*																																											*/
+/* "legacy" reproduces the formatting formattedReading() did before the FormatBuffer		*/
+/* path: sprintf with dtostrf into an 8-byte buffer, then a String copy. Readings are		*/
+/* formatted from a fixed value, so only formatting is measured.												*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define ITERATIONS 1000000
+
+static volatile size_t sink;
+
+static unsigned long long cycles()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static String legacyFormattedReading(const char* label, float val, const char* mu)
+{
+  char message[50];
+  for(int i = 0; i < 50; i++)
+  {
+    message[i] = 0x00;
+  }
+  /* Values stay below 10000 here: above, dtostrf overflows str_val */
+  char str_val[8];
+  dtostrf(val, 4, 3, str_val);
+  sprintf(message,"%-7s: %s%s",label,str_val,mu);
+  return (String)message;
+}
+
+template <typename Function>
+static void measure(const char* name, Function function)
+{
+  unsigned long allocations = HostSim::stringAllocations();
+  unsigned long long startCycles = cycles();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(long i = 0; i < ITERATIONS; i++)
+  {
+    function(i);
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  unsigned long long endCycles = cycles();
+
+  printf("%-28s %8.1f ns %8.1f cycles %6.2f String allocations per reading\n", name,
+    std::chrono::duration<double, std::nano>(end - start).count() / ITERATIONS,
+    (double)(endCycles - startCycles) / ITERATIONS,
+    (double)(HostSim::stringAllocations() - allocations) / ITERATIONS);
+}
+
+int main()
+{
+  HostSim::reset();
+  Sensor soil(14, SOIL_MOISTURE_METER, "Soil");
+  char buffer[SENSOR_MESSAGE_SIZE];
+
+  measure("legacy sprintf + String", [&](long i) { sink = legacyFormattedReading("Soil", 16.652 + (i & 7), "%").length(); });
+  measure("formattedReading -> String", [&](long i) { sink = soil.formattedReading(16.652 + (i & 7)).length(); });
+  measure("formattedReading -> buffer", [&](long i) { sink = soil.formattedReading(buffer, sizeof(buffer), 16.652 + (i & 7)); });
+
+  return 0;
+}
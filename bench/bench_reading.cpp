@@ -0,0 +1,53 @@
+#include <chrono>
+#include <stdio.h>
+#include "HostSim.h"
+#include "Sensor.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Per-reading cost of the hot path on the host.																				*/
+/*																																											*/
+/* Wall-clock nanoseconds per call, averaged over many iterations. Absolute numbers are	*/
+/* only meaningful against a previous run on the same machine.													*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define ITERATIONS 200000
+
+static volatile float sink;
+
+template <typename Function>
+static double nanosPerCall(Function function, long iterations)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for(long i = 0; i < iterations; i++)
+  {
+    function();
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+static void report(const char* name, double nanos)
+{
+  printf("%-32s %10.1f ns/call\n", name, nanos);
+}
+
+int main()
+{
+  HostSim::reset();
+  HostSim::setAnalog(14, 512);
+  HostSim::setDht(2, 22.0, 40.0);
+  HostSim::setDhtMinInterval(0);
+
+  Sensor analog(14, SOIL_MOISTURE_METER, "Soil");
+  Sensor hygrometer(2, HYGROMETER, "Hum");
+
+  report("collectRawInput (analog)", nanosPerCall([&]() { sink = analog.collectRawInput(); }, ITERATIONS));
+  report("collectInput (analog)", nanosPerCall([&]() { sink = analog.collectInput(); }, ITERATIONS));
+  report("convertInputLinear", nanosPerCall([&]() { sink = analog.convertInputLinear(512); }, ITERATIONS * 10));
+  report("formattedReading (analog)", nanosPerCall([&]() { sink = analog.formattedReading().length(); }, ITERATIONS));
+  report("collectInput (DHT)", nanosPerCall([&]() { sink = hygrometer.collectInput(); }, ITERATIONS));
+
+  return 0;
+}
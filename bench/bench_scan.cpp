@@ -0,0 +1,85 @@
+#include <chrono>
+#include <stdio.h>
+#include "HostSim.h"
+#include "Sensor.h"
+#include "AnalogScanner.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* One reading of 8 analogic sensors: one by one with collectInput(), or with a scan.		*/
+/*																																											*/
+/* Conversions are simulated at 112 us, as on a 16 MHz AVR, so the simulated time of a	*/
+/* cycle is what a board would spend in the ADC. The skew is the time between the mean	*/
+/* sample times of the first and the last sensor: how far apart their readings are.			*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define SENSORS 8
+#define CONVERSION_MICROS 112
+#define CYCLES 20000
+
+static void report(const char* name, unsigned long pinModes, unsigned long simulated, double skew, double nanos)
+{
+  printf("%-12s %10lu %14lu %12.0f %12.1f\n", name, pinModes, simulated, skew, nanos);
+}
+
+int main()
+{
+  HostSim::reset();
+  Sensor* sensors[SENSORS];
+  AnalogScanner scanner;
+  for(int i = 0; i < SENSORS; i++)
+  {
+    HostSim::setAnalog(14 + i, 100 * i);
+    sensors[i] = new Sensor(14 + i, LIGHT_SENSOR, NULL);
+    scanner.add(sensors[i]);
+  }
+  int numReadings = sensors[0]->numReadings;
+
+  printf("%-12s %10s %14s %12s %12s\n", "cycle", "pinMode", "simulated us", "skew us", "host ns");
+
+  /* Simulated cost of one cycle */
+  HostSim::setAnalogReadMicros(CONVERSION_MICROS);
+  unsigned long pinModes = HostSim::pinModeCalls();
+  unsigned long start = micros();
+  for(int i = 0; i < SENSORS; i++)
+  {
+    sensors[i]->collectInput();
+  }
+  unsigned long sequential = micros() - start;
+  unsigned long sequentialPinModes = HostSim::pinModeCalls() - pinModes;
+
+  pinModes = HostSim::pinModeCalls();
+  start = micros();
+  scanner.scan();
+  unsigned long scanned = micros() - start;
+  unsigned long scannedPinModes = HostSim::pinModeCalls() - pinModes;
+  HostSim::setAnalogReadMicros(0);
+
+  /* Host time per cycle */
+  std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+  for(int c = 0; c < CYCLES; c++)
+  {
+    for(int i = 0; i < SENSORS; i++)
+    {
+      sensors[i]->collectInput();
+    }
+  }
+  double sequentialNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / CYCLES;
+  begin = std::chrono::steady_clock::now();
+  for(int c = 0; c < CYCLES; c++)
+  {
+    scanner.scan();
+  }
+  double scannedNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / CYCLES;
+
+  /* Sensor i takes its samples numReadings conversions after sensor i - 1 when read one by one, one conversion after when scanned */
+  report("sequential", sequentialPinModes, sequential, (double)(SENSORS - 1) * numReadings * CONVERSION_MICROS, sequentialNanos);
+  report("scan", scannedPinModes, scanned, (double)(SENSORS - 1) * CONVERSION_MICROS, scannedNanos);
+
+  for(int i = 0; i < SENSORS; i++)
+  {
+    delete sensors[i];
+  }
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include "HostSim.h"
+#include "Sensor.h"
+#include "StreamRegistry.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* RAM used by the I/O streams of a node of 16 sensors, each printing on 4 channels.		*/
+/*																																											*/
+/* Before StreamRegistry every sensor kept MAX_IO_STREAMS channel pointers and every		*/
+/* streamAdd() allocated its own InteractionChannel on the heap, never freed. Now a			*/
+/* sensor keeps one byte handles and the channels live once in the registry pool.				*/
+/*																																											*/
+/* Host sizes come from sizeof. AVR sizes assume 2 byte pointers, an InteractionChannel	*/
+/* of 5 pointers, and the 2 byte header avr-libc malloc puts before every block.				*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#define SENSORS 16
+#define CHANNELS 4
+
+#define AVR_POINTER 2
+#define AVR_CHANNEL (5 * AVR_POINTER)
+#define AVR_MALLOC_HEADER 2
+#define AVR_SHARED_CHANNEL (2 + 5 * AVR_POINTER + AVR_CHANNEL)
+#define AVR_STREAM_BATCH (64 + 4)		// STREAM_BATCH_SIZE on AVR, its length, handle and depth
+
+static void report(const char* target, unsigned long before, unsigned long after)
+{
+  printf("%-6s %10lu %10lu %10lu\n", target, before, after, before - after);
+}
+
+int main()
+{
+  HostSim::reset();
+  HostStream ports[CHANNELS];
+
+  /* The node itself, to check the channels are shared */
+  {
+    Sensor* sensors[SENSORS];
+    for(int i = 0; i < SENSORS; i++)
+    {
+      sensors[i] = new Sensor(14, LIGHT_SENSOR, NULL);
+      for(int j = 0; j < CHANNELS; j++)
+      {
+        sensors[i]->streamAdd(ports[j]);
+      }
+    }
+    printf("%d sensors x %d streams: %d channels in the registry, %d users each\n",
+      SENSORS, CHANNELS, StreamRegistry::channelsInUse(), StreamRegistry::users(0));
+    for(int i = 0; i < SENSORS; i++)
+    {
+      delete sensors[i];
+    }
+  }
+
+  unsigned long hostBefore = SENSORS * MAX_IO_STREAMS * sizeof(InteractionChannel*)
+    + SENSORS * CHANNELS * sizeof(InteractionChannel);
+  unsigned long hostAfter = SENSORS * MAX_IO_STREAMS * sizeof(signed char)
+    + MAX_SHARED_STREAMS * sizeof(shared_channel) + STREAM_BATCH_SIZE + 4;
+  unsigned long avrBefore = SENSORS * MAX_IO_STREAMS * AVR_POINTER
+    + SENSORS * CHANNELS * (AVR_CHANNEL + AVR_MALLOC_HEADER);
+  unsigned long avrAfter = SENSORS * MAX_IO_STREAMS + MAX_SHARED_STREAMS * AVR_SHARED_CHANNEL + AVR_STREAM_BATCH;
+
+  printf("%-6s %10s %10s %10s\n", "target", "before", "after", "saved");
+  report("host", hostBefore, hostAfter);
+  report("avr", avrBefore, avrAfter);
+  printf("host heap allocator overhead not counted\n");
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Host (Linux) stand-in for the Arduino core.																					*/
+/*																																											*/
+/* Only the subset of the core used by the library is provided. Pins, ADC, clock and		*/
+/* DHT devices are simulated and can be scripted from tests through HostSim.h.					*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH					0x1
+#define LOW						0x0
+
+#define INPUT					0x0
+#define OUTPUT				0x1
+#define INPUT_PULLUP	0x2
+
+#define CHANGE				1
+#define FALLING				2
+#define RISING				3
+
+#define DEC						10
+#define HEX						16
+
+/* There is no separate program memory on the host: flash helpers are plain accesses */
+#define PROGMEM
+#define PSTR(s)										(s)
+#define pgm_read_byte(addr)				(*(const uint8_t*)(addr))
+#define pgm_read_word(addr)				(*(const uint16_t*)(addr))
+#define pgm_read_dword(addr)			(*(const uint32_t*)(addr))
+#define pgm_read_float(addr)			(*(const float*)(addr))
+#define pgm_read_ptr(addr)				(*(void* const*)(addr))
+#define memcpy_P(dest, src, n)		memcpy((dest), (src), (n))
+#define strlen_P(s)								strlen(s)
+
+class __FlashStringHelper;
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper*>(string_literal))
+
+/* Digital and analog I/O */
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReadResolution(int bits);
+void analogWriteResolution(int bits);
+
+/* Time. The clock is simulated: delay() advances it instead of sleeping */
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+/* Interrupts have no effect on the host, there is a single thread of execution */
+void noInterrupts();
+void interrupts();
+
+/* External interrupts: every pin has one, numbered as the pin. Handlers run on the simulated	*/
+/* clock, from the edges of the fake DHT11 devices																						*/
+#define NOT_AN_INTERRUPT					-1
+#define digitalPinToInterrupt(p)	((p) >= 0 && (p) < 70 ? (p) : NOT_AN_INTERRUPT)
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+
+/* Host only: the timer-triggered ADC of continuous sampling (see ContinuousAdc.h). Every periodMicros	*/
+/* of simulated time the selected pin is converted, and handler gets the result as from the interrupt	*/
+#define ARDUINO_HOST
+bool hostAdcStart(void (*handler)(uint16_t value), unsigned long periodMicros);
+void hostAdcSelect(uint8_t pin);
+void hostAdcStop();
+
+/* avr-libc float formatting */
+char* dtostrf(double value, signed char width, unsigned char precision, char* buffer);
+
+#include "WString.h"
+#include "Stream.h"
+
+/* Serial port, writes to the standard output and never has input */
+class HardwareSerial : public Stream
+{
+	public:
+		void begin(unsigned long baud) { }
+		size_t write(uint8_t c);
+		int available() { return 0; }
+		int read() { return -1; }
+		int peek() { return -1; }
+		using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
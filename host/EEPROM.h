@@ -0,0 +1,22 @@
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include "Arduino.h"
+
+#define HOST_EEPROM_SIZE		1024		// As an ATmega328P
+
+/* Host stand-in for the AVR EEPROM library. Erased cells read 0xFF. The contents live in	*/
+/* memory, or in a file given to HostSim::setEepromFile(), which keeps them across runs.	*/
+class EEPROMClass
+{
+	public:
+		uint8_t read(int address);
+		void write(int address, uint8_t value);
+		/* update: writes only if the value changes, sparing the cell */
+		void update(int address, uint8_t value);
+		uint16_t length() { return HOST_EEPROM_SIZE; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,643 @@
+#include "Arduino.h"
+#include "HostSim.h"
+#include "SimpleDHT.h"
+#include "EEPROM.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Simulated board state																																*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct host_pin {
+
+		int mode;
+		int level;
+		int analogValue;
+		int script[HOST_MAX_SCRIPT];
+		unsigned int scriptLength;
+		unsigned int scriptPosition;
+		unsigned long analogReads;
+
+		bool dhtPresent;
+		float dhtTemperature;
+		float dhtHumidity;
+		int dhtError;
+		unsigned int dhtFailures;
+		bool dhtPolled;
+		unsigned long dhtLastTransaction;
+		unsigned long dhtTransactions;
+		bool dhtHeldLow;								// Driven low as an output: a start pulse
+		unsigned long dhtHeldLowSince;
+
+		void (*handler)();							// Attached interrupt handler
+		int handlerMode;
+		bool edgeLatched;								// Interrupt flag raised while no handler was attached
+
+	} host_pin;
+
+static host_pin pins[HOST_MAX_PINS];
+static unsigned long clockMicros = 0;
+static unsigned long analogReadMicros = 0;
+static unsigned long dhtTransactionMillis = 0;
+static unsigned long dhtMinInterval = 1000;
+static unsigned long totalAnalogReads = 0;
+static unsigned long totalPinModes = 0;
+static void (*adcHandler)(uint16_t value) = NULL;
+static unsigned long adcPeriod = 0;
+static unsigned long adcNext = 0;
+static uint8_t adcPin = 0;
+static unsigned long totalAdcInterrupts = 0;
+static short int dhtFramePin = -1;
+static unsigned long dhtFrameEdges[HOST_DHT_EDGES];
+static unsigned int dhtFrameLength = 0;
+static unsigned int dhtFramePosition = 0;
+static bool inInterrupt = false;
+static uint8_t eeprom[HOST_EEPROM_SIZE];
+static unsigned long eepromCellWrites[HOST_EEPROM_SIZE];
+static FILE* eepromFile = NULL;
+unsigned long hostStringAllocations = 0;
+
+HardwareSerial Serial;
+EEPROMClass EEPROM;
+
+static host_pin* hostPin(int pin)
+{
+  if(pin < 0 || pin >= HOST_MAX_PINS)
+  {
+    return NULL;
+  }
+  return &pins[pin];
+}
+
+/* Next value of the pin: its script, then its level */
+static int convert(host_pin* p)
+{
+  if(p->scriptPosition < p->scriptLength)
+  {
+    p->analogValue = p->script[p->scriptPosition++];
+  }
+  return p->analogValue;
+}
+
+/* Moves the clock, running the interrupts of the conversions of the free-running ADC and of	*/
+/* the DHT edges that happen meanwhile, in order																							*/
+static void advanceClock(unsigned long us)
+{
+  unsigned long target = clockMicros + us;
+  while(!inInterrupt)
+  {
+    bool conversion = adcHandler != NULL && (long)(target - adcNext) >= 0;
+    bool edge = dhtFramePosition < dhtFrameLength && (long)(target - dhtFrameEdges[dhtFramePosition]) >= 0;
+    if(!conversion && !edge)
+    {
+      break;
+    }
+
+    inInterrupt = true;
+    if(edge && (!conversion || (long)(adcNext - dhtFrameEdges[dhtFramePosition]) > 0))
+    {
+      /* Only falling edges are simulated */
+      clockMicros = dhtFrameEdges[dhtFramePosition++];
+      host_pin* p = hostPin(dhtFramePin);
+      if(p->handler != NULL && (p->handlerMode == FALLING || p->handlerMode == CHANGE))
+      {
+        p->handler();
+      }
+    } else {
+      clockMicros = adcNext;
+      adcNext += adcPeriod;
+      totalAdcInterrupts++;
+      host_pin* p = hostPin(adcPin);
+      adcHandler(p != NULL ? convert(p) : 0);
+    }
+    inInterrupt = false;
+  }
+  clockMicros = target;
+}
+
+/* Outcome of a transaction with the fake DHT11 of a pin, as a SimpleDHT error */
+static int dhtTransaction(host_pin* p)
+{
+  unsigned long now = millis();
+  p->dhtTransactions++;
+
+  if(!p->dhtPresent)
+  {
+    return SimpleDHTErrStartLow;
+  }
+  if(p->dhtFailures > 0)
+  {
+    p->dhtFailures--;
+    return p->dhtError;
+  }
+  if(p->dhtPolled && now - p->dhtLastTransaction < dhtMinInterval)
+  {
+    /* The sensor has not recovered from the previous transaction yet */
+    return SimpleDHTErrStartHigh;
+  }
+  p->dhtPolled = true;
+  p->dhtLastTransaction = now;
+  return SimpleDHTErrSuccess;
+}
+
+/* 40 bits, MSB first: humidity, 0, temperature, 0, checksum */
+static void dhtFrame(host_pin* p, byte bytes[5])
+{
+  bytes[0] = (byte)p->dhtHumidity;
+  bytes[1] = 0;
+  bytes[2] = (byte)p->dhtTemperature;
+  bytes[3] = 0;
+  bytes[4] = bytes[0] + bytes[1] + bytes[2] + bytes[3];
+}
+
+/* End of a start pulse: the device answers with its frame, as timed falling edges */
+static void dhtRelease(short int pin, host_pin* p)
+{
+  p->dhtHeldLow = false;
+  if(clockMicros - p->dhtHeldLowSince < HOST_DHT_START_MICROS)
+  {
+    return;
+  }
+
+  int error = dhtTransaction(p);
+  if(error == SimpleDHTErrStartLow || error == SimpleDHTErrStartHigh)
+  {
+    return;
+  }
+
+  byte bytes[5];
+  dhtFrame(p, bytes);
+  if(error == SimpleDHTErrDataChecksum)
+  {
+    bytes[4]++;
+  }
+
+  /* Answer after 30 us: 80 us low, 80 us high, then per bit 50 us low and 27 or 70 us high */
+  unsigned long t = clockMicros + 30;
+  dhtFrameEdges[0] = t;
+  t += 160;
+  dhtFrameEdges[1] = t;
+  for(int i = 0; i < 40; i++)
+  {
+    t += (bytes[i / 8] >> (7 - i % 8)) & 0x01 ? 120 : 77;
+    dhtFrameEdges[i + 2] = t;
+  }
+
+  /* Other errors cut the frame in the middle */
+  dhtFramePin = pin;
+  dhtFramePosition = 0;
+  dhtFrameLength = error == SimpleDHTErrSuccess || error == SimpleDHTErrDataChecksum ? HOST_DHT_EDGES : HOST_DHT_EDGES / 2;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Arduino core																																					*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  host_pin* p = hostPin(pin);
+  totalPinModes++;
+  if(p != NULL)
+  {
+    p->mode = mode;
+    if(mode != OUTPUT && p->dhtHeldLow)
+    {
+      dhtRelease(pin, p);
+    }
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  host_pin* p = hostPin(pin);
+  if(p != NULL)
+  {
+    p->level = value ? HIGH : LOW;
+    if(p->mode == OUTPUT && p->level == LOW && !p->dhtHeldLow)
+    {
+      p->dhtHeldLow = true;
+      p->dhtHeldLowSince = clockMicros;
+    } else if(p->level == HIGH && p->dhtHeldLow) {
+      dhtRelease(pin, p);
+    }
+  }
+}
+
+int digitalRead(uint8_t pin)
+{
+  host_pin* p = hostPin(pin);
+  return p != NULL ? p->level : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+  host_pin* p = hostPin(pin);
+  advanceClock(analogReadMicros);
+  totalAnalogReads++;
+  if(p == NULL)
+  {
+    return 0;
+  }
+
+  p->analogReads++;
+  return convert(p);
+}
+
+void analogReadResolution(int bits)
+{
+}
+
+void analogWriteResolution(int bits)
+{
+}
+
+unsigned long millis()
+{
+  return clockMicros / 1000;
+}
+
+unsigned long micros()
+{
+  return clockMicros;
+}
+
+void delay(unsigned long ms)
+{
+  advanceClock(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  advanceClock(us);
+}
+
+void noInterrupts()
+{
+}
+
+void interrupts()
+{
+}
+
+bool hostAdcStart(void (*handler)(uint16_t value), unsigned long periodMicros)
+{
+  if(handler == NULL || periodMicros == 0)
+  {
+    return false;
+  }
+  adcHandler = handler;
+  adcPeriod = periodMicros;
+  adcNext = clockMicros + periodMicros;
+  return true;
+}
+
+void hostAdcSelect(uint8_t pin)
+{
+  adcPin = pin;
+}
+
+void hostAdcStop()
+{
+  adcHandler = NULL;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode)
+{
+  host_pin* p = hostPin(interrupt);
+  if(p != NULL)
+  {
+    p->handler = handler;
+    p->handlerMode = mode;
+  }
+
+  /* As AVR: a flag raised before attaching runs the handler at once */
+  if(p != NULL && p->edgeLatched && !inInterrupt && (mode == FALLING || mode == CHANGE))
+  {
+    p->edgeLatched = false;
+    inInterrupt = true;
+    handler();
+    inInterrupt = false;
+  }
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+  host_pin* p = hostPin(interrupt);
+  if(p != NULL)
+  {
+    p->handler = NULL;
+  }
+}
+
+char* dtostrf(double value, signed char width, unsigned char precision, char* buffer)
+{
+  /* Like avr-libc, the result is not bounded: the caller must provide enough room */
+  sprintf(buffer, "%*.*f", width, precision, value);
+  return buffer;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Fake DHT11																																						*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+int SimpleDHT::read(byte* ptemperature, byte* phumidity, byte pdata[40])
+{
+  float temperature = 0;
+  float humidity = 0;
+  int err = this->read2(&temperature, &humidity, pdata);
+  if(err == SimpleDHTErrSuccess)
+  {
+    if(ptemperature != NULL)
+    {
+      *ptemperature = (byte)temperature;
+    }
+    if(phumidity != NULL)
+    {
+      *phumidity = (byte)humidity;
+    }
+  }
+  return err;
+}
+
+int SimpleDHT::read2(float* ptemperature, float* phumidity, byte pdata[40])
+{
+  host_pin* p = hostPin(this->pin);
+  if(p == NULL)
+  {
+    return SimpleDHTErrNoPin;
+  }
+
+  /* Every transaction blocks the caller, whatever its outcome */
+  int error = dhtTransaction(p);
+  advanceClock(dhtTransactionMillis * 1000);
+  if(error != SimpleDHTErrSuccess)
+  {
+    return error;
+  }
+
+  if(ptemperature != NULL)
+  {
+    *ptemperature = p->dhtTemperature;
+  }
+  if(phumidity != NULL)
+  {
+    *phumidity = p->dhtHumidity;
+  }
+  if(pdata != NULL)
+  {
+    byte bytes[5];
+    dhtFrame(p, bytes);
+    for(int i = 0; i < 40; i++)
+    {
+      pdata[i] = (bytes[i / 8] >> (7 - i % 8)) & 0x01;
+    }
+  }
+  return SimpleDHTErrSuccess;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* EEPROM																																								*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+uint8_t EEPROMClass::read(int address)
+{
+  return address >= 0 && address < HOST_EEPROM_SIZE ? eeprom[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+  if(address < 0 || address >= HOST_EEPROM_SIZE)
+  {
+    return;
+  }
+
+  eeprom[address] = value;
+  eepromCellWrites[address]++;
+  if(eepromFile != NULL)
+  {
+    fseek(eepromFile, address, SEEK_SET);
+    fputc(value, eepromFile);
+    fflush(eepromFile);
+  }
+}
+
+void EEPROMClass::update(int address, uint8_t value)
+{
+  if(this->read(address) != value)
+  {
+    this->write(address, value);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Simulation control																																		*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void HostSim::reset()
+{
+  memset(pins, 0, sizeof(pins));
+  clockMicros = 0;
+  analogReadMicros = 0;
+  dhtTransactionMillis = 0;
+  dhtMinInterval = 1000;
+  totalAnalogReads = 0;
+  totalPinModes = 0;
+  adcHandler = NULL;
+  adcPeriod = 0;
+  adcPin = 0;
+  totalAdcInterrupts = 0;
+  dhtFramePin = -1;
+  dhtFrameLength = 0;
+  dhtFramePosition = 0;
+  inInterrupt = false;
+  HostSim::setEepromFile(NULL);
+  hostStringAllocations = 0;
+}
+
+void HostSim::advanceMillis(unsigned long ms)
+{
+  advanceClock(ms * 1000);
+}
+
+void HostSim::advanceMicros(unsigned long us)
+{
+  advanceClock(us);
+}
+
+void HostSim::setAnalogReadMicros(unsigned long us)
+{
+  analogReadMicros = us;
+}
+
+void HostSim::setAnalog(short int pin, int value)
+{
+  host_pin* p = hostPin(pin);
+  if(p != NULL)
+  {
+    p->analogValue = value;
+    p->scriptLength = 0;
+    p->scriptPosition = 0;
+  }
+}
+
+void HostSim::scriptAnalog(short int pin, const int* values, unsigned int count)
+{
+  host_pin* p = hostPin(pin);
+  if(p == NULL)
+  {
+    return;
+  }
+  if(count > HOST_MAX_SCRIPT)
+  {
+    count = HOST_MAX_SCRIPT;
+  }
+  memcpy(p->script, values, count * sizeof(int));
+  p->scriptLength = count;
+  p->scriptPosition = 0;
+}
+
+unsigned int HostSim::scriptRemaining(short int pin)
+{
+  host_pin* p = hostPin(pin);
+  return p != NULL ? p->scriptLength - p->scriptPosition : 0;
+}
+
+void HostSim::setDigital(short int pin, int value)
+{
+  digitalWrite(pin, value);
+}
+
+int HostSim::pinModeOf(short int pin)
+{
+  host_pin* p = hostPin(pin);
+  return p != NULL ? p->mode : -1;
+}
+
+int HostSim::digitalLevel(short int pin)
+{
+  return digitalRead(pin);
+}
+
+void HostSim::setDht(short int pin, float temperature, float humidity)
+{
+  host_pin* p = hostPin(pin);
+  if(p != NULL)
+  {
+    p->dhtPresent = true;
+    p->dhtTemperature = temperature;
+    p->dhtHumidity = humidity;
+  }
+}
+
+void HostSim::failDht(short int pin, int error, unsigned int count)
+{
+  host_pin* p = hostPin(pin);
+  if(p != NULL)
+  {
+    p->dhtError = error;
+    p->dhtFailures = count;
+  }
+}
+
+void HostSim::setDhtTransactionMillis(unsigned long ms)
+{
+  dhtTransactionMillis = ms;
+}
+
+void HostSim::setDhtMinInterval(unsigned long ms)
+{
+  dhtMinInterval = ms;
+}
+
+void HostSim::latchEdge(short int pin)
+{
+  host_pin* p = hostPin(pin);
+  if(p != NULL)
+  {
+    p->edgeLatched = true;
+  }
+}
+
+unsigned long HostSim::dhtTransactions(short int pin)
+{
+  host_pin* p = hostPin(pin);
+  return p != NULL ? p->dhtTransactions : 0;
+}
+
+void HostSim::setEepromFile(const char* path)
+{
+  if(eepromFile != NULL)
+  {
+    fclose(eepromFile);
+    eepromFile = NULL;
+  }
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  memset(eepromCellWrites, 0, sizeof(eepromCellWrites));
+  if(path == NULL)
+  {
+    return;
+  }
+
+  /* The cells the file doesn't have yet are erased, and written to it */
+  eepromFile = fopen(path, "r+b");
+  if(eepromFile == NULL)
+  {
+    eepromFile = fopen(path, "w+b");
+  }
+  if(eepromFile == NULL)
+  {
+    return;
+  }
+  size_t stored = fread(eeprom, 1, sizeof(eeprom), eepromFile);
+  if(stored < sizeof(eeprom))
+  {
+    fseek(eepromFile, stored, SEEK_SET);
+    fwrite(eeprom + stored, 1, sizeof(eeprom) - stored, eepromFile);
+    fflush(eepromFile);
+  }
+}
+
+unsigned long HostSim::eepromWrites(int address)
+{
+  return address >= 0 && address < HOST_EEPROM_SIZE ? eepromCellWrites[address] : 0;
+}
+
+unsigned long HostSim::analogReads()
+{
+  return totalAnalogReads;
+}
+
+unsigned long HostSim::analogReads(short int pin)
+{
+  host_pin* p = hostPin(pin);
+  return p != NULL ? p->analogReads : 0;
+}
+
+unsigned long HostSim::pinModeCalls()
+{
+  return totalPinModes;
+}
+
+unsigned long HostSim::adcInterrupts()
+{
+  return totalAdcInterrupts;
+}
+
+unsigned long HostSim::stringAllocations()
+{
+  return hostStringAllocations;
+}
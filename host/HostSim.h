@@ -0,0 +1,104 @@
+#ifndef HostSim_h
+#define HostSim_h
+
+#include <string>
+#include "Arduino.h"
+
+#define HOST_MAX_PINS				70
+#define HOST_MAX_SCRIPT			4096
+#define HOST_DHT_START_MICROS	18000		// Shortest start pulse a fake DHT11 answers
+#define HOST_DHT_EDGES				42			// Falling edges of a DHT11 frame
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Simulation control for the host backend.																							*/
+/*																																											*/
+/* Tests and benchmarks use it to drive the simulated board: analog and digital pin			*/
+/* levels, scripted ADC traces, the clock and the fake DHT11 devices. The free-running	*/
+/* ADC started by hostAdcStart() converts as the simulated clock moves forward.					*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class HostSim
+{
+	public:
+		/* Restore the power-on state: clock at zero, all pins low, no DHT devices, counters cleared */
+		static void reset();
+
+		/* Clock */
+		static void advanceMillis(unsigned long ms);
+		static void advanceMicros(unsigned long us);
+		/* Simulated time spent by every analogRead() conversion, 0 by default */
+		static void setAnalogReadMicros(unsigned long us);
+
+		/* Analog pins: a fixed level, or a script of values consumed one per analogRead() */
+		static void setAnalog(short int pin, int value);
+		static void scriptAnalog(short int pin, const int* values, unsigned int count);
+		static unsigned int scriptRemaining(short int pin);
+
+		/* Digital pins */
+		static void setDigital(short int pin, int value);
+		static int pinModeOf(short int pin);
+		static int digitalLevel(short int pin);
+
+		/* Fake DHT11 on a pin: values returned by the next transactions, from read2() or as the falling edges	*/
+		/* of a frame once the pin is released after a start pulse of HOST_DHT_START_MICROS									*/
+		static void setDht(short int pin, float temperature, float humidity);
+		/* Make the next count transactions fail with the given SimpleDHT error */
+		static void failDht(short int pin, int error, unsigned int count);
+		/* Simulated duration of one DHT transaction, 0 by default */
+		static void setDhtTransactionMillis(unsigned long ms);
+		/* Like the real part, a DHT11 polled again within this interval fails. 1000 ms by default */
+		static void setDhtMinInterval(unsigned long ms);
+		static unsigned long dhtTransactions(short int pin);
+		/* Raise the interrupt flag of the pin, as the start pulse does on AVR: the next attachInterrupt() runs its	*/
+		/* handler at once																																												*/
+		static void latchEdge(short int pin);
+
+		/* EEPROM: erased and in memory after reset(). With a file, its contents are loaded from it, and every	*/
+		/* write goes through to it, as across power cycles. NULL goes back to memory, erased										*/
+		static void setEepromFile(const char* path);
+		/* Writes of a cell, since the EEPROM was erased or its file set */
+		static unsigned long eepromWrites(int address);
+
+		/* Counters */
+		static unsigned long analogReads();
+		static unsigned long analogReads(short int pin);
+		static unsigned long pinModeCalls();
+		/* Conversions of the free-running ADC, which are not analogRead() calls */
+		static unsigned long adcInterrupts();
+		static unsigned long stringAllocations();
+};
+
+/* A Stream backed by memory: input is fed by tests, output is recorded */
+class HostStream : public Stream
+{
+	public:
+		HostStream() : _readPosition(0), _writes(0), _txRoom(0) { }
+
+		size_t write(uint8_t c) { this->_output += (char)c; this->_writes++; return 1; }
+		size_t write(const uint8_t* buffer, size_t size) { this->_output.append((const char*)buffer, size); this->_writes++; return size; }
+		using Print::write;
+		int availableForWrite() { return this->_txRoom; }
+
+		int available() { return this->_input.length() - this->_readPosition; }
+		int read() { return this->available() > 0 ? (unsigned char)this->_input[this->_readPosition++] : -1; }
+		int peek() { return this->available() > 0 ? (unsigned char)this->_input[this->_readPosition] : -1; }
+
+		void feed(const char* input) { this->_input += input; }
+		const std::string& output() const { return this->_output; }
+		void clearOutput() { this->_output.clear(); }
+		/* Calls to write(), single bytes or buffers */
+		unsigned long writes() const { return this->_writes; }
+		/* Free TX room reported by availableForWrite(), 0 as SoftwareSerial by default */
+		void setTxRoom(int room) { this->_txRoom = room; }
+
+	private:
+		std::string _input;
+		std::string _output;
+		size_t _readPosition;
+		unsigned long _writes;
+		int _txRoom;
+};
+
+#endif
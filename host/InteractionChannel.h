@@ -0,0 +1,145 @@
+#ifndef InteractionChannel_h
+#define InteractionChannel_h
+
+#include "Arduino.h"
+#include "Keypad.h"
+#include "LiquidCrystal.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Host stand-in for the InteractionChannel library.																		*/
+/*																																											*/
+/* It mirrors the interface of the board library: input comes from a Stream, a keypad	*/
+/* or a custom getKey function, output goes to a Stream, an LCD or a custom writeChar		*/
+/* function.																																						*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+class InteractionChannel
+{
+	public:
+
+		InteractionChannel(Stream &_stream) : stream(&_stream) { }
+
+		InteractionChannel(Stream &_stream,char (*getKey)()) : stream(&_stream)
+		{
+			this->readFunction = getKey;
+		}
+
+		InteractionChannel(Stream &_stream,void (*writeChar)(String s)) : stream(&_stream)
+		{
+			this->printFunction = writeChar;
+		}
+
+		InteractionChannel(char (*getKey)(),void (*writeChar)(String s)) : stream(NULL)
+		{
+			this->readFunction = getKey;
+			this->printFunction = writeChar;
+		}
+
+		InteractionChannel(Stream &_stream,Keypad* keypad) : stream(&_stream), keypad(keypad) { }
+
+		InteractionChannel(Stream &_stream,LiquidCrystal* lcd) : stream(&_stream), lcd(lcd) { }
+
+		InteractionChannel(Keypad* keypad,LiquidCrystal* lcd) : stream(NULL), keypad(keypad), lcd(lcd) { }
+
+		char (*readFunction)() = NULL;
+		void (*printFunction)(String s) = NULL;
+
+		char read()
+		{
+			if(this->readFunction != NULL)
+			{
+				return this->readFunction();
+			}
+			if(this->keypad != NULL)
+			{
+				return this->keypad->getKey();
+			}
+			if(this->stream != NULL)
+			{
+				return this->stream->read();
+			}
+			return -1;
+		}
+
+		int available()
+		{
+			return this->stream != NULL ? this->stream->available() : 0;
+		}
+
+		int peek()
+		{
+			return this->stream != NULL ? this->stream->peek() : -1;
+		}
+
+		void write(byte b)
+		{
+			if(this->output() != NULL)
+			{
+				this->output()->write(b);
+			}
+		}
+
+		void println(String string)
+		{
+			if(this->printFunction != NULL)
+			{
+				this->printFunction(string);
+			}
+			else if(this->output() != NULL)
+			{
+				this->output()->println(string);
+			}
+		}
+
+		void println(int n)
+		{
+			this->println(String(n));
+		}
+
+		void println(char c)
+		{
+			this->print(c);
+		}
+
+		void print(String string)
+		{
+			if(this->printFunction != NULL)
+			{
+				this->printFunction(string);
+			}
+			else if(this->output() != NULL)
+			{
+				this->output()->print(string);
+			}
+		}
+
+		void print(char c)
+		{
+			if(this->printFunction != NULL)
+			{
+				this->printFunction(String(c));
+			}
+			else if(this->output() != NULL)
+			{
+				this->output()->print(c);
+			}
+		}
+
+	private:
+		Stream* stream;
+		Keypad* keypad = NULL;
+		LiquidCrystal* lcd = NULL;
+
+		Print* output()
+		{
+			if(this->lcd != NULL)
+			{
+				return this->lcd;
+			}
+			return this->stream;
+		}
+};
+
+#endif
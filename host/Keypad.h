@@ -0,0 +1,40 @@
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include "Arduino.h"
+
+#define NO_KEY '\0'
+
+/* Host stand-in for a matrix keypad: keys are queued with press() and returned by getKey() */
+class Keypad
+{
+	public:
+		Keypad() : _head(0), _tail(0) { }
+
+		char getKey()
+		{
+			if(this->_head == this->_tail)
+			{
+				return NO_KEY;
+			}
+			char key = this->_keys[this->_tail];
+			this->_tail = (this->_tail + 1) % sizeof(this->_keys);
+			return key;
+		}
+
+		void press(const char* keys)
+		{
+			for(; *keys; keys++)
+			{
+				this->_keys[this->_head] = *keys;
+				this->_head = (this->_head + 1) % sizeof(this->_keys);
+			}
+		}
+
+	private:
+		char _keys[32];
+		unsigned int _head;
+		unsigned int _tail;
+};
+
+#endif
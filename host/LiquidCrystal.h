@@ -0,0 +1,24 @@
+#ifndef LiquidCrystal_h
+#define LiquidCrystal_h
+
+#include <string>
+#include "Arduino.h"
+
+/* Host stand-in for a character LCD: everything printed is kept in screen() */
+class LiquidCrystal : public Print
+{
+	public:
+		LiquidCrystal() { }
+		void begin(uint8_t cols, uint8_t rows) { }
+		void clear() { this->_screen.clear(); }
+		void setCursor(uint8_t col, uint8_t row) { }
+		size_t write(uint8_t c) { this->_screen += (char)c; return 1; }
+		using Print::write;
+
+		const std::string& screen() const { return this->_screen; }
+
+	private:
+		std::string _screen;
+};
+
+#endif
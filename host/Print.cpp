@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <string.h>
+#include "Stream.h"
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+  size_t n = 0;
+  while(size--)
+  {
+    n += this->write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::write(const char* str)
+{
+  if(str == NULL)
+  {
+    return 0;
+  }
+  return this->write((const uint8_t*)str, strlen(str));
+}
+
+size_t Print::printNumber(unsigned long value, int base, bool negative)
+{
+  char digits[66];
+  int i = 0;
+  if(base < 2)
+  {
+    base = 10;
+  }
+  do
+  {
+    int digit = value % base;
+    digits[i++] = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while(value > 0);
+
+  size_t n = negative ? this->write('-') : 0;
+  while(i > 0)
+  {
+    n += this->write(digits[--i]);
+  }
+  return n;
+}
+
+size_t Print::print(const char str[])
+{
+  return this->write(str);
+}
+
+size_t Print::print(const String& string)
+{
+  return this->write((const uint8_t*)string.c_str(), string.length());
+}
+
+size_t Print::print(const __FlashStringHelper* fstr)
+{
+  return this->write(reinterpret_cast<const char*>(fstr));
+}
+
+size_t Print::print(char c)
+{
+  return this->write(c);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+  return this->printNumber(value, base, false);
+}
+
+size_t Print::print(int value, int base)
+{
+  return this->print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+  return this->printNumber(value, base, false);
+}
+
+size_t Print::print(long value, int base)
+{
+  if(base == 10 && value < 0)
+  {
+    return this->printNumber(-(unsigned long)value, base, true);
+  }
+  return this->printNumber((unsigned long)value, base, false);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+  return this->printNumber(value, base, false);
+}
+
+size_t Print::print(double value, int digits)
+{
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+  return this->write(buffer);
+}
+
+size_t Print::println()
+{
+  return this->write("\r\n");
+}
+
+size_t Print::println(const char str[])
+{
+  size_t n = this->print(str);
+  return n + this->println();
+}
+
+size_t Print::println(const String& string)
+{
+  size_t n = this->print(string);
+  return n + this->println();
+}
+
+size_t Print::println(const __FlashStringHelper* fstr)
+{
+  size_t n = this->print(fstr);
+  return n + this->println();
+}
+
+size_t Print::println(char c)
+{
+  size_t n = this->print(c);
+  return n + this->println();
+}
+
+size_t Print::println(unsigned char value, int base)
+{
+  size_t n = this->print(value, base);
+  return n + this->println();
+}
+
+size_t Print::println(int value, int base)
+{
+  size_t n = this->print(value, base);
+  return n + this->println();
+}
+
+size_t Print::println(unsigned int value, int base)
+{
+  size_t n = this->print(value, base);
+  return n + this->println();
+}
+
+size_t Print::println(long value, int base)
+{
+  size_t n = this->print(value, base);
+  return n + this->println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+  size_t n = this->print(value, base);
+  return n + this->println();
+}
+
+size_t Print::println(double value, int digits)
+{
+  size_t n = this->print(value, digits);
+  return n + this->println();
+}
@@ -0,0 +1,40 @@
+#ifndef __SIMPLE_DHT_H
+#define __SIMPLE_DHT_H
+
+#include "Arduino.h"
+
+/* Error codes, as returned by the SimpleDHT library */
+#define SimpleDHTErrSuccess					0
+#define SimpleDHTErrStartLow				16
+#define SimpleDHTErrStartHigh				17
+#define SimpleDHTErrDataLow					18
+#define SimpleDHTErrDataRead				19
+#define SimpleDHTErrDataEOF					20
+#define SimpleDHTErrDataChecksum		21
+#define SimpleDHTErrZeroSamples			22
+#define SimpleDHTErrNoPin						23
+
+/* Host stand-in for SimpleDHT11. Every read is a simulated transaction against the		*/
+/* device scripted with HostSim::setDht() on the same pin.															*/
+class SimpleDHT
+{
+	public:
+		SimpleDHT() : pin(-1) { }
+		SimpleDHT(int pin) : pin(pin) { }
+		virtual ~SimpleDHT() { }
+
+		virtual int read(byte* ptemperature, byte* phumidity, byte pdata[40]);
+		virtual int read2(float* ptemperature, float* phumidity, byte pdata[40]);
+
+	protected:
+		int pin;
+};
+
+class SimpleDHT11 : public SimpleDHT
+{
+	public:
+		SimpleDHT11() { }
+		SimpleDHT11(int pin) : SimpleDHT(pin) { }
+};
+
+#endif
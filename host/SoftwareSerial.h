@@ -0,0 +1,19 @@
+#ifndef SoftwareSerial_h
+#define SoftwareSerial_h
+
+#include "Arduino.h"
+
+/* Host stand-in for SoftwareSerial: a loopback-free port that discards output */
+class SoftwareSerial : public Stream
+{
+	public:
+		SoftwareSerial(uint8_t receivePin, uint8_t transmitPin, bool inverseLogic = false) { }
+		void begin(long speed) { }
+		size_t write(uint8_t c) { return 1; }
+		int available() { return 0; }
+		int read() { return -1; }
+		int peek() { return -1; }
+		using Print::write;
+};
+
+#endif
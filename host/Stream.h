@@ -0,0 +1,57 @@
+#ifndef Stream_h
+#define Stream_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WString.h"
+
+/* Host stand-in for the Arduino Print class: everything ends up in write(uint8_t) */
+class Print
+{
+	public:
+		virtual ~Print() { }
+
+		virtual size_t write(uint8_t c) = 0;
+		virtual size_t write(const uint8_t* buffer, size_t size);
+		size_t write(const char* str);
+		/* As the Arduino core: 0 unless the sink knows its free TX room */
+		virtual int availableForWrite() { return 0; }
+
+		size_t print(const char str[]);
+		size_t print(const String& string);
+		size_t print(const __FlashStringHelper* fstr);
+		size_t print(char c);
+		size_t print(unsigned char value, int base = 10);
+		size_t print(int value, int base = 10);
+		size_t print(unsigned int value, int base = 10);
+		size_t print(long value, int base = 10);
+		size_t print(unsigned long value, int base = 10);
+		size_t print(double value, int digits = 2);
+
+		size_t println();
+		size_t println(const char str[]);
+		size_t println(const String& string);
+		size_t println(const __FlashStringHelper* fstr);
+		size_t println(char c);
+		size_t println(unsigned char value, int base = 10);
+		size_t println(int value, int base = 10);
+		size_t println(unsigned int value, int base = 10);
+		size_t println(long value, int base = 10);
+		size_t println(unsigned long value, int base = 10);
+		size_t println(double value, int digits = 2);
+
+	private:
+		size_t printNumber(unsigned long value, int base, bool negative);
+};
+
+/* Host stand-in for the Arduino Stream class */
+class Stream : public Print
+{
+	public:
+		virtual int available() = 0;
+		virtual int read() = 0;
+		virtual int peek() = 0;
+		virtual void flush() { }
+};
+
+#endif
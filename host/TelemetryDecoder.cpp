@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <string.h>
+#include "TelemetryDecoder.h"
+#include "Telemetry.h"
+
+/* Type codes a sensor can send, from CUSTOM to the last built-in type */
+static bool knownTypeCode(uint8_t typeCode)
+{
+  return typeCode <= SOIL_MOISTURE_METER;
+}
+
+static uint32_t getLong(const std::vector<uint8_t>& record, size_t position)
+{
+  uint32_t value = 0;
+  for(int i = 0; i < 4; i++)
+  {
+    value |= (uint32_t)record[position + i] << (8 * i);
+  }
+  return value;
+}
+
+static float getFloat(const std::vector<uint8_t>& record, size_t position)
+{
+  uint32_t bits = getLong(record, position);
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/* Reads a NUL terminated string, returns false if it is not terminated before end */
+static bool getText(const std::vector<uint8_t>& record, size_t& position, size_t end, std::string& text)
+{
+  text.clear();
+  while(position < end && record[position] != 0x00)
+  {
+    text += (char)record[position++];
+  }
+  if(position >= end)
+  {
+    return false;
+  }
+  position++;
+  return true;
+}
+
+TelemetryDecoder::Result TelemetryDecoder::feed(uint8_t byte)
+{
+  if(byte != 0x00)
+  {
+    this->_frame.push_back(byte);
+    return NONE;
+  }
+
+  /* Delimiter: decode what was collected, empty frames are just padding */
+  if(this->_frame.empty())
+  {
+    return NONE;
+  }
+  std::vector<uint8_t> record;
+  bool encoded = TelemetryDecoder::cobsDecode(this->_frame, record);
+  this->_frame.clear();
+
+  /* At least a frame type, a sensor id and a type code besides the CRC */
+  if(!encoded || record.size() < 3 + 2)
+  {
+    this->_errors++;
+    return ERROR;
+  }
+
+  uint16_t crc = record[record.size() - 2] | (record[record.size() - 1] << 8);
+  record.resize(record.size() - 2);
+  if(crc != crc16(record.data(), record.size()))
+  {
+    this->_errors++;
+    return ERROR;
+  }
+
+  Result result = this->decode(record);
+  if(result == ERROR)
+  {
+    this->_errors++;
+  }
+  return result;
+}
+
+TelemetryDecoder::Result TelemetryDecoder::decode(const std::vector<uint8_t>& record)
+{
+  /* A code no sensor sends: the frame is from another firmware, or corrupted despite its CRC */
+  if(!knownTypeCode(record[2]))
+  {
+    return ERROR;
+  }
+
+  if(record[0] == TELEMETRY_SAMPLE && record.size() == 15)
+  {
+    this->_sample.sensorId = record[1];
+    this->_sample.typeCode = record[2];
+    this->_sample.timestamp = getLong(record, 3);
+    this->_sample.rawValue = getFloat(record, 7);
+    this->_sample.value = getFloat(record, 11);
+    return SAMPLE;
+  }
+
+  if(record[0] == TELEMETRY_SCHEMA && record.size() >= 7)
+  {
+    TelemetrySchema schema;
+    schema.sensorId = record[1];
+    schema.typeCode = record[2];
+    schema.decimals = record[3];
+    schema.labelWidth = record[4];
+    size_t position = 5;
+    if(!getText(record, position, record.size(), schema.label) || !getText(record, position, record.size(), schema.measureUnit))
+    {
+      return ERROR;
+    }
+    this->_schemas[schema.sensorId] = schema;
+    return SCHEMA;
+  }
+
+  return ERROR;
+}
+
+const TelemetrySchema* TelemetryDecoder::schema(uint8_t sensorId) const
+{
+  std::map<uint8_t, TelemetrySchema>::const_iterator found = this->_schemas.find(sensorId);
+  return found != this->_schemas.end() ? &found->second : NULL;
+}
+
+std::string TelemetryDecoder::format(const TelemetrySample& sample) const
+{
+  char line[128];
+  const TelemetrySchema* schema = this->schema(sample.sensorId);
+  if(schema == NULL)
+  {
+    snprintf(line, sizeof(line), "#%u: %g", sample.sensorId, sample.value);
+  } else {
+    snprintf(line, sizeof(line), "%-*s: %.*f%s", (int)schema->labelWidth, schema->label.c_str(), schema->decimals, sample.value, schema->measureUnit.c_str());
+  }
+  return line;
+}
+
+bool TelemetryDecoder::cobsDecode(const std::vector<uint8_t>& input, std::vector<uint8_t>& output)
+{
+  output.clear();
+  size_t i = 0;
+  while(i < input.size())
+  {
+    uint8_t code = input[i++];
+    if(code == 0x00 || i + code - 1 > input.size())
+    {
+      return false;
+    }
+    for(uint8_t j = 1; j < code; j++)
+    {
+      output.push_back(input[i++]);
+    }
+    /* A block shorter than 254 bytes stood for a zero, unless it is the last one */
+    if(code < 0xFF && i < input.size())
+    {
+      output.push_back(0x00);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,74 @@
+#ifndef TelemetryDecoder_h
+#define TelemetryDecoder_h
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Host-side decoder of the binary telemetry frames of Telemetry.h.											*/
+/*																																											*/
+/* Bytes are fed as they arrive; at every 0x00 delimiter the frame is COBS decoded and	*/
+/* its CRC checked. Schemas are remembered per sensor id, so samples can be shown with	*/
+/* their label, unit and decimals, the label padded to the width the schema gives: the	*/
+/* SENSOR_LABEL_WIDTH of the sending board, so lines match the ones it prints. Frames		*/
+/* with a type code above SOIL_MOISTURE_METER are errors.																*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+struct TelemetrySchema
+{
+	uint8_t sensorId;
+	uint8_t typeCode;
+	uint8_t decimals;
+	uint8_t labelWidth;					// Width the sender pads the label to
+	std::string label;
+	std::string measureUnit;
+};
+
+struct TelemetrySample
+{
+	uint8_t sensorId;
+	uint8_t typeCode;
+	uint32_t timestamp;
+	float rawValue;
+	float value;
+};
+
+class TelemetryDecoder
+{
+	public:
+		enum Result { NONE, SAMPLE, SCHEMA, ERROR };
+
+		TelemetryDecoder() : _errors(0) { }
+
+		/* feed: consumes one byte. Returns what the byte completed, if anything */
+		Result feed(uint8_t byte);
+
+		/* Last decoded sample, valid after feed() returned SAMPLE */
+		const TelemetrySample& sample() const { return this->_sample; }
+
+		/* Schema of a sensor, NULL if none was received */
+		const TelemetrySchema* schema(uint8_t sensorId) const;
+
+		/* format: the sample as the text line the sensor would have printed, if its schema is known */
+		std::string format(const TelemetrySample& sample) const;
+
+		/* Frames dropped for bad encoding, length or CRC */
+		unsigned long errors() const { return this->_errors; }
+
+		/* cobsDecode: decodes a frame without its delimiter. Returns false if the encoding is invalid */
+		static bool cobsDecode(const std::vector<uint8_t>& input, std::vector<uint8_t>& output);
+
+	private:
+		std::vector<uint8_t> _frame;
+		TelemetrySample _sample;
+		std::map<uint8_t, TelemetrySchema> _schemas;
+		unsigned long _errors;
+
+		Result decode(const std::vector<uint8_t>& record);
+};
+
+#endif
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <string.h>
+#include "WString.h"
+
+extern unsigned long hostStringAllocations;
+
+static void formatInteger(char* buffer, unsigned long value, unsigned char base, bool negative)
+{
+  char digits[34];
+  int i = 0;
+  do
+  {
+    int digit = value % base;
+    digits[i++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+    value /= base;
+  } while(value > 0);
+
+  if(negative)
+  {
+    *buffer++ = '-';
+  }
+  while(i > 0)
+  {
+    *buffer++ = digits[--i];
+  }
+  *buffer = 0x00;
+}
+
+void String::assign(const char* cstr, size_t length)
+{
+  if(length > 0)
+  {
+    hostStringAllocations++;
+  }
+  this->_buffer.assign(cstr, length);
+}
+
+String::String(const char* cstr)
+{
+  this->assign(cstr, cstr != NULL ? strlen(cstr) : 0);
+}
+
+String::String(const String& other)
+{
+  this->assign(other.c_str(), other.length());
+}
+
+String::String(const __FlashStringHelper* fstr)
+{
+  const char* cstr = reinterpret_cast<const char*>(fstr);
+  this->assign(cstr, cstr != NULL ? strlen(cstr) : 0);
+}
+
+String::String(char c)
+{
+  this->assign(&c, 1);
+}
+
+String::String(unsigned char value, unsigned char base)
+{
+  char buffer[34];
+  formatInteger(buffer, value, base, false);
+  this->assign(buffer, strlen(buffer));
+}
+
+String::String(int value, unsigned char base)
+{
+  char buffer[34];
+  if(base == 10 && value < 0)
+  {
+    formatInteger(buffer, -(long)value, base, true);
+  } else {
+    formatInteger(buffer, (unsigned int)value, base, false);
+  }
+  this->assign(buffer, strlen(buffer));
+}
+
+String::String(unsigned int value, unsigned char base)
+{
+  char buffer[34];
+  formatInteger(buffer, value, base, false);
+  this->assign(buffer, strlen(buffer));
+}
+
+String::String(long value, unsigned char base)
+{
+  char buffer[66];
+  if(base == 10 && value < 0)
+  {
+    formatInteger(buffer, -(unsigned long)value, base, true);
+  } else {
+    formatInteger(buffer, (unsigned long)value, base, false);
+  }
+  this->assign(buffer, strlen(buffer));
+}
+
+String::String(unsigned long value, unsigned char base)
+{
+  char buffer[66];
+  formatInteger(buffer, value, base, false);
+  this->assign(buffer, strlen(buffer));
+}
+
+String::String(float value, unsigned char decimalPlaces)
+{
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, (double)value);
+  this->assign(buffer, strlen(buffer));
+}
+
+String::String(double value, unsigned char decimalPlaces)
+{
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", decimalPlaces, value);
+  this->assign(buffer, strlen(buffer));
+}
+
+String& String::operator=(const String& other)
+{
+  if(this != &other)
+  {
+    this->assign(other.c_str(), other.length());
+  }
+  return *this;
+}
+
+String& String::operator+=(const String& other)
+{
+  this->concat(other);
+  return *this;
+}
+
+String& String::operator+=(const char* cstr)
+{
+  this->concat(cstr);
+  return *this;
+}
+
+String& String::operator+=(char c)
+{
+  this->concat(c);
+  return *this;
+}
+
+bool String::concat(const String& other)
+{
+  return this->concat(other.c_str());
+}
+
+bool String::concat(const char* cstr)
+{
+  if(cstr == NULL)
+  {
+    return false;
+  }
+  if(*cstr)
+  {
+    /* Growing the buffer is a reallocation on the board */
+    hostStringAllocations++;
+    this->_buffer.append(cstr);
+  }
+  return true;
+}
+
+bool String::concat(char c)
+{
+  char cstr[2] = { c, 0x00 };
+  return this->concat(cstr);
+}
+
+char String::charAt(unsigned int index) const
+{
+  return index < this->_buffer.length() ? this->_buffer[index] : 0x00;
+}
+
+String operator+(const String& lhs, const String& rhs)
+{
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, const char* rhs)
+{
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const char* lhs, const String& rhs)
+{
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, char rhs)
+{
+  String result(lhs);
+  result.concat(rhs);
+  return result;
+}
+
+String operator+(const String& lhs, int rhs)
+{
+  return lhs + String(rhs);
+}
+
+String operator+(const String& lhs, unsigned int rhs)
+{
+  return lhs + String(rhs);
+}
+
+String operator+(const String& lhs, long rhs)
+{
+  return lhs + String(rhs);
+}
+
+String operator+(const String& lhs, unsigned long rhs)
+{
+  return lhs + String(rhs);
+}
+
+String operator+(const String& lhs, float rhs)
+{
+  return lhs + String(rhs);
+}
+
+String operator+(const String& lhs, double rhs)
+{
+  return lhs + String(rhs);
+}
@@ -0,0 +1,62 @@
+#ifndef WString_h
+#define WString_h
+
+#include <string>
+
+class __FlashStringHelper;
+
+/* Host stand-in for the Arduino String class. Every construction or growth that would	*/
+/* hit the heap on a board is counted, see HostSim::stringAllocations().								*/
+class String
+{
+	public:
+		String(const char* cstr = "");
+		String(const String& other);
+		String(const __FlashStringHelper* fstr);
+		explicit String(char c);
+		explicit String(unsigned char value, unsigned char base = 10);
+		explicit String(int value, unsigned char base = 10);
+		explicit String(unsigned int value, unsigned char base = 10);
+		explicit String(long value, unsigned char base = 10);
+		explicit String(unsigned long value, unsigned char base = 10);
+		explicit String(float value, unsigned char decimalPlaces = 2);
+		explicit String(double value, unsigned char decimalPlaces = 2);
+
+		String& operator=(const String& other);
+		String& operator+=(const String& other);
+		String& operator+=(const char* cstr);
+		String& operator+=(char c);
+
+		bool concat(const String& other);
+		bool concat(const char* cstr);
+		bool concat(char c);
+
+		unsigned int length() const { return this->_buffer.length(); }
+		const char* c_str() const { return this->_buffer.c_str(); }
+		char charAt(unsigned int index) const;
+		char operator[](unsigned int index) const { return this->charAt(index); }
+
+		bool equals(const String& other) const { return this->_buffer == other._buffer; }
+		bool equals(const char* cstr) const { return this->_buffer == cstr; }
+		bool operator==(const String& other) const { return this->equals(other); }
+		bool operator==(const char* cstr) const { return this->equals(cstr); }
+		bool operator!=(const String& other) const { return !this->equals(other); }
+		bool operator!=(const char* cstr) const { return !this->equals(cstr); }
+
+	private:
+		std::string _buffer;
+		void assign(const char* cstr, size_t length);
+};
+
+String operator+(const String& lhs, const String& rhs);
+String operator+(const String& lhs, const char* rhs);
+String operator+(const char* lhs, const String& rhs);
+String operator+(const String& lhs, char rhs);
+String operator+(const String& lhs, int rhs);
+String operator+(const String& lhs, unsigned int rhs);
+String operator+(const String& lhs, long rhs);
+String operator+(const String& lhs, unsigned long rhs);
+String operator+(const String& lhs, float rhs);
+String operator+(const String& lhs, double rhs);
+
+#endif
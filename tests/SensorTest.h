@@ -0,0 +1,40 @@
+#ifndef SensorTest_h
+#define SensorTest_h
+
+#include <math.h>
+#include <stdio.h>
+#include "HostSim.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*																																											*/
+/* Minimal test harness for the host build.																							*/
+/*																																											*/
+/* Every TEST runs on a freshly reset simulated board. CHECK failures are reported and	*/
+/* counted, the executable exits non-zero if any check failed.													*/
+/*																																											*/
+//////////////////////////////////////////////////////////////////////////////////////////
+
+typedef void (*test_function)();
+
+class TestRegistry
+{
+	public:
+		TestRegistry(const char* name, test_function function);
+		static int run();
+		static void fail(const char* file, int line, const char* expression);
+};
+
+#define TEST(name) \
+	static void name(); \
+	static TestRegistry name##_registration(#name, &name); \
+	static void name()
+
+#define CHECK(condition) \
+	do { if(!(condition)) { TestRegistry::fail(__FILE__, __LINE__, #condition); } } while(0)
+
+#define CHECK_EQUAL(expected, actual) CHECK((expected) == (actual))
+
+#define CHECK_CLOSE(expected, actual, tolerance) \
+	CHECK(fabs((double)(expected) - (double)(actual)) <= (tolerance))
+
+#endif
@@ -0,0 +1,50 @@
+#include "SensorTest.h"
+
+#define MAX_TESTS 256
+
+typedef struct test_case {
+
+		const char* name;
+		test_function function;
+
+	} test_case;
+
+static test_case tests[MAX_TESTS];
+static int testCount = 0;
+static int failures = 0;
+static const char* currentTest = NULL;
+
+TestRegistry::TestRegistry(const char* name, test_function function)
+{
+  if(testCount < MAX_TESTS)
+  {
+    tests[testCount].name = name;
+    tests[testCount].function = function;
+    testCount++;
+  }
+}
+
+void TestRegistry::fail(const char* file, int line, const char* expression)
+{
+  printf("  FAILED %s (%s:%d): %s\n", currentTest, file, line, expression);
+  failures++;
+}
+
+int TestRegistry::run()
+{
+  for(int i = 0; i < testCount; i++)
+  {
+    currentTest = tests[i].name;
+    HostSim::reset();
+    int before = failures;
+    tests[i].function();
+    printf("%s %s\n", failures == before ? "ok  " : "FAIL", tests[i].name);
+  }
+  printf("%d tests, %d failed checks\n", testCount, failures);
+  return failures == 0 ? 0 : 1;
+}
+
+int main()
+{
+  return TestRegistry::run();
+}
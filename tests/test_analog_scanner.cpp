@@ -0,0 +1,92 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "AnalogScanner.h"
+
+#define A0_PIN 14
+#define A1_PIN 15
+#define A2_PIN 16
+#define DHT_PIN 2
+
+TEST(scan_reads_every_sensor_once)
+{
+  int first[] = { 10, 20, 30, 40, 50, 60, 70, 80, 90, 100 };
+  int second[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  HostSim::scriptAnalog(A0_PIN, first, 10);
+  HostSim::scriptAnalog(A1_PIN, second, 10);
+  HostSim::setAnalog(A2_PIN, 500);
+  Sensor light(A0_PIN, LIGHT_SENSOR, NULL);
+  Sensor red(A1_PIN, RED_LIGHT_SENSOR, NULL);
+  Sensor blue(A2_PIN, BLUE_LIGHT_SENSOR, NULL);
+  blue.numReadings = 4;
+
+  AnalogScanner scanner;
+  CHECK_EQUAL(0, scanner.add(&light));
+  CHECK_EQUAL(1, scanner.add(&red));
+  CHECK_EQUAL(2, scanner.add(&blue));
+  unsigned long pinModes = HostSim::pinModeCalls();
+
+  CHECK_EQUAL(3, scanner.scan());
+  CHECK_CLOSE(55, light.getLastValue(), 1e-4);
+  CHECK_CLOSE(5.5, red.getLastValue(), 1e-4);
+  CHECK_CLOSE(500, blue.getLastValue(), 1e-4);
+  CHECK_EQUAL(10UL, HostSim::analogReads(A0_PIN));
+  CHECK_EQUAL(4UL, HostSim::analogReads(A2_PIN));
+  CHECK_EQUAL(pinModes, HostSim::pinModeCalls());
+  CHECK_EQUAL(1U, light.getLastReadings().size());
+}
+
+TEST(samples_of_a_scan_are_interleaved)
+{
+  /* Conversions take 100 us: interleaved samples of two sensors span the same time */
+  HostSim::setAnalogReadMicros(100);
+  HostSim::setAnalog(A0_PIN, 100);
+  HostSim::setAnalog(A1_PIN, 200);
+  Sensor first(A0_PIN, LIGHT_SENSOR, NULL);
+  Sensor second(A1_PIN, LIGHT_SENSOR, NULL);
+  AnalogScanner scanner;
+  scanner.add(&first);
+  scanner.add(&second);
+
+  /* After a pin change one conversion is discarded and 10 us are waited */
+  scanner.setSettling(1, 10);
+  scanner.scan();
+  CHECK_EQUAL(20UL, HostSim::analogReads(A0_PIN));
+  CHECK_EQUAL(20UL, HostSim::analogReads(A1_PIN));
+  CHECK_EQUAL(20UL * 210, scanner.getScanMicros());
+
+  /* A single pin never changes */
+  AnalogScanner single;
+  single.add(&first);
+  single.setSettling(1, 10);
+  single.scan();
+  CHECK_EQUAL(31UL, HostSim::analogReads(A0_PIN));
+  CHECK_EQUAL(1110UL, single.getScanMicros());
+}
+
+TEST(scanned_readings_go_through_the_filter)
+{
+  int spiky[] = { 100, 900, 100, 100, 0 };
+  HostSim::scriptAnalog(A0_PIN, spiky, 5);
+  sensor_params params = { 1, 0, 0, 5, 2, {0.0, 100.0}, "Gas", "ppm", 1, &basicAnalogicReading, { FILTER_MEDIAN, 0, 0, 0 } };
+  Sensor gas(A0_PIN, params, NULL);
+  AnalogScanner scanner;
+  scanner.add(&gas);
+  scanner.scan();
+  CHECK_CLOSE(100, gas.getLastValue(), 0);
+  CHECK_EQUAL(5, gas.samplesPerReading());
+}
+
+TEST(only_analogic_sensors_are_scanned)
+{
+  Sensor hygrometer(DHT_PIN, HYGROMETER, NULL);
+  Sensor light(A0_PIN, LIGHT_SENSOR, NULL);
+  AnalogScanner scanner;
+  CHECK_EQUAL(-1, scanner.add(&hygrometer));
+  for(int i = 0; i < MAX_SCAN_CHANNELS; i++)
+  {
+    CHECK_EQUAL(i, scanner.add(&light));
+  }
+  CHECK_EQUAL(-1, scanner.add(&light));
+  CHECK_EQUAL(MAX_SCAN_CHANNELS, scanner.getChannelsCount());
+  CHECK(!hygrometer.scanSample(10));
+}
@@ -0,0 +1,102 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "DhtCache.h"
+#include "DhtAsync.h"
+
+#define A0_PIN 14
+#define A1_PIN 15
+#define DHT_PIN 2
+
+TEST(samples_are_spaced_by_read_delay)
+{
+  int trace[] = { 100, 200, 300, 400, 500, 600, 700, 800, 900, 1000 };
+  HostSim::scriptAnalog(A0_PIN, trace, 10);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+
+  CHECK(!sensor.ready());
+  CHECK(sensor.begin());
+  CHECK(!sensor.begin());
+  CHECK_EQUAL(INPUT, HostSim::pinModeOf(A0_PIN));
+
+  /* First sample immediately, then one every 100 ms */
+  CHECK(!sensor.poll());
+  CHECK_EQUAL(1UL, HostSim::analogReads(A0_PIN));
+  delay(99);
+  CHECK(!sensor.poll());
+  CHECK_EQUAL(1UL, HostSim::analogReads(A0_PIN));
+
+  bool done = false;
+  while(!done)
+  {
+    delay(1);
+    done = sensor.poll();
+  }
+  CHECK_EQUAL(900UL, millis());
+  CHECK_EQUAL(10UL, HostSim::analogReads(A0_PIN));
+  CHECK(sensor.ready());
+  CHECK_CLOSE(550.0, sensor.getLastValue(), 1e-4);
+  CHECK_EQUAL(1U, sensor.getLastReadings().size());
+  CHECK_EQUAL(900UL, sensor.getLastReadingTime());
+
+  /* Nothing happens until the next begin() */
+  CHECK(!sensor.poll());
+  CHECK(sensor.ready());
+  CHECK(sensor.begin());
+  CHECK(!sensor.ready());
+}
+
+TEST(polls_never_block)
+{
+  HostSim::setAnalog(A0_PIN, 10);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  sensor.begin();
+  for(int i = 0; i < 1000; i++)
+  {
+    sensor.poll();
+  }
+  CHECK_EQUAL(0UL, millis());
+  CHECK_EQUAL(1UL, HostSim::analogReads(A0_PIN));
+}
+
+TEST(one_loop_services_many_sensors)
+{
+  HostSim::setAnalog(A0_PIN, 10);
+  HostSim::setAnalog(A1_PIN, 20);
+  Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+  Sensor soil(A1_PIN, SOIL_MOISTURE_METER, "Soil");
+  light.begin();
+  soil.begin();
+
+  /* Both readings complete in the time a blocking loop would need for one */
+  while(!(light.ready() && soil.ready()))
+  {
+    light.poll();
+    soil.poll();
+    delay(1);
+  }
+  CHECK(millis() <= 901UL);
+  CHECK_CLOSE(10.0, light.getLastValue(), 1e-4);
+  CHECK_CLOSE(-0.0273 * 20 + 19.655, soil.getLastValue(), 1e-4);
+}
+
+TEST(dht_readings_complete_once_their_transaction_is_over)
+{
+  DhtCache::clear();
+  DhtAsync::clear();
+  HostSim::setDht(DHT_PIN, 21.0, 44.0);
+  Sensor hygrometer(DHT_PIN, HYGROMETER, "Hum");
+  Sensor thermometer(DHT_PIN, AIR_THERMOMETER, "Temp");
+  hygrometer.begin();
+  CHECK(!hygrometer.poll());
+  delay(DHT_START_MILLIS);
+  CHECK(!hygrometer.poll());
+  delay(DHT_FRAME_MILLIS);
+  CHECK(hygrometer.poll());
+  CHECK(hygrometer.ready());
+  CHECK_CLOSE(44.0, hygrometer.getLastValue(), 1e-6);
+
+  /* Within DHT_MIN_INTERVAL the cached pair completes the reading in one poll */
+  thermometer.begin();
+  CHECK(thermometer.poll());
+  CHECK_EQUAL(1UL, HostSim::dhtTransactions(DHT_PIN));
+}
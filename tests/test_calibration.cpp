@@ -0,0 +1,260 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "Calibration.h"
+
+#define A0_PIN 14
+#define A1_PIN 15
+
+TEST(linear_fit_is_stable_on_12_bit_readings)
+{
+  /* Readings close together near the top of a 12 bit range: uncentred sums of squares lose the slope */
+  float raw[] = { 4000, 4019, 4038, 4057, 4076, 4095 };
+  float reference[6];
+  for(int i = 0; i < 6; i++)
+  {
+    reference[i] = 0.125 * raw[i] - 480.5;
+  }
+
+  Calibration calibration;
+  CHECK(calibration.fit(CALIBRATION_LINEAR, raw, reference, 6));
+  CHECK_EQUAL(CALIBRATION_LINEAR, calibration.model());
+  CHECK_CLOSE(0.125, calibration.slope(), 1e-6);
+  CHECK_CLOSE(-480.5, calibration.intercept(), 5e-3);
+  CHECK_CLOSE(25.5, calibration.evaluate(4048), 1e-4);
+}
+
+TEST(polynomials_recover_exact_curves)
+{
+  float raw[] = { 100, 250, 400, 700, 900, 1000 };
+  float quadratic[6];
+  float cubic[6];
+  for(int i = 0; i < 6; i++)
+  {
+    float x = raw[i];
+    quadratic[i] = 2e-4 * x * x - 0.1 * x + 12;
+    cubic[i] = 1e-6 * x * x * x - 1e-3 * x * x + 0.5 * x - 3;
+  }
+
+  Calibration calibration;
+  CHECK(calibration.fit(CALIBRATION_QUADRATIC, raw, quadratic, 6));
+  CHECK_EQUAL(2, calibration.degree());
+  CHECK_CLOSE(2e-4 * 550 * 550 - 0.1 * 550 + 12, calibration.evaluate(550), 1e-3);
+  CHECK(calibration.slope() != calibration.slope());
+
+  CHECK(calibration.fit(CALIBRATION_CUBIC, raw, cubic, 6));
+  CHECK_EQUAL(3, calibration.degree());
+  CHECK_CLOSE(1e-6 * 550 * 550 * 550 - 1e-3 * 550 * 550 + 0.5 * 550 - 3, calibration.evaluate(550), 1e-3);
+}
+
+TEST(piecewise_goes_through_unsorted_points)
+{
+  /* Decreasing response, as a soil probe */
+  float raw[] = { 300, 800, 500, 300 };
+  float reference[] = { 90, 10, 40, 70 };
+
+  Calibration calibration;
+  CHECK(calibration.fit(CALIBRATION_PIECEWISE, raw, reference, 4));
+  CHECK_EQUAL(3, calibration.knots());
+  CHECK_CLOSE(80, calibration.evaluate(300), 1e-5);
+  CHECK_CLOSE(40, calibration.evaluate(500), 1e-5);
+  CHECK_CLOSE(25, calibration.evaluate(650), 1e-5);
+  CHECK_CLOSE(10, calibration.evaluate(800), 1e-5);
+
+  /* Outside the points, the end segments go on */
+  CHECK_CLOSE(100, calibration.evaluate(200), 1e-4);
+  CHECK_CLOSE(0, calibration.evaluate(900), 1e-4);
+}
+
+TEST(too_few_points_keep_the_calibration)
+{
+  float raw[] = { 100, 100, 200 };
+  float reference[] = { 1, 2, 3 };
+
+  Calibration calibration;
+  calibration.setLinear(5, 2);
+  CHECK(!calibration.fit(CALIBRATION_CUBIC, raw, reference, 3));
+  CHECK(!calibration.fit(CALIBRATION_QUADRATIC, raw, reference, 3));
+  CHECK(!calibration.fit(CALIBRATION_PIECEWISE, raw, reference, 1));
+  CHECK_EQUAL(CALIBRATION_LINEAR, calibration.model());
+  CHECK_CLOSE(205, calibration.evaluate(100), 0);
+}
+
+TEST(sensor_readings_use_the_fitted_model)
+{
+  HostSim::setAnalog(A0_PIN, 350);
+  sensor_params params = { 1, 0, 0, 1, 3, {0.0, 50.0, 100.0}, "EC", "uS", 1, &basicAnalogicReading, {} };
+  Sensor ec(A0_PIN, params, NULL);
+  float raw[] = { 100, 300, 900 };
+
+  ec.setCalibrationModel(CALIBRATION_PIECEWISE);
+  CHECK(ec.fitCalibration(raw));
+  CHECK_CLOSE(50 + 50.0 * 50 / 600, ec.collectInput(), 1e-4);
+  CHECK_CLOSE(50 + 50.0 * 50 / 600, ec.convertInput(350), 1e-4);
+
+  /* setValues goes back to a line */
+  float points[10] = { 0, 50, 100 };
+  ec.setValues(points, 1, 0.5);
+  CHECK_EQUAL(CALIBRATION_LINEAR, ec.getCalibration().model());
+  CHECK_CLOSE(176, ec.collectInput(), 1e-4);
+}
+
+TEST(interactive_calibration_fits_a_line)
+{
+  HostStream stream;
+  sensor_params params = { 1, 0, 0, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  Sensor probe(A0_PIN, params, NULL);
+  probe.streamAdd(stream);
+
+  /* One key press per calibration point, then CALIBRATION_SAMPLES samples are averaged */
+  int trace[2 * CALIBRATION_SAMPLES];
+  for(int i = 0; i < CALIBRATION_SAMPLES; i++)
+  {
+    trace[i] = 199 + 2 * (i % 2);
+    trace[CALIBRATION_SAMPLES + i] = 600;
+  }
+  HostSim::scriptAnalog(A0_PIN, trace, 2 * CALIBRATION_SAMPLES);
+  stream.feed("cc");
+  probe.calibrate();
+
+  CHECK_EQUAL(0U, HostSim::scriptRemaining(A0_PIN));
+  CHECK_EQUAL(CALIBRATION_DONE, probe.getCalibrationProgress().state);
+  CHECK_CLOSE(0.05, probe.getSlope(), 1e-6);
+  CHECK_CLOSE(0, probe.getIntercept(), 1e-5);
+  CHECK(stream.output().find("Slope =  0.0500; Intercept = 0.0000") != std::string::npos);
+}
+
+static calibration_progress saved;
+static int checkpoints = 0;
+
+static void saveProgress(Sensor* sensor, const calibration_progress* progress)
+{
+  saved = *progress;
+  checkpoints++;
+}
+
+TEST(calibration_does_not_block_other_sensors)
+{
+  HostStream stream;
+  sensor_params params = { 1, 0, 10, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  Sensor probe(A0_PIN, params, NULL);
+  Sensor other(A1_PIN, LIGHT_SENSOR, NULL);
+  probe.streamAdd(stream);
+  HostSim::setAnalog(A0_PIN, 200);
+  HostSim::setAnalog(A1_PIN, 7);
+
+  /* Polling without a calibration ends at once */
+  CHECK(probe.calibrationPoll());
+  CHECK(probe.calibrationBegin(0));
+  CHECK(!probe.calibrationBegin(0));
+  CHECK(probe.calibrationRunning());
+
+  /* Waiting for the key: the other sensor keeps reading, the probe shows its value once a second */
+  for(int i = 0; i < 3000; i++)
+  {
+    CHECK(!probe.calibrationPoll());
+    if(i % 100 == 0)
+    {
+      other.collectInput();
+    }
+    delay(1);
+  }
+  CHECK_EQUAL(20U, other.getLastReadings().size());
+  CHECK_EQUAL(CALIBRATION_WAITING, probe.getCalibrationProgress().state);
+  CHECK_EQUAL(3UL, HostSim::analogReads(A0_PIN));
+
+  /* Samples are readDelay apart */
+  stream.feed("c");
+  probe.calibrationPoll();
+  CHECK_EQUAL(CALIBRATION_ACQUIRING, probe.getCalibrationProgress().state);
+  unsigned long start = millis();
+  while(probe.getCalibrationProgress().point == 0)
+  {
+    probe.calibrationPoll();
+    delay(1);
+  }
+  CHECK_EQUAL((unsigned long)(CALIBRATION_SAMPLES - 1) * 10, millis() - start - 1);
+  CHECK_CLOSE(200, probe.getCalibrationProgress().rawValues[0], 0);
+
+  probe.calibrationAbort();
+  CHECK(!probe.calibrationRunning());
+  CHECK(probe.calibrationPoll());
+  CHECK_EQUAL(CALIBRATION_IDLE, probe.getCalibrationProgress().state);
+}
+
+TEST(calibration_resumes_after_a_reset)
+{
+  sensor_params params = { 1, 0, 0, 1, 3, {0.0, 50.0, 100.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  checkpoints = 0;
+  {
+    HostStream stream;
+    Sensor probe(A0_PIN, params, NULL);
+    probe.streamAdd(stream);
+    probe.setCalibrationModel(CALIBRATION_PIECEWISE);
+    probe.setCalibrationCheckpoint(&saveProgress);
+    HostSim::setAnalog(A0_PIN, 100);
+    probe.calibrationBegin(0);
+    stream.feed("c");
+    while(probe.getCalibrationProgress().point < 1)
+    {
+      probe.calibrationPoll();
+    }
+  }
+  CHECK_EQUAL(2, checkpoints);
+  CHECK_EQUAL(1, saved.point);
+  CHECK_EQUAL(CALIBRATION_PIECEWISE, saved.model);
+
+  /* After the reset the model set in the sketch is linear again: the saved one is fitted */
+  HostStream stream;
+  Sensor probe(A0_PIN, params, NULL);
+  probe.streamAdd(stream);
+  CHECK(probe.calibrationResume(saved, 0));
+  HostSim::setAnalog(A0_PIN, 300);
+  stream.feed("c");
+  while(probe.getCalibrationProgress().point < 2)
+  {
+    probe.calibrationPoll();
+  }
+  HostSim::setAnalog(A0_PIN, 900);
+  stream.feed("c");
+  bool done = false;
+  while(!done)
+  {
+    done = probe.calibrationPoll();
+  }
+
+  CHECK_EQUAL(CALIBRATION_DONE, probe.getCalibrationProgress().state);
+  CHECK_EQUAL(CALIBRATION_PIECEWISE, probe.getCalibration().model());
+  CHECK_EQUAL(CALIBRATION_LINEAR, probe.getCalibrationModel());
+  CHECK_CLOSE(25, probe.convertInput(200), 1e-4);
+
+  /* Progress of another sensor is refused */
+  calibration_progress other = saved;
+  other.points = 2;
+  CHECK(!probe.calibrationResume(other, 0));
+}
+
+TEST(calibration_points_go_through_the_filter)
+{
+  HostStream stream;
+  sensor_params params = { 1, 0, 0, 3, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, { FILTER_MEDIAN, 0, 0, 0 } };
+  Sensor probe(A0_PIN, params, NULL);
+  probe.streamAdd(stream);
+
+  /* A spike every third conversion, which the median rejects */
+  int spiky[CALIBRATION_SAMPLES * 3];
+  for(int i = 0; i < CALIBRATION_SAMPLES * 3; i++)
+  {
+    spiky[i] = i % 3 == 1 ? 1000 : 200;
+  }
+  CHECK(probe.calibrationBegin(0));
+  stream.feed("c");
+  probe.calibrationPoll();
+  HostSim::scriptAnalog(A0_PIN, spiky, CALIBRATION_SAMPLES * 3);
+  while(probe.getCalibrationProgress().point == 0)
+  {
+    probe.calibrationPoll();
+    delay(1);
+  }
+  CHECK_CLOSE(200, probe.getCalibrationProgress().rawValues[0], 0);
+  probe.calibrationAbort();
+}
@@ -0,0 +1,244 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "CalibrationStore.h"
+#include "EEPROM.h"
+
+#define A0_PIN 14
+#define A1_PIN 15
+
+static unsigned long fixedClock()
+{
+  return 1700000000UL;
+}
+
+TEST(calibrate_saves_and_the_constructor_loads)
+{
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+  CalibrationStore::setClock(&fixedClock);
+  sensor_params params = { 1, 0, 0, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  {
+    HostStream stream;
+    Sensor probe(A0_PIN, params, NULL);
+    CHECK_EQUAL(0UL, probe.getCalibrationTimestamp());
+    probe.streamAdd(stream);
+    int trace[2 * CALIBRATION_SAMPLES];
+    for(int i = 0; i < CALIBRATION_SAMPLES; i++)
+    {
+      trace[i] = 200;
+      trace[CALIBRATION_SAMPLES + i] = 600;
+    }
+    HostSim::scriptAnalog(A0_PIN, trace, 2 * CALIBRATION_SAMPLES);
+    stream.feed("cc");
+    probe.calibrate();
+    CHECK_CLOSE(0.05, probe.getSlope(), 1e-6);
+  }
+
+  /* After a reset the calibration is back at once, for the same type and pin only */
+  Sensor probe(A0_PIN, params, NULL);
+  CHECK_CLOSE(0.05, probe.getSlope(), 1e-6);
+  CHECK_CLOSE(0, probe.getIntercept(), 1e-5);
+  CHECK_EQUAL(1700000000UL, probe.getCalibrationTimestamp());
+  Sensor other(A1_PIN, params, NULL);
+  CHECK_CLOSE(1, other.getSlope(), 1e-6);
+  Sensor light(A0_PIN, LIGHT_SENSOR, NULL);
+  CHECK_EQUAL(0UL, light.getCalibrationTimestamp());
+  CalibrationStore::setClock(NULL);
+}
+
+TEST(other_models_are_fitted_again_on_load)
+{
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+  sensor_params params = { 1, 0, 0, 1, 3, {0.0, 50.0, 100.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  float raw[] = { 100, 300, 900 };
+  {
+    Sensor probe(A0_PIN, params, NULL);
+    probe.setCalibrationModel(CALIBRATION_PIECEWISE);
+    CHECK(probe.fitCalibration(raw));
+    CHECK(probe.saveCalibration());
+  }
+
+  Sensor probe(A0_PIN, params, NULL);
+  CHECK_EQUAL(CALIBRATION_PIECEWISE, probe.getCalibration().model());
+  CHECK_EQUAL(CALIBRATION_LINEAR, probe.getCalibrationModel());
+  CHECK_CLOSE(25, probe.convertInput(200), 1e-4);
+  CHECK_CLOSE(75, probe.convertInput(600), 1e-4);
+
+  /* Records of other calibration points are ignored */
+  sensor_params longer = { 1, 0, 0, 1, 4, {0.0, 50.0, 100.0, 150.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  Sensor changed(A0_PIN, longer, NULL);
+  CHECK(!changed.loadCalibration());
+  CHECK_EQUAL(CALIBRATION_LINEAR, changed.getCalibration().model());
+}
+
+TEST(records_are_spread_over_the_log)
+{
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+  sensor_params params = { 1, 0, 0, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  float points[10] = { 10.0, 30.0 };
+  Sensor kept(A1_PIN, params, NULL);
+  kept.setValues(points, 3, 0.5);
+  CHECK(kept.saveCalibration());
+
+  Sensor probe(A0_PIN, params, NULL);
+  int saves = 10 * CalibrationStore::slots();
+  for(int i = 1; i <= saves; i++)
+  {
+    probe.setValues(points, i, 0.1);
+    CHECK(probe.saveCalibration());
+  }
+
+  /* Each cell is written about once per lap of the log, not once per save */
+  unsigned long worst = 0;
+  for(int address = 0; address < HOST_EEPROM_SIZE; address++)
+  {
+    unsigned long writes = HostSim::eepromWrites(address);
+    worst = writes > worst ? writes : worst;
+  }
+  CHECK(worst <= 12);
+
+  Sensor reloaded(A0_PIN, params, NULL);
+  CHECK_CLOSE(saves, reloaded.getIntercept(), 1e-4);
+  Sensor other(A1_PIN, params, NULL);
+  CHECK_CLOSE(3, other.getIntercept(), 1e-6);
+  CHECK_CLOSE(0.5, other.getSlope(), 1e-6);
+}
+
+TEST(a_torn_record_leaves_the_previous_one)
+{
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+  sensor_params params = { 1, 0, 0, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  float points[10] = { 10.0, 30.0 };
+  Sensor probe(A0_PIN, params, NULL);
+  probe.setValues(points, 1, 0.25);
+  probe.saveCalibration();
+  probe.setValues(points, 2, 0.5);
+  probe.saveCalibration();
+
+  /* A reset in the middle of the second write */
+  int address = sizeof(calibration_record) + offsetof(calibration_record, slope);
+  EEPROM.write(address, EEPROM.read(address) ^ 0x01);
+  Sensor reloaded(A0_PIN, params, NULL);
+  CHECK_CLOSE(1, reloaded.getIntercept(), 1e-6);
+  CHECK_CLOSE(0.25, reloaded.getSlope(), 1e-6);
+
+  /* Nor are records of another version loaded */
+  CalibrationStore::erase();
+  calibration_record record;
+  memset(&record, 0, sizeof(record));
+  record.type = CUSTOM;
+  record.pin = A0_PIN;
+  record.model = CALIBRATION_LINEAR;
+  record.points = 2;
+  record.slope = 4;
+  CHECK(CalibrationStore::save(&record));
+  CHECK(CalibrationStore::load(CUSTOM, A0_PIN, &record));
+  EEPROM.write(offsetof(calibration_record, version), CALIBRATION_RECORD_VERSION + 1);
+  CHECK(!CalibrationStore::load(CUSTOM, A0_PIN, &record));
+}
+
+TEST(a_full_log_refuses_new_sensors)
+{
+  /* Two slots: each sensor keeps its latest record */
+  CalibrationStore::begin(0, 2 * sizeof(calibration_record));
+  CHECK_EQUAL(2U, CalibrationStore::slots());
+  sensor_params params = { 1, 0, 0, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  Sensor first(A0_PIN, params, NULL);
+  Sensor second(A1_PIN, params, NULL);
+  CHECK(first.saveCalibration());
+  CHECK(second.saveCalibration());
+  CHECK(!first.saveCalibration());
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+}
+
+TEST(the_host_eeprom_can_be_kept_in_a_file)
+{
+  const char* path = "test_calibration_store.eeprom";
+  remove(path);
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+  sensor_params params = { 1, 0, 0, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  float points[10] = { 10.0, 30.0 };
+
+  HostSim::setEepromFile(path);
+  {
+    Sensor probe(A0_PIN, params, NULL);
+    probe.setValues(points, 7, 0.75);
+    CHECK(probe.saveCalibration());
+  }
+
+  /* Power cycle: memory is lost, the file is read back */
+  HostSim::reset();
+  Sensor blank(A0_PIN, params, NULL);
+  CHECK_CLOSE(1, blank.getSlope(), 1e-6);
+  HostSim::setEepromFile(path);
+  Sensor probe(A0_PIN, params, NULL);
+  CHECK_CLOSE(7, probe.getIntercept(), 1e-6);
+  CHECK_CLOSE(0.75, probe.getSlope(), 1e-6);
+
+  HostSim::setEepromFile(NULL);
+  remove(path);
+}
+
+TEST(without_a_region_the_eeprom_is_left_alone)
+{
+  CalibrationStore::begin(CALIBRATION_STORE_START, CALIBRATION_STORE_LENGTH);
+  CHECK_EQUAL(0U, CalibrationStore::slots());
+  EEPROM.write(0, 0x42);
+  sensor_params params = { 1, 0, 0, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  Sensor probe(A0_PIN, params, NULL);
+  CHECK(!probe.saveCalibration());
+  CHECK_EQUAL(0x42, EEPROM.read(0));
+  CHECK_EQUAL(0UL, HostSim::eepromWrites(1));
+
+  /* A region past the end of the EEPROM is cut */
+  CalibrationStore::begin(HOST_EEPROM_SIZE - sizeof(calibration_record), 4 * sizeof(calibration_record));
+  CHECK_EQUAL(1U, CalibrationStore::slots());
+  CalibrationStore::begin(CALIBRATION_STORE_START, CALIBRATION_STORE_LENGTH);
+}
+
+TEST(global_sensors_load_once_the_region_is_set)
+{
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+  sensor_params params = { 1, 0, 0, 1, 2, {10.0, 30.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  float points[10] = { 10.0, 30.0 };
+  {
+    Sensor probe(A0_PIN, params, NULL);
+    probe.setValues(points, 5, 0.5);
+    CHECK(probe.saveCalibration());
+  }
+
+  /* Built before setup() calls begin() */
+  CalibrationStore::begin(0, 0);
+  Sensor probe(A0_PIN, params, NULL);
+  Sensor configured(A0_PIN, params, NULL);
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+  HostSim::setAnalog(A0_PIN, 10);
+  CHECK_CLOSE(10, probe.collectInput(), 1e-4);
+  CHECK_CLOSE(0.5, probe.getSlope(), 1e-6);
+
+  /* Values set by the sketch before the first reading are kept */
+  configured.setValues(points, 2, 3);
+  CHECK_CLOSE(32, configured.collectInput(), 1e-4);
+}
+
+TEST(fitting_leaves_a_running_calibration_alone)
+{
+  CalibrationStore::begin(0, HOST_EEPROM_SIZE);
+  sensor_params params = { 1, 0, 0, 1, 3, {0.0, 50.0, 100.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+  HostStream stream;
+  Sensor probe(A0_PIN, params, NULL);
+  probe.streamAdd(stream);
+  CHECK(probe.calibrationBegin(0));
+
+  float raw[] = { 100, 300, 900 };
+  probe.setCalibrationModel(CALIBRATION_PIECEWISE);
+  CHECK(probe.fitCalibration(raw));
+  CHECK_EQUAL(CALIBRATION_WAITING, probe.getCalibrationProgress().state);
+  CHECK(probe.calibrationRunning());
+
+  /* The raw values of the fit are still the ones saved */
+  CHECK(probe.saveCalibration());
+  calibration_record record;
+  CHECK(CalibrationStore::load(CUSTOM, A0_PIN, &record));
+  CHECK_CLOSE(300, record.rawValues[1], 1e-6);
+  probe.calibrationAbort();
+}
@@ -0,0 +1,154 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "CalibrationTable.h"
+
+#define A0_PIN 14
+#define A1_PIN 15
+#define DHT_PIN 2
+
+static sensor_params probeParams = { 1, 0, 0, 2, 3, {0.0, 50.0, 100.0}, "Probe", "u", 2, &basicAnalogicReading, {} };
+
+TEST(generated_entries_follow_the_calibration)
+{
+  float raw[] = { 0, 300, 600, 1023 };
+  float reference[] = { -20, 15, 80, 60 };
+  Calibration calibration;
+  CHECK(calibration.fit(CALIBRATION_CUBIC, raw, reference, 4));
+
+  static int16_t entries[CALIBRATION_TABLE_CODES];
+  float scale;
+  float offset;
+  CalibrationTable::generate(calibration, entries, &scale, &offset);
+  CalibrationTable table(entries, scale, offset);
+
+  for(int code = 0; code < CALIBRATION_TABLE_CODES; code += 7)
+  {
+    CHECK_CLOSE(calibration.evaluate(code), table.lookup(code), scale);
+  }
+  CHECK_CLOSE(calibration.evaluate(0), table.lookup(-5), scale);
+  CHECK_CLOSE(calibration.evaluate(CALIBRATION_TABLE_CODES - 1), table.lookup(CALIBRATION_TABLE_CODES + 10), scale);
+
+  /* Averages between two codes are interpolated */
+  CHECK_CLOSE((table.lookup(300) + table.lookup(301)) / 2, table.lookup(601L, 2), 2 * scale);
+  CHECK_CLOSE(table.lookup(300), table.lookup(900L, 3), 0);
+}
+
+TEST(sensors_with_the_same_calibration_share_a_table)
+{
+  HostSim::setAnalog(A0_PIN, 250);
+  HostSim::setAnalog(A1_PIN, 250);
+  Sensor first(A0_PIN, SOIL_MOISTURE_METER, "Soil 1");
+  Sensor second(A1_PIN, SOIL_MOISTURE_METER, "Soil 2");
+  float direct = first.collectInput();
+
+  CHECK(first.useCalibrationTable(true));
+  CHECK(second.useCalibrationTable(true));
+  CHECK_EQUAL(1, CalibrationTable::tablesInUse());
+  CHECK(first.getCalibrationTable() == second.getCalibrationTable());
+  CHECK_EQUAL(2, first.getCalibrationTable()->users());
+  CHECK_CLOSE(direct, first.collectInput(), first.getCalibrationTable()->scale());
+
+  /* A new calibration gets its own table, rebuilt at once */
+  float points[10] = { 4.0, 7.0 };
+  second.setValues(points, 10, 0.1);
+  CHECK_EQUAL(2, CalibrationTable::tablesInUse());
+  CHECK(first.getCalibrationTable() != second.getCalibrationTable());
+  CHECK_CLOSE(35, second.collectInput(), second.getCalibrationTable()->scale());
+
+  second.useCalibrationTable(false);
+  CHECK(second.getCalibrationTable() == NULL);
+  CHECK_EQUAL(1, CalibrationTable::tablesInUse());
+}
+
+TEST(tables_serve_non_linear_models)
+{
+  int trace[] = { 420, 421 };
+  HostSim::scriptAnalog(A0_PIN, trace, 2);
+  Sensor probe(A0_PIN, probeParams, NULL);
+  probe.setCalibrationModel(CALIBRATION_PIECEWISE);
+  probe.useCalibrationTable(true);
+  float raw[] = { 100, 300, 900 };
+  CHECK(probe.fitCalibration(raw));
+  CHECK(probe.getCalibrationTable() != NULL);
+
+  float expected = probe.getCalibration().evaluate(420.5);
+  CHECK_CLOSE(expected, probe.collectInput(), probe.getCalibrationTable()->scale());
+  CHECK_CLOSE(420.5, probe.getLastRawValue(), 0);
+}
+
+TEST(tables_are_released_with_their_sensors)
+{
+  {
+    Sensor probe(A0_PIN, probeParams, NULL);
+    CHECK(probe.useCalibrationTable(true));
+    CHECK_EQUAL(1, CalibrationTable::tablesInUse());
+  }
+  CHECK_EQUAL(0, CalibrationTable::tablesInUse());
+}
+
+TEST(no_tables_for_digital_sensors_or_a_full_pool)
+{
+  Sensor hygrometer(DHT_PIN, HYGROMETER, NULL);
+  CHECK(!hygrometer.useCalibrationTable(true));
+  CHECK(hygrometer.getCalibrationTable() == NULL);
+
+  /* Volume and soil have the same calibration */
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, NULL);
+  Sensor volume(A0_PIN, VOLUME_SENSOR, NULL);
+  Sensor light(A0_PIN, LIGHT_SENSOR, NULL);
+  Sensor probe(A0_PIN, probeParams, NULL);
+  float points[10] = { 0, 50, 100 };
+  probe.setValues(points, 5, 5);
+  CHECK(soil.useCalibrationTable(true));
+  CHECK(volume.useCalibrationTable(true));
+  CHECK(light.useCalibrationTable(true));
+  CHECK_EQUAL(MAX_CALIBRATION_TABLES, CalibrationTable::tablesInUse());
+  CHECK(!probe.useCalibrationTable(true));
+
+  /* Readings go on without a table */
+  HostSim::setAnalog(A0_PIN, 3);
+  CHECK_CLOSE(20, probe.collectInput(), 0);
+}
+
+TEST(given_tables_are_dropped_on_recalibration)
+{
+  Calibration calibration;
+  calibration.setLinear(1, 2);
+  static int16_t entries[CALIBRATION_TABLE_CODES];
+  float scale;
+  float offset;
+  CalibrationTable::generate(calibration, entries, &scale, &offset);
+  CalibrationTable flashTable(entries, scale, offset);
+
+  HostSim::setAnalog(A0_PIN, 100);
+  Sensor probe(A0_PIN, probeParams, NULL);
+  probe.setCalibrationTable(&flashTable);
+  CHECK_CLOSE(201, probe.collectInput(), scale);
+  CHECK_EQUAL(0, CalibrationTable::tablesInUse());
+
+  float points[10] = { 0, 50, 100 };
+  probe.setValues(points, 0, 3);
+  CHECK(probe.getCalibrationTable() == NULL);
+  CHECK_CLOSE(300, probe.collectInput(), 0);
+}
+
+TEST(calibrations_with_the_same_fingerprint_get_their_own_tables)
+{
+  /* Two lines whose fingerprints collide */
+  Calibration first;
+  Calibration second;
+  first.setLinear(0, 328.657013f);
+  second.setLinear(0, 512.054016f);
+  CHECK_EQUAL(first.fingerprint(), second.fingerprint());
+  CHECK(!first.sameAs(second));
+
+  CalibrationTable* firstTable = CalibrationTable::acquire(first);
+  CalibrationTable* secondTable = CalibrationTable::acquire(second);
+  CHECK(firstTable != NULL);
+  CHECK(secondTable != NULL);
+  CHECK(firstTable != secondTable);
+  CHECK_CLOSE(second.evaluate(100), secondTable->lookup(100), secondTable->scale());
+  CalibrationTable::release(firstTable);
+  CalibrationTable::release(secondTable);
+  CHECK_EQUAL(0, CalibrationTable::tablesInUse());
+}
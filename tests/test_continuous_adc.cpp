@@ -0,0 +1,206 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "ContinuousAdc.h"
+
+#define A0_PIN 14
+#define A1_PIN 15
+#define DHT_PIN 2
+
+TEST(conversions_follow_the_timer)
+{
+  ContinuousAdc::clear();
+  int trace[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  HostSim::scriptAnalog(A0_PIN, trace, 10);
+  CHECK_EQUAL(0, ContinuousAdc::add(A0_PIN));
+  CHECK(ContinuousAdc::begin(100));
+
+  HostSim::advanceMicros(99);
+  CHECK_EQUAL(0U, ContinuousAdc::available(0));
+  HostSim::advanceMicros(901);
+  CHECK_EQUAL(10U, ContinuousAdc::available(0));
+  CHECK_EQUAL(10UL, ContinuousAdc::conversions());
+  CHECK_EQUAL(10UL, HostSim::adcInterrupts());
+  CHECK_EQUAL(0UL, HostSim::analogReads());
+
+  uint16_t sample;
+  for(int i = 0; i < 10; i++)
+  {
+    CHECK(ContinuousAdc::take(0, &sample));
+    CHECK_EQUAL(trace[i], sample);
+  }
+  CHECK(!ContinuousAdc::take(0, &sample));
+  ContinuousAdc::end();
+}
+
+TEST(channels_are_converted_in_turn)
+{
+  ContinuousAdc::clear();
+  HostSim::setAnalog(A0_PIN, 100);
+  HostSim::setAnalog(A1_PIN, 200);
+  ContinuousAdc::add(A0_PIN);
+  ContinuousAdc::add(A1_PIN);
+  CHECK_EQUAL(0, ContinuousAdc::add(A0_PIN));
+  CHECK_EQUAL(2, ContinuousAdc::getChannelsCount());
+  ContinuousAdc::begin(50);
+
+  /* Delays of loop() don't stop the conversions */
+  delay(1);
+  CHECK_EQUAL(10U, ContinuousAdc::available(0));
+  CHECK_EQUAL(10U, ContinuousAdc::available(1));
+  uint16_t sample;
+  ContinuousAdc::take(0, &sample);
+  CHECK_EQUAL(100, sample);
+  ContinuousAdc::take(1, &sample);
+  CHECK_EQUAL(200, sample);
+  ContinuousAdc::end();
+}
+
+TEST(a_full_queue_counts_overruns)
+{
+  ContinuousAdc::clear();
+  int trace[1000];
+  for(int i = 0; i < 1000; i++)
+  {
+    trace[i] = i;
+  }
+  HostSim::scriptAnalog(A0_PIN, trace, 1000);
+  ContinuousAdc::add(A0_PIN);
+  ContinuousAdc::begin(10);
+  HostSim::advanceMillis(10);
+
+  /* The queued conversions are the oldest ones, the newer ones are lost */
+  CHECK_EQUAL(1000UL, ContinuousAdc::conversions());
+  CHECK_EQUAL((unsigned int)CONTINUOUS_QUEUE_SIZE - 1, ContinuousAdc::available(0));
+  CHECK_EQUAL(1000UL - (CONTINUOUS_QUEUE_SIZE - 1), ContinuousAdc::overruns(0));
+  uint16_t sample;
+  ContinuousAdc::take(0, &sample);
+  CHECK_EQUAL(0, sample);
+
+  /* Taken in time, nothing is lost */
+  while(ContinuousAdc::take(0, &sample))
+  {
+  }
+  unsigned long overruns = ContinuousAdc::overruns(0);
+  for(int i = 0; i < 100; i++)
+  {
+    HostSim::advanceMicros(100);
+    while(ContinuousAdc::take(0, &sample))
+    {
+    }
+  }
+  CHECK_EQUAL(overruns, ContinuousAdc::overruns(0));
+  ContinuousAdc::end();
+}
+
+TEST(begin_needs_channels_and_add_a_stopped_adc)
+{
+  ContinuousAdc::clear();
+  CHECK(!ContinuousAdc::begin(100));
+  ContinuousAdc::add(A0_PIN);
+  CHECK(!ContinuousAdc::begin(0));
+  CHECK(!ContinuousAdc::running());
+  CHECK(ContinuousAdc::begin(100));
+  CHECK(ContinuousAdc::running());
+  CHECK(!ContinuousAdc::begin(100));
+  CHECK_EQUAL(-1, ContinuousAdc::add(A1_PIN));
+
+  ContinuousAdc::end();
+  unsigned long interrupts = HostSim::adcInterrupts();
+  HostSim::advanceMillis(1);
+  CHECK_EQUAL(interrupts, HostSim::adcInterrupts());
+  CHECK_EQUAL(1, ContinuousAdc::add(A1_PIN));
+}
+
+TEST(sensors_read_the_queued_conversions)
+{
+  ContinuousAdc::clear();
+  HostSim::setAnalog(A0_PIN, 500);
+  Sensor light(A0_PIN, LIGHT_SENSOR, NULL);
+  Sensor hygrometer(DHT_PIN, HYGROMETER, NULL);
+  CHECK(!hygrometer.setContinuous(true));
+  CHECK(light.setContinuous(true));
+  CHECK(light.isContinuous());
+  ContinuousAdc::begin(100);
+
+  HostSim::advanceMicros(100 * light.samplesPerReading());
+  CHECK_CLOSE(500, light.collectInput(), 1e-4);
+  CHECK_EQUAL(0UL, HostSim::analogReads(A0_PIN));
+  CHECK_EQUAL(0U, ContinuousAdc::available(0));
+
+  /* Nothing queued: no new reading */
+  CHECK_CLOSE(500, light.collectInput(), 1e-4);
+  CHECK_EQUAL(1U, light.getLastReadings().size());
+
+  /* Fewer conversions than samples make a reading of their own */
+  HostSim::setAnalog(A0_PIN, 300);
+  HostSim::advanceMicros(300);
+  CHECK_CLOSE(300, light.collectInput(), 1e-4);
+  CHECK_EQUAL(2U, light.getLastReadings().size());
+
+  /* Raw readings take them as well, and without any get the raw value of the last reading */
+  HostSim::setAnalog(A0_PIN, 200);
+  HostSim::advanceMicros(200);
+  CHECK_CLOSE(200, light.collectRawInput(), 1e-4);
+  CHECK_CLOSE(300, light.collectRawInput(), 1e-4);
+
+  light.setContinuous(false);
+  CHECK(!light.isContinuous());
+  ContinuousAdc::end();
+}
+
+TEST(continuous_readings_go_through_the_filter)
+{
+  ContinuousAdc::clear();
+  int spiky[] = { 100, 900, 100, 100, 0 };
+  HostSim::scriptAnalog(A0_PIN, spiky, 5);
+  sensor_params params = { 1, 0, 0, 5, 2, {0.0, 100.0}, "Gas", "ppm", 1, &basicAnalogicReading, { FILTER_MEDIAN, 0, 0, 0 } };
+  Sensor gas(A0_PIN, params, NULL);
+  CHECK(gas.setContinuous(true));
+  ContinuousAdc::begin(100);
+
+  /* poll() takes the conversions as they are queued */
+  CHECK(gas.begin());
+  HostSim::advanceMicros(300);
+  CHECK(!gas.poll());
+  HostSim::advanceMicros(200);
+  CHECK(gas.poll());
+  CHECK_CLOSE(100, gas.getLastValue(), 1e-4);
+  ContinuousAdc::end();
+}
+
+TEST(sensors_follow_their_pin_when_channels_are_added_again)
+{
+  ContinuousAdc::clear();
+  HostSim::setAnalog(A0_PIN, 500);
+  HostSim::setAnalog(A1_PIN, 100);
+  Sensor light(A0_PIN, LIGHT_SENSOR, NULL);
+  CHECK(light.setContinuous(true));
+
+  /* The pin of the sensor gets another channel */
+  ContinuousAdc::clear();
+  CHECK(!light.isContinuous());
+  CHECK_EQUAL(0, ContinuousAdc::add(A1_PIN));
+  CHECK_EQUAL(1, ContinuousAdc::add(A0_PIN));
+  CHECK(light.isContinuous());
+  ContinuousAdc::begin(100);
+
+  HostSim::advanceMicros(200 * light.samplesPerReading());
+  CHECK_CLOSE(500, light.collectInput(), 1e-4);
+  CHECK_EQUAL(0U, ContinuousAdc::available(1));
+  ContinuousAdc::end();
+}
+
+TEST(conversions_are_not_oversampled)
+{
+  ContinuousAdc::clear();
+  sensor_params params = { 1, 0, 0, 5, 2, {0.0, 100.0}, "Gas", "ppm", 1, &basicAnalogicReading, { FILTER_MEAN, 2, 0, 0 } };
+  Sensor gas(A0_PIN, params, NULL);
+  CHECK(!gas.setContinuous(true));
+  CHECK_EQUAL(-1, ContinuousAdc::channelOf(A0_PIN));
+
+  /* Once continuous, oversampling is ignored */
+  gas.setFilter({ FILTER_MEAN, 0, 0, 0 });
+  CHECK(gas.setContinuous(true));
+  gas.setFilter({ FILTER_MEAN, 2, 0, 0 });
+  CHECK_EQUAL(0, gas.getFilter().oversamplingBits);
+}
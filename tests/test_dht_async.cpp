@@ -0,0 +1,153 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "DhtAsync.h"
+#include "SimpleDHT.h"
+
+#define DHT_PIN 2
+
+/* Runs a transaction from loop(), 1 ms per iteration. Returns the iterations */
+static int runTransaction(short int pin)
+{
+  DhtAsync::begin(pin);
+  int loops = 0;
+  while(!DhtAsync::poll(pin) && loops < 1000)
+  {
+    delay(1);
+    loops++;
+  }
+  return loops;
+}
+
+TEST(frames_are_decoded_from_edge_intervals)
+{
+  /* 35 %, 0, 23 C, 0, checksum 58 */
+  byte bytes[5] = { 35, 0, 23, 0, 58 };
+  unsigned char intervals[DHT_FRAME_EDGES] = { 30, 160 };
+  for(int i = 0; i < 40; i++)
+  {
+    intervals[i + 2] = (bytes[i / 8] >> (7 - i % 8)) & 0x01 ? 120 : 77;
+  }
+
+  float temperature = 0;
+  float humidity = 0;
+  CHECK_EQUAL(SimpleDHTErrSuccess, DhtAsync::decode(intervals, DHT_FRAME_EDGES, &temperature, &humidity));
+  CHECK_CLOSE(23.0, temperature, 1e-6);
+  CHECK_CLOSE(35.0, humidity, 1e-6);
+
+  CHECK_EQUAL(SimpleDHTErrStartLow, DhtAsync::decode(intervals, 0, &temperature, &humidity));
+  CHECK_EQUAL(SimpleDHTErrDataEOF, DhtAsync::decode(intervals, 20, &temperature, &humidity));
+  intervals[DHT_FRAME_EDGES - 1] = 120;
+  CHECK_EQUAL(SimpleDHTErrDataChecksum, DhtAsync::decode(intervals, DHT_FRAME_EDGES, &temperature, &humidity));
+}
+
+TEST(transactions_never_block_the_loop)
+{
+  DhtCache::clear();
+  DhtAsync::clear();
+  HostSim::setDht(DHT_PIN, 22.0, 48.0);
+
+  /* Every poll returns at once: the clock only moves with the delays of the loop */
+  int loops = runTransaction(DHT_PIN);
+  CHECK_EQUAL((unsigned long)loops, millis());
+  CHECK(loops <= DHT_START_MILLIS + DHT_FRAME_MILLIS);
+  CHECK_EQUAL(1UL, HostSim::dhtTransactions(DHT_PIN));
+
+  const dht_sample* sample = DhtCache::read(DHT_PIN);
+  CHECK(sample->valid);
+  CHECK_EQUAL(SimpleDHTErrSuccess, sample->lastError);
+  CHECK_CLOSE(22.0, sample->temperature, 1e-6);
+  CHECK_CLOSE(48.0, sample->humidity, 1e-6);
+  CHECK_EQUAL(1UL, HostSim::dhtTransactions(DHT_PIN));
+  CHECK(!DhtAsync::busy(DHT_PIN));
+}
+
+TEST(an_early_spurious_edge_does_not_shift_the_bits)
+{
+  DhtCache::clear();
+  DhtAsync::clear();
+  HostSim::setDht(DHT_PIN, 22.0, 48.0);
+
+  /* The handler runs once at attachInterrupt(), before the device answers */
+  HostSim::latchEdge(DHT_PIN);
+  runTransaction(DHT_PIN);
+  const dht_sample* sample = DhtCache::read(DHT_PIN);
+  CHECK_EQUAL(SimpleDHTErrSuccess, sample->lastError);
+  CHECK_CLOSE(22.0, sample->temperature, 1e-6);
+  CHECK_CLOSE(48.0, sample->humidity, 1e-6);
+
+  /* Decoding from the start would have read the response as the first bit */
+  byte bytes[5] = { 35, 0, 23, 0, 58 };
+  unsigned char intervals[DHT_CAPTURE_EDGES] = { 0, 30, 160 };
+  for(int i = 0; i < 40; i++)
+  {
+    intervals[i + 3] = (bytes[i / 8] >> (7 - i % 8)) & 0x01 ? 120 : 77;
+  }
+  float temperature = 0;
+  float humidity = 0;
+  CHECK_EQUAL(SimpleDHTErrSuccess, DhtAsync::decode(intervals, DHT_CAPTURE_EDGES, &temperature, &humidity));
+  CHECK_CLOSE(23.0, temperature, 1e-6);
+  CHECK_CLOSE(35.0, humidity, 1e-6);
+}
+
+TEST(failed_frames_keep_the_previous_pair)
+{
+  DhtCache::clear();
+  DhtAsync::clear();
+  HostSim::setDht(DHT_PIN, 22.0, 48.0);
+  runTransaction(DHT_PIN);
+
+  delay(DHT_MIN_INTERVAL);
+  HostSim::setDht(DHT_PIN, 30.0, 70.0);
+  HostSim::failDht(DHT_PIN, SimpleDHTErrDataChecksum, 1);
+  runTransaction(DHT_PIN);
+  const dht_sample* sample = DhtCache::read(DHT_PIN);
+  CHECK_EQUAL(SimpleDHTErrDataChecksum, sample->lastError);
+  CHECK_CLOSE(22.0, sample->temperature, 1e-6);
+
+  /* A frame cut short ends at the timeout */
+  delay(DHT_MIN_INTERVAL);
+  HostSim::failDht(DHT_PIN, SimpleDHTErrDataRead, 1);
+  runTransaction(DHT_PIN);
+  CHECK_EQUAL(SimpleDHTErrDataEOF, DhtCache::read(DHT_PIN)->lastError);
+
+  /* No device answers */
+  delay(DHT_MIN_INTERVAL);
+  HostSim::failDht(DHT_PIN, SimpleDHTErrStartLow, 1);
+  runTransaction(DHT_PIN);
+  CHECK_EQUAL(SimpleDHTErrStartLow, DhtCache::read(DHT_PIN)->lastError);
+
+  delay(DHT_MIN_INTERVAL);
+  runTransaction(DHT_PIN);
+  sample = DhtCache::read(DHT_PIN);
+  CHECK_EQUAL(SimpleDHTErrSuccess, sample->lastError);
+  CHECK_CLOSE(30.0, sample->temperature, 1e-6);
+  CHECK_EQUAL(5UL, HostSim::dhtTransactions(DHT_PIN));
+}
+
+TEST(blocking_reads_wait_for_the_running_transaction)
+{
+  DhtCache::clear();
+  DhtAsync::clear();
+  HostSim::setDht(DHT_PIN, 22.0, 48.0);
+  Sensor hygrometer(DHT_PIN, HYGROMETER, "Hum");
+
+  /* While the pin is driven by the transaction, read2() is not called */
+  hygrometer.begin();
+  CHECK(DhtAsync::busy(DHT_PIN));
+  CHECK(!DhtCache::read(DHT_PIN)->valid);
+  CHECK_EQUAL(0UL, HostSim::dhtTransactions(DHT_PIN));
+
+  while(!hygrometer.poll())
+  {
+    delay(1);
+  }
+  CHECK_CLOSE(48.0, hygrometer.getLastValue(), 1e-6);
+  CHECK_EQUAL(1UL, HostSim::dhtTransactions(DHT_PIN));
+}
+
+TEST(pins_without_interrupt_are_refused)
+{
+  DhtAsync::clear();
+  CHECK(!DhtAsync::begin(HOST_MAX_PINS));
+  CHECK(DhtAsync::poll(HOST_MAX_PINS));
+}
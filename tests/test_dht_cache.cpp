@@ -0,0 +1,94 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "DhtCache.h"
+#include "SimpleDHT.h"
+
+#define DHT_PIN 2
+
+TEST(hygrometer_and_thermometer_share_one_transaction)
+{
+  DhtCache::clear();
+  HostSim::setDht(DHT_PIN, 24.0, 61.0);
+  Sensor hygrometer(DHT_PIN, HYGROMETER, "Hum");
+  Sensor thermometer(DHT_PIN, AIR_THERMOMETER, "Temp");
+
+  CHECK_CLOSE(61.0, hygrometer.collectRawInput(), 1e-6);
+  CHECK_CLOSE(24.0, thermometer.collectRawInput(), 1e-6);
+  CHECK_EQUAL(1UL, HostSim::dhtTransactions(DHT_PIN));
+}
+
+TEST(device_is_not_polled_within_min_interval)
+{
+  DhtCache::clear();
+  HostSim::setDht(DHT_PIN, 24.0, 61.0);
+  Sensor hygrometer(DHT_PIN, HYGROMETER, "Hum");
+
+  hygrometer.collectRawInput();
+  HostSim::setDht(DHT_PIN, 25.0, 62.0);
+  delay(DHT_MIN_INTERVAL - 1);
+  CHECK_CLOSE(61.0, hygrometer.collectRawInput(), 1e-6);
+  CHECK_EQUAL(1UL, HostSim::dhtTransactions(DHT_PIN));
+
+  delay(1);
+  CHECK_CLOSE(62.0, hygrometer.collectRawInput(), 1e-6);
+  CHECK_EQUAL(2UL, HostSim::dhtTransactions(DHT_PIN));
+}
+
+TEST(failed_transaction_keeps_previous_pair)
+{
+  DhtCache::clear();
+  HostSim::setDht(DHT_PIN, 24.0, 61.0);
+  const dht_sample* sample = DhtCache::read(DHT_PIN);
+  CHECK(sample->valid);
+
+  delay(DHT_MIN_INTERVAL);
+  HostSim::setDht(DHT_PIN, 30.0, 70.0);
+  HostSim::failDht(DHT_PIN, SimpleDHTErrDataChecksum, 1);
+  sample = DhtCache::read(DHT_PIN);
+  CHECK(sample->valid);
+  CHECK_EQUAL(SimpleDHTErrDataChecksum, sample->lastError);
+  CHECK_CLOSE(24.0, sample->temperature, 1e-6);
+  CHECK_EQUAL(0UL, sample->timestamp);
+
+  /* A failed transaction also has to wait for the device to recover */
+  sample = DhtCache::read(DHT_PIN);
+  CHECK_EQUAL(2UL, HostSim::dhtTransactions(DHT_PIN));
+  delay(DHT_MIN_INTERVAL);
+  sample = DhtCache::read(DHT_PIN);
+  CHECK_EQUAL(SimpleDHTErrSuccess, sample->lastError);
+  CHECK_CLOSE(30.0, sample->temperature, 1e-6);
+}
+
+TEST(missing_device_is_never_valid)
+{
+  DhtCache::clear();
+  const dht_sample* sample = DhtCache::read(DHT_PIN);
+  CHECK(!sample->valid);
+  CHECK(sample->lastError != SimpleDHTErrSuccess);
+  CHECK_CLOSE(0.0, sample->humidity, 1e-6);
+}
+
+TEST(invalidate_forces_a_transaction)
+{
+  DhtCache::clear();
+  HostSim::setDht(DHT_PIN, 24.0, 61.0);
+  HostSim::setDhtMinInterval(0);
+  DhtCache::read(DHT_PIN);
+  DhtCache::invalidate(DHT_PIN);
+  DhtCache::read(DHT_PIN);
+  CHECK_EQUAL(2UL, HostSim::dhtTransactions(DHT_PIN));
+}
+
+TEST(devices_on_different_pins_are_independent)
+{
+  DhtCache::clear();
+  for(short int pin = 2; pin < 2 + MAX_DHT_DEVICES + 1; pin++)
+  {
+    HostSim::setDht(pin, pin, 10 * pin);
+  }
+  for(short int pin = 2; pin < 2 + MAX_DHT_DEVICES + 1; pin++)
+  {
+    CHECK_CLOSE(10.0 * pin, DhtCache::read(pin)->humidity, 1e-6);
+  }
+  CHECK_CLOSE(3.0, DhtCache::read(3)->temperature, 1e-6);
+}
@@ -0,0 +1,78 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "FixedPoint.h"
+
+#define A0_PIN 14
+
+/* Built against the SENSOR_FIXED_POINT library */
+#ifndef SENSOR_FIXED_POINT
+	#error "test_fixed_point must be built with SENSOR_FIXED_POINT"
+#endif
+
+TEST(conversions_round_and_saturate)
+{
+  CHECK_EQUAL(FIXED_ONE, fixedFromFloat(1.0));
+  CHECK_EQUAL(-FIXED_ONE / 2, fixedFromFloat(-0.5));
+  CHECK_EQUAL(1, fixedFromFloat(1.0 / 65536 * 0.6));
+  CHECK_EQUAL(-1, fixedFromFloat(-1.0 / 65536 * 0.6));
+  CHECK_EQUAL(FIXED_MAX, fixedFromFloat(40000.0));
+  CHECK_EQUAL(FIXED_MIN, fixedFromFloat(-40000.0));
+  CHECK_CLOSE(19.655, fixedToFloat(fixedFromFloat(19.655)), 1.0 / 131072);
+  CHECK_EQUAL(fixedFromFloat(-3.0), fixedFromInt(-3));
+}
+
+TEST(products_and_ratios)
+{
+  CHECK_EQUAL(fixedFromFloat(-2.5), fixedMultiply(fixedFromFloat(1.25), fixedFromInt(-2)));
+  CHECK_CLOSE(-0.0273 * 1023, fixedToFloat(fixedMultiply(fixedFromFloat(-0.0273), fixedFromInt(1023))), 1023.0 / 131072 + 1e-5);
+  CHECK_EQUAL(FIXED_MAX, fixedMultiply(fixedFromInt(1000), fixedFromInt(1000)));
+
+  /* Averages of ADC sums, including the largest 12 bit sums */
+  CHECK_EQUAL(fixedFromFloat(55.5), fixedFromRatio(555, 10));
+  CHECK_EQUAL(fixedFromFloat(1.0 / 3), fixedFromRatio(1, 3));
+  CHECK_EQUAL(fixedFromInt(4095), fixedFromRatio(4095L * 32767, 32767));
+  CHECK_EQUAL(-fixedFromFloat(2.5), fixedFromRatio(-5, 2));
+}
+
+TEST(fixed_readings_match_the_float_path)
+{
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, "Soil");
+  for(int raw = 0; raw <= 1023; raw += 31)
+  {
+    HostSim::setAnalog(A0_PIN, raw);
+    float value = soil.collectInput();
+    CHECK_CLOSE(-0.0273 * raw + 19.655, value, raw / 131072.0 + 1e-4);
+    CHECK_CLOSE((float)raw, soil.getLastRawValue(), 0);
+  }
+
+  /* Same text as the float build */
+  HostSim::setAnalog(A0_PIN, 110);
+  soil.collectInput();
+  char buffer[SENSOR_MESSAGE_SIZE];
+  soil.formattedReading(buffer, sizeof(buffer), soil.getLastValue());
+  CHECK(strcmp("Soil   : 16.65%", buffer) == 0);
+}
+
+TEST(asynchronous_readings_are_fixed_too)
+{
+  int trace[] = { 100, 200, 300, 400, 500, 600, 700, 800, 900, 1001 };
+  HostSim::scriptAnalog(A0_PIN, trace, 10);
+  Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+  light.begin();
+  while(!light.poll())
+  {
+    delay(1);
+  }
+  CHECK_CLOSE(550.1, light.getLastValue(), 1e-4);
+}
+
+TEST(new_coefficients_are_converted)
+{
+  Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+  float points[10] = { 0, 100 };
+  light.setValues(points, 2.5, 0.5);
+  CHECK_EQUAL(fixedFromFloat(2.5 + 0.5 * 200), light.convertInputFixed(fixedFromInt(200)));
+
+  HostSim::setAnalog(A0_PIN, 200);
+  CHECK_CLOSE(102.5, light.collectInput(), 0);
+}
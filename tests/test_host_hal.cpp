@@ -0,0 +1,107 @@
+#include "SensorTest.h"
+#include "SimpleDHT.h"
+#include "InteractionChannel.h"
+
+TEST(delay_advances_simulated_clock)
+{
+  CHECK_EQUAL(0UL, millis());
+  delay(250);
+  CHECK_EQUAL(250UL, millis());
+  delayMicroseconds(1500);
+  CHECK_EQUAL(251UL, millis());
+  CHECK_EQUAL(251500UL, micros());
+}
+
+TEST(analog_script_is_consumed_then_holds_last_value)
+{
+  int trace[] = { 10, 20, 30 };
+  HostSim::scriptAnalog(3, trace, 3);
+  CHECK_EQUAL(10, analogRead(3));
+  CHECK_EQUAL(20, analogRead(3));
+  CHECK_EQUAL(30, analogRead(3));
+  CHECK_EQUAL(30, analogRead(3));
+  CHECK_EQUAL(4UL, HostSim::analogReads(3));
+  CHECK_EQUAL(0U, HostSim::scriptRemaining(3));
+}
+
+TEST(analog_read_cost_advances_clock)
+{
+  HostSim::setAnalogReadMicros(100);
+  analogRead(0);
+  analogRead(0);
+  CHECK_EQUAL(200UL, micros());
+}
+
+TEST(fake_dht_returns_scripted_values)
+{
+  HostSim::setDht(7, 21.0, 55.0);
+  SimpleDHT11 dht(7);
+  float temperature = 0;
+  float humidity = 0;
+  byte data[40];
+  CHECK_EQUAL(SimpleDHTErrSuccess, dht.read2(&temperature, &humidity, data));
+  CHECK_CLOSE(21.0, temperature, 1e-6);
+  CHECK_CLOSE(55.0, humidity, 1e-6);
+  /* First data bit is the humidity MSB (55 = 0b00110111) */
+  CHECK_EQUAL(0, data[0]);
+  CHECK_EQUAL(1, data[7]);
+}
+
+TEST(fake_dht_enforces_minimum_interval)
+{
+  HostSim::setDht(7, 21.0, 55.0);
+  SimpleDHT11 dht(7);
+  float temperature = 0;
+  float humidity = 0;
+  CHECK_EQUAL(SimpleDHTErrSuccess, dht.read2(&temperature, &humidity, NULL));
+  CHECK(dht.read2(&temperature, &humidity, NULL) != SimpleDHTErrSuccess);
+  delay(1000);
+  CHECK_EQUAL(SimpleDHTErrSuccess, dht.read2(&temperature, &humidity, NULL));
+  CHECK_EQUAL(3UL, HostSim::dhtTransactions(7));
+}
+
+TEST(fake_dht_scripted_failures_and_transaction_time)
+{
+  HostSim::setDht(7, 21.0, 55.0);
+  HostSim::setDhtTransactionMillis(20);
+  HostSim::failDht(7, SimpleDHTErrDataChecksum, 1);
+  SimpleDHT11 dht(7);
+  float temperature = 0;
+  float humidity = 0;
+  CHECK_EQUAL(SimpleDHTErrDataChecksum, dht.read2(&temperature, &humidity, NULL));
+  CHECK_EQUAL(20UL, millis());
+  CHECK_EQUAL(SimpleDHTErrSuccess, dht.read2(&temperature, &humidity, NULL));
+}
+
+TEST(string_stand_in_concatenates_and_counts_allocations)
+{
+  String s = "Raw value = " + String(12.5) + "; n = " + String(3);
+  CHECK(s == "Raw value = 12.50; n = 3");
+  CHECK(HostSim::stringAllocations() > 0);
+  CHECK(String(-42) == "-42");
+  CHECK(String(3.14159, 3) == "3.142");
+}
+
+TEST(interaction_channel_over_stream)
+{
+  HostStream stream;
+  stream.feed("ab");
+  InteractionChannel channel(stream);
+  channel.println(String("hello"));
+  CHECK(stream.output() == "hello\r\n");
+  CHECK_EQUAL('a', channel.read());
+  CHECK_EQUAL('b', channel.read());
+  CHECK_EQUAL((char)-1, channel.read());
+}
+
+TEST(interaction_channel_keypad_and_lcd)
+{
+  Keypad keypad;
+  LiquidCrystal lcd;
+  keypad.press("c");
+  InteractionChannel channel(&keypad, &lcd);
+  channel.print(String("T: 21"));
+  CHECK(lcd.screen() == "T: 21");
+  CHECK_EQUAL('c', channel.read());
+  CHECK_EQUAL(NO_KEY, channel.read());
+}
@@ -0,0 +1,143 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "SensorInstrumentation.h"
+
+#define A0_PIN 14
+#define DHT_PIN 2
+
+/* Built against the SENSOR_INSTRUMENTATION library */
+#ifndef SENSOR_INSTRUMENTATION
+	#error "test_instrumentation must be built with SENSOR_INSTRUMENTATION"
+#endif
+
+TEST(durations_go_to_log2_buckets)
+{
+  CHECK_EQUAL(0, histogramBucket(0));
+  CHECK_EQUAL(0, histogramBucket(1));
+  CHECK_EQUAL(1, histogramBucket(2));
+  CHECK_EQUAL(1, histogramBucket(3));
+  CHECK_EQUAL(2, histogramBucket(4));
+  CHECK_EQUAL(9, histogramBucket(1023));
+  CHECK_EQUAL(10, histogramBucket(1024));
+  CHECK_EQUAL(INSTRUMENTATION_BUCKETS - 1, histogramBucket(0xFFFFFFFFUL));
+}
+
+TEST(histograms_count_and_saturate)
+{
+  timing_histogram histogram;
+  histogramClear(histogram);
+  histogramAdd(histogram, 3);
+  histogramAdd(histogram, 5);
+  histogramAdd(histogram, 40);
+  CHECK_EQUAL(3UL, histogram.count);
+  CHECK_EQUAL(48UL, histogram.total);
+  CHECK_EQUAL(40UL, histogram.maximum);
+
+  char line[INSTRUMENTATION_LINE_SIZE];
+  histogramFormat(line, sizeof(line), "raw", histogram);
+  CHECK(strcmp(line, "raw n=3 avg=16 max=40 | 0 1 1 0 0 1") == 0);
+
+  for(long i = 0; i < 70000; i++)
+  {
+    histogramAdd(histogram, 1);
+  }
+  CHECK_EQUAL(0xFFFF, histogram.buckets[0]);
+  CHECK_EQUAL(70003UL, histogram.count);
+
+  histogramClear(histogram);
+  histogramFormat(line, sizeof(line), "raw", histogram);
+  CHECK(strcmp(line, "raw n=0 avg=0 max=0 |") == 0);
+}
+
+TEST(sensors_time_each_stage)
+{
+  HostStream first;
+  HostStream second;
+  HostSim::setAnalog(A0_PIN, 512);
+  HostSim::setAnalogReadMicros(10);
+  Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+  light.streamAdd(first);
+  light.streamAdd(second);
+
+  light.printAll();
+  const sensor_instrumentation& timings = light.getInstrumentation();
+  CHECK_EQUAL(1UL, timings.rawInput.count);
+  CHECK_EQUAL(10UL * light.samplesPerReading(), timings.rawInput.total);
+  CHECK_EQUAL(1UL, timings.conversion.count);
+  CHECK_EQUAL(1UL, timings.format.count);
+  CHECK_EQUAL(1UL, timings.output[0].count);
+  CHECK_EQUAL(1UL, timings.output[1].count);
+  CHECK_EQUAL(0UL, timings.output[2].count);
+
+  light.printReading(1);
+  CHECK_EQUAL(2UL, timings.rawInput.count);
+  CHECK_EQUAL(1UL, timings.output[0].count);
+  CHECK_EQUAL(2UL, timings.output[1].count);
+
+  /* Binary frames are the output of their stream as well */
+  light.setOutputMode(OUTPUT_BINARY);
+  light.printReading(0);
+  CHECK_EQUAL(3UL, timings.output[0].count);
+
+  light.resetInstrumentation();
+  CHECK_EQUAL(0UL, timings.rawInput.count);
+  CHECK_EQUAL(0UL, timings.output[1].count);
+}
+
+TEST(every_reading_path_times_its_conversion)
+{
+  HostSim::setAnalog(A0_PIN, 350);
+  sensor_params params = { 1, 0, 0, 1, 3, {0.0, 50.0, 100.0}, "EC", "uS", 1, &basicAnalogicReading, {} };
+  Sensor ec(A0_PIN, params, NULL);
+  float raw[] = { 100, 300, 900 };
+  ec.setCalibrationModel(CALIBRATION_PIECEWISE);
+  CHECK(ec.fitCalibration(raw));
+  const sensor_instrumentation& timings = ec.getInstrumentation();
+
+  ec.collectInput();
+  CHECK_EQUAL(1UL, timings.conversion.count);
+
+  /* Conversions that aren't readings, e.g. those shown during a calibration, are not */
+  ec.convertInput(350);
+  CHECK_EQUAL(1UL, timings.conversion.count);
+
+  CHECK(ec.useCalibrationTable(true));
+  ec.collectInput();
+  CHECK_EQUAL(2UL, timings.conversion.count);
+}
+
+TEST(raw_readings_of_other_functions_are_timed)
+{
+  HostSim::setDht(DHT_PIN, 21.0, 40.0);
+  HostSim::setDhtTransactionMillis(25);
+  Sensor hygrometer(DHT_PIN, HYGROMETER, "Hum");
+
+  hygrometer.collectRawInput();
+  const sensor_instrumentation& timings = hygrometer.getInstrumentation();
+  CHECK_EQUAL(1UL, timings.rawInput.count);
+  CHECK(timings.rawInput.maximum >= 25000UL);
+  CHECK_EQUAL(0UL, timings.conversion.count);
+}
+
+TEST(the_report_goes_to_any_channel)
+{
+  HostStream serial;
+  HostStream console;
+  HostSim::setAnalog(A0_PIN, 512);
+  HostSim::setAnalogReadMicros(10);
+  Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+  light.streamAdd(serial);
+  light.printAll();
+
+  int handle = StreamRegistry::open(console);
+  light.reportInstrumentation(handle);
+  CHECK(console.output().find("Light timings\r\n") == 0);
+  CHECK(console.output().find("\r\nformat n=1 avg=0 max=0 | 1\r\n") != std::string::npos);
+  CHECK(console.output().find("\r\nstream 0 n=1 ") != std::string::npos);
+  CHECK(console.output().find("stream 1") == std::string::npos);
+
+  /* The report itself is not timed */
+  CHECK_EQUAL(1UL, light.getInstrumentation().output[0].count);
+  CHECK(serial.output().find("timings") == std::string::npos);
+  StreamRegistry::close(handle);
+}
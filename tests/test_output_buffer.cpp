@@ -0,0 +1,172 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "OutputBuffer.h"
+#include "StreamRegistry.h"
+
+#define A0_PIN 14
+
+static void fill(OutputBuffer& buffer, const char* text)
+{
+  buffer.write((const byte*)text, strlen(text));
+}
+
+static void writeChar(String s)
+{
+}
+
+TEST(bytes_are_due_between_the_watermarks)
+{
+  OutputBuffer buffer;
+  buffer.configure(OUTPUT_DROP_NEWEST, 4, 10, 1000);
+  fill(buffer, "abcdefgh");
+  CHECK(!buffer.due());
+
+  fill(buffer, "ij");
+  CHECK(buffer.due());
+  int sent = 0;
+  while(buffer.due())
+  {
+    CHECK_EQUAL('a' + sent, buffer.take());
+    sent++;
+  }
+  CHECK_EQUAL(6, sent);
+  CHECK_EQUAL(4U, buffer.level());
+
+  /* The rest goes once it has waited maxDelay, or on a flush */
+  delay(999);
+  CHECK(!buffer.due());
+  delay(1);
+  CHECK(buffer.due());
+  buffer.take();
+  buffer.flush();
+  while(buffer.due())
+  {
+    buffer.take();
+  }
+  CHECK_EQUAL(0U, buffer.level());
+  CHECK_EQUAL(-1, buffer.take());
+}
+
+TEST(overflow_drops_and_counts_bytes)
+{
+  byte data[OUTPUT_BUFFER_SIZE + 10];
+  for(int i = 0; i < OUTPUT_BUFFER_SIZE + 10; i++)
+  {
+    data[i] = (byte)i;
+  }
+
+  OutputBuffer buffer;
+  buffer.configure(OUTPUT_DROP_NEWEST, 0, 0, 0);
+  CHECK_EQUAL((size_t)buffer.capacity(), buffer.write(data, sizeof(data)));
+  CHECK_EQUAL(11UL, buffer.dropped());
+  CHECK_EQUAL(0, buffer.take());
+
+  buffer.configure(OUTPUT_DROP_OLDEST, 0, 0, 0);
+  CHECK_EQUAL(sizeof(data), buffer.write(data, sizeof(data)));
+  CHECK_EQUAL(11UL, buffer.dropped());
+  CHECK_EQUAL(11, buffer.take());
+
+  /* Blocking writes stop when full, the writer sends bytes and goes on */
+  buffer.configure(OUTPUT_BLOCK, 0, 0, 0);
+  CHECK_EQUAL((size_t)buffer.capacity(), buffer.write(data, sizeof(data)));
+  CHECK_EQUAL(0UL, buffer.dropped());
+}
+
+TEST(buffered_channels_are_written_by_drain)
+{
+  HostStream serial;
+  HostSim::setAnalog(A0_PIN, 12);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  sensor.streamAdd(serial);
+  int handle = sensor.getStreamHandle(0);
+  CHECK(StreamRegistry::setBuffered(handle, OUTPUT_DROP_NEWEST, 0, 32, 100));
+
+  /* Lines are copied, and coalesced until the high watermark */
+  sensor.printAll();
+  sensor.printAll();
+  CHECK(serial.output().empty());
+  CHECK_EQUAL(30U, StreamRegistry::buffer(handle)->level());
+  StreamRegistry::drain();
+  CHECK(serial.output().empty());
+
+  sensor.printAll();
+  StreamRegistry::drain();
+  CHECK_EQUAL((size_t)OUTPUT_DRAIN_BUDGET, serial.output().size());
+  while(StreamRegistry::drain(handle, 1) > 0) { }
+  CHECK(serial.output() == "Light  : 12xx\r\nLight  : 12xx\r\nLight  : 12xx\r\n");
+
+  /* Closing the channel sends what is left */
+  sensor.printReading(0);
+  StreamRegistry::setUnbuffered(handle);
+  CHECK(StreamRegistry::buffer(handle) == NULL);
+  CHECK_EQUAL(4 * 15U, serial.output().size());
+}
+
+TEST(drain_budgets_bound_each_pass)
+{
+  HostStream serial;
+  int handle = StreamRegistry::open(serial);
+  CHECK(StreamRegistry::setBuffered(handle, OUTPUT_DROP_NEWEST, 0, 1, 100));
+  StreamRegistry::print(handle, "0123456789");
+
+  /* A lower byte budget, e.g. for SoftwareSerial */
+  StreamRegistry::setDrainBudget(handle, 3);
+  StreamRegistry::drain();
+  CHECK(serial.output() == "012");
+
+  /* Only the free TX room: nothing while the sink is full */
+  StreamRegistry::setDrainBudget(handle, DRAIN_TX_ROOM);
+  StreamRegistry::drain();
+  CHECK(serial.output() == "012");
+  serial.setTxRoom(4);
+  StreamRegistry::drain();
+  CHECK(serial.output() == "0123456");
+
+  StreamRegistry::close(handle);
+  CHECK(serial.output() == "0123456789");
+}
+
+TEST(blocking_channels_write_through_when_full)
+{
+  HostStream serial;
+  int handle = StreamRegistry::open(serial);
+  CHECK(StreamRegistry::setBuffered(handle, OUTPUT_BLOCK, 0, OUTPUT_BUFFER_SIZE, 1000));
+  char line[OUTPUT_BUFFER_SIZE + 1];
+  memset(line, 'x', OUTPUT_BUFFER_SIZE);
+  line[OUTPUT_BUFFER_SIZE] = 0;
+
+  StreamRegistry::print(handle, line);
+  CHECK_EQUAL(1U, serial.output().size());
+  CHECK_EQUAL(0UL, StreamRegistry::buffer(handle)->dropped());
+  StreamRegistry::close(handle);
+  CHECK_EQUAL((size_t)OUTPUT_BUFFER_SIZE, serial.output().size());
+}
+
+TEST(buffers_are_a_limited_pool)
+{
+  HostStream streams[MAX_OUTPUT_BUFFERS + 1];
+  int handles[MAX_OUTPUT_BUFFERS + 1];
+  for(int i = 0; i <= MAX_OUTPUT_BUFFERS; i++)
+  {
+    handles[i] = StreamRegistry::open(streams[i]);
+  }
+  for(int i = 0; i < MAX_OUTPUT_BUFFERS; i++)
+  {
+    CHECK(StreamRegistry::setBuffered(handles[i], OUTPUT_DROP_OLDEST, 0, 8, 10));
+  }
+  CHECK(!StreamRegistry::setBuffered(handles[MAX_OUTPUT_BUFFERS], OUTPUT_DROP_OLDEST, 0, 8, 10));
+
+  StreamRegistry::setUnbuffered(handles[0]);
+  CHECK(StreamRegistry::setBuffered(handles[MAX_OUTPUT_BUFFERS], OUTPUT_DROP_OLDEST, 0, 8, 10));
+
+  /* Callbacks are not buffered */
+  int callback = StreamRegistry::open(streams[0], &writeChar);
+  CHECK(!StreamRegistry::setBuffered(callback, OUTPUT_DROP_OLDEST, 0, 8, 10));
+  StreamRegistry::close(callback);
+
+  for(int i = 0; i <= MAX_OUTPUT_BUFFERS; i++)
+  {
+    StreamRegistry::close(handles[i]);
+  }
+  CHECK_EQUAL(0, StreamRegistry::channelsInUse());
+}
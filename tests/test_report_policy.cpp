@@ -0,0 +1,117 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "ReportPolicy.h"
+
+#define A0_PIN 14
+
+static report_state emptyState()
+{
+  report_state state;
+  memset(&state, 0, sizeof(state));
+  return state;
+}
+
+TEST(every_reading_is_sent_by_default)
+{
+  report_policy policy = { REPORT_ALWAYS, 0, 0, 0, 0, 0 };
+  report_state state = emptyState();
+  CHECK(reportDue(policy, state, 1.0, 0));
+  CHECK(reportDue(policy, state, 1.0, 10));
+  CHECK_EQUAL(2UL, state.sent);
+  CHECK_EQUAL(0UL, state.suppressed);
+}
+
+TEST(changes_within_the_deadband_are_held_back)
+{
+  report_policy policy = { REPORT_ON_CHANGE, 0.5, 0.1, 0, 0, 0 };
+  report_state state = emptyState();
+  CHECK(reportDue(policy, state, 2.0, 0));
+
+  /* Absolute band of 0.5 around 2.0, larger than 10% of it */
+  CHECK(!reportDue(policy, state, 2.4, 1000));
+  CHECK(!reportDue(policy, state, 1.6, 2000));
+  CHECK(reportDue(policy, state, 2.6, 3000));
+
+  /* Around 20.0 the relative band of 2.0 applies, from the value sent */
+  CHECK(reportDue(policy, state, 20.0, 4000));
+  CHECK(!reportDue(policy, state, 21.5, 5000));
+  CHECK(!reportDue(policy, state, 18.5, 6000));
+  CHECK(reportDue(policy, state, 22.5, 7000));
+  CHECK_EQUAL(4UL, state.sent);
+  CHECK_EQUAL(4UL, state.suppressed);
+
+  /* Without bands any change is sent */
+  report_policy anyChange = { REPORT_ON_CHANGE, 0, 0, 0, 0, 0 };
+  CHECK(!reportDue(anyChange, state, 22.5, 8000));
+  CHECK(reportDue(anyChange, state, 22.51, 9000));
+}
+
+TEST(intervals_bound_the_reports)
+{
+  report_policy policy = { REPORT_ON_CHANGE, 1.0, 0, 0, 5000, 60000 };
+  report_state state = emptyState();
+  CHECK(reportDue(policy, state, 10.0, 0));
+
+  /* No report within minInterval, even of a large change */
+  CHECK(!reportDue(policy, state, 50.0, 4999));
+  CHECK(reportDue(policy, state, 50.0, 5000));
+
+  /* Heartbeat of a steady value */
+  CHECK(!reportDue(policy, state, 50.0, 64999));
+  CHECK(reportDue(policy, state, 50.0, 65000));
+  CHECK_EQUAL(65000UL, state.reportedTime);
+}
+
+TEST(fast_changes_fire_within_the_deadband)
+{
+  report_policy policy = { REPORT_ON_CHANGE, 5.0, 0, 1.0, 0, 0 };
+  report_state state = emptyState();
+  CHECK(reportDue(policy, state, 0.0, 0));
+
+  /* 0.5 per second: slow drift stays in the band */
+  CHECK(!reportDue(policy, state, 0.5, 1000));
+  CHECK(!reportDue(policy, state, 1.0, 2000));
+
+  /* 3 per second since the previous reading */
+  CHECK(reportDue(policy, state, 1.3, 2100));
+  CHECK_CLOSE(1.3, state.reportedValue, 1e-6);
+
+  reportReset(state);
+  CHECK(reportDue(policy, state, 1.3, 2200));
+  CHECK_EQUAL(3UL, state.sent);
+}
+
+TEST(print_all_sends_only_the_readings_that_fire)
+{
+  HostStream serial;
+  HostSim::setAnalog(A0_PIN, 500);
+  Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+  light.streamAdd(serial);
+  report_policy policy = { REPORT_ON_CHANGE, 10, 0, 0, 0, 0 };
+  light.setReportPolicy(policy);
+  CHECK_EQUAL(REPORT_ON_CHANGE, light.getReportPolicy().mode);
+
+  light.printAll();
+  HostSim::setAnalog(A0_PIN, 505);
+  light.printAll();
+  light.printAll();
+  HostSim::setAnalog(A0_PIN, 520);
+  light.printAll();
+  CHECK(serial.output() == "Light  : 500xx\r\nLight  : 520xx\r\n");
+  CHECK_EQUAL(2UL, light.getReportsSent());
+  CHECK_EQUAL(2UL, light.getReportsSuppressed());
+
+  /* Held back readings are still taken */
+  CHECK_EQUAL(4U, light.getLastReadings().size());
+
+  /* A new policy sends the next reading, binary frames as well */
+  light.setOutputMode(OUTPUT_BINARY);
+  light.setReportPolicy(policy);
+  serial.clearOutput();
+  light.printAll();
+  CHECK(serial.output().size() > 0);
+  serial.clearOutput();
+  light.printAll();
+  CHECK(serial.output().size() == 0);
+  CHECK_EQUAL(3UL, light.getReportsSuppressed());
+}
@@ -0,0 +1,83 @@
+#include "SensorTest.h"
+#include "RingBuffer.h"
+
+TEST(empty_buffer)
+{
+  RingBuffer<int, 4> buffer;
+  CHECK(buffer.empty());
+  CHECK_EQUAL(0U, buffer.size());
+  CHECK_EQUAL(4U, buffer.capacity());
+  CHECK(buffer.begin() == buffer.end());
+}
+
+TEST(indexes_from_oldest_to_newest)
+{
+  RingBuffer<int, 4> buffer;
+  buffer.push(1);
+  buffer.push(2);
+  buffer.push(3);
+  CHECK_EQUAL(3U, buffer.size());
+  CHECK_EQUAL(1, buffer[0]);
+  CHECK_EQUAL(3, buffer[2]);
+  CHECK_EQUAL(1, buffer.oldest());
+  CHECK_EQUAL(3, buffer.newest());
+}
+
+TEST(full_buffer_drops_the_oldest)
+{
+  RingBuffer<int, 4> buffer;
+  for(int i = 1; i <= 10; i++)
+  {
+    buffer.push(i);
+  }
+  CHECK(buffer.full());
+  CHECK_EQUAL(10UL, buffer.pushes());
+  CHECK_EQUAL(7, buffer[0]);
+  CHECK_EQUAL(8, buffer[1]);
+  CHECK_EQUAL(9, buffer[2]);
+  CHECK_EQUAL(10, buffer[3]);
+}
+
+TEST(iterates_in_place_from_oldest_to_newest)
+{
+  RingBuffer<int, 5> buffer;
+  for(int i = 1; i <= 7; i++)
+  {
+    buffer.push(i);
+  }
+  int expected = 3;
+  for(const int& value : buffer)
+  {
+    CHECK_EQUAL(expected, value);
+    expected++;
+  }
+  CHECK_EQUAL(8, expected);
+}
+
+TEST(snapshot_is_not_extended_by_later_pushes)
+{
+  RingBuffer<int, 8> buffer;
+  buffer.push(1);
+  buffer.push(2);
+  RingBuffer<int, 8>::Snapshot snapshot = buffer.snapshot();
+  buffer.push(3);
+  CHECK_EQUAL(2U, snapshot.size());
+  int count = 0;
+  for(const int& value : snapshot)
+  {
+    count++;
+    CHECK(value <= 2);
+  }
+  CHECK_EQUAL(2, count);
+  CHECK_EQUAL(3U, buffer.size());
+}
+
+TEST(clear_empties_the_buffer)
+{
+  RingBuffer<float, 3> buffer;
+  buffer.push(1.5);
+  buffer.clear();
+  CHECK(buffer.empty());
+  buffer.push(2.5);
+  CHECK_CLOSE(2.5, buffer.newest(), 1e-6);
+}
@@ -0,0 +1,132 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "RollupHistory.h"
+
+#define A0_PIN 14
+#define MINUTE 60000UL
+#define HOUR 3600000UL
+
+TEST(readings_roll_up_per_minute_and_hour)
+{
+  RollupHistory* history = RollupHistory::acquire();
+  CHECK(history != NULL);
+  CHECK_EQUAL(MINUTE, history->period(0));
+  CHECK_EQUAL(HOUR, history->period(1));
+
+  /* A reading every 10 s for two hours and a minute, its value the minute it was taken */
+  for(unsigned long t = 0; t <= 2 * HOUR + MINUTE; t += 10000)
+  {
+    history->add(t / MINUTE, t);
+  }
+
+  CHECK_EQUAL((unsigned int)ROLLUP_SLOTS, history->buckets(0).size());
+  CHECK_EQUAL(121UL, history->buckets(0).pushes());
+  const rollup_bucket& minute = history->buckets(0).newest();
+  CHECK_EQUAL(120 * MINUTE, minute.start);
+  CHECK_EQUAL(6UL, minute.count);
+  CHECK_CLOSE(120, rollupMean(minute), 1e-4);
+
+  /* Hours close once a minute of the next one is closed */
+  CHECK_EQUAL(2U, history->buckets(1).size());
+  const rollup_bucket& hour = history->buckets(1).oldest();
+  CHECK_EQUAL(0UL, hour.start);
+  CHECK_EQUAL(360UL, hour.count);
+  CHECK_CLOSE(0, hour.minimum, 1e-4);
+  CHECK_CLOSE(59, hour.maximum, 1e-4);
+  CHECK_CLOSE(29.5, rollupMean(hour), 1e-4);
+
+  /* The reading of the last minute is still open */
+  CHECK_EQUAL(1UL, history->open(0).count);
+  CHECK_EQUAL(121 * MINUTE, history->open(0).start);
+  RollupHistory::release(history);
+}
+
+TEST(queries_read_the_coarsest_tier_that_fits)
+{
+  RollupHistory* history = RollupHistory::acquire();
+  for(unsigned long t = 0; t < 3 * HOUR; t += 30000)
+  {
+    history->add(t < HOUR ? 10 : 20, t);
+  }
+
+  rollup_bucket result;
+  CHECK_EQUAL(1, history->query(0, 2 * HOUR, &result));
+  CHECK_EQUAL(240UL, result.count);
+  CHECK_CLOSE(15, rollupMean(result), 1e-4);
+
+  /* Minutes for bounds within an hour, still kept at that resolution */
+  CHECK_EQUAL(0, history->query(2 * HOUR + 30 * MINUTE, 3 * HOUR, &result));
+  CHECK_EQUAL(60UL, result.count);
+
+  /* The last hour is in the open buckets, not merged into the hour tier yet */
+  CHECK_EQUAL(1, history->query(2 * HOUR, 3 * HOUR, &result));
+  CHECK_EQUAL(120UL, result.count);
+  CHECK_CLOSE(20, result.minimum, 1e-4);
+
+  /* Minutes dropped from the finest tier: the hours answer, at their resolution */
+  CHECK_EQUAL(1, history->query(10 * MINUTE, 20 * MINUTE, &result));
+  CHECK_EQUAL(120UL, result.count);
+
+  CHECK_EQUAL(-1, history->query(5 * HOUR, 6 * HOUR, &result));
+  CHECK_EQUAL(0UL, result.count);
+  RollupHistory::release(history);
+}
+
+TEST(periods_nest_and_the_pool_is_fixed)
+{
+  RollupHistory* history = RollupHistory::acquire();
+  CHECK(!history->setPeriod(0, 7 * MINUTE));
+  CHECK(!history->setPeriod(1, 90000));
+  CHECK(!history->setPeriod(ROLLUP_TIERS, MINUTE));
+  CHECK(history->setPeriod(0, 10000));
+  CHECK(history->setPeriod(1, MINUTE));
+  history->add(1, 0);
+  history->add(2, 10000);
+  CHECK_EQUAL(1U, history->buckets(0).size());
+
+  RollupHistory* others[MAX_ROLLUP_HISTORIES];
+  for(int i = 1; i < MAX_ROLLUP_HISTORIES; i++)
+  {
+    others[i] = RollupHistory::acquire();
+    CHECK(others[i] != NULL);
+  }
+  CHECK(RollupHistory::acquire() == NULL);
+  CHECK_EQUAL(MAX_ROLLUP_HISTORIES, RollupHistory::historiesInUse());
+  for(int i = 1; i < MAX_ROLLUP_HISTORIES; i++)
+  {
+    RollupHistory::release(others[i]);
+  }
+  RollupHistory::release(history);
+
+  /* Histories are given back empty, with the default periods */
+  history = RollupHistory::acquire();
+  CHECK_EQUAL(MINUTE, history->period(0));
+  CHECK_EQUAL(0U, history->buckets(0).size());
+  CHECK_EQUAL(0UL, history->open(0).count);
+  RollupHistory::release(history);
+}
+
+TEST(sensors_keep_their_readings_in_a_history)
+{
+  HostSim::setAnalog(A0_PIN, 400);
+  {
+    Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+    CHECK(light.getRollup() == NULL);
+    CHECK(light.setRollup(true));
+    CHECK_EQUAL(1, RollupHistory::historiesInUse());
+
+    for(int i = 0; i < 90; i++)
+    {
+      light.collectInput();
+      HostSim::advanceMillis(1000);
+    }
+
+    rollup_bucket result;
+    unsigned long now = millis();
+    CHECK(light.getRollup()->query(0, now, &result) >= 0);
+    CHECK_EQUAL(90UL, result.count);
+    CHECK_CLOSE(400, rollupMean(result), 1e-3);
+    CHECK_EQUAL(1U, light.getRollup()->buckets(0).size());
+  }
+  CHECK_EQUAL(0, RollupHistory::historiesInUse());
+}
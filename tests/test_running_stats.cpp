@@ -0,0 +1,127 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "RunningStats.h"
+
+#define A0_PIN 14
+#define WINDOW 8
+
+/* Pushes value in the window and in its statistics, like Sensor does */
+static void record(RingBuffer<float, WINDOW>& window, RunningStats<WINDOW>& stats, float value)
+{
+  stats.push(value);
+  window.push(value);
+}
+
+static void checkAgainstWindow(const RingBuffer<float, WINDOW>& window, const RunningStats<WINDOW>& stats)
+{
+  double sum = 0;
+  float minimum = window[0];
+  float maximum = window[0];
+  for(const float& value : window)
+  {
+    sum += value;
+    minimum = value < minimum ? value : minimum;
+    maximum = value > maximum ? value : maximum;
+  }
+  double mean = sum / window.size();
+  double m2 = 0;
+  for(const float& value : window)
+  {
+    m2 += (value - mean) * (value - mean);
+  }
+
+  CHECK_EQUAL(window.size(), stats.count());
+  CHECK_CLOSE(mean, stats.mean(), 1e-3);
+  if(window.size() > 1)
+  {
+    CHECK_CLOSE(m2 / (window.size() - 1), stats.variance(), 1e-2);
+  }
+  CHECK_EQUAL(minimum, stats.minimum());
+  CHECK_EQUAL(maximum, stats.maximum());
+}
+
+TEST(empty_statistics)
+{
+  RingBuffer<float, WINDOW> window;
+  RunningStats<WINDOW> stats;
+  stats.attach(&window);
+  CHECK_EQUAL(0U, stats.count());
+  CHECK(isnan(stats.mean()));
+  CHECK(isnan(stats.minimum()));
+  CHECK(isnan(stats.ewma()));
+  CHECK_CLOSE(0.0, stats.variance(), 1e-9);
+}
+
+TEST(statistics_match_recomputation_over_sliding_window)
+{
+  RingBuffer<float, WINDOW> window;
+  RunningStats<WINDOW> stats;
+  stats.attach(&window);
+
+  /* Deterministic pseudo-random walk, long enough to wrap positions and resync several times */
+  unsigned long seed = 12345;
+  float value = 500;
+  for(int i = 0; i < 3000; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    value += (float)((seed >> 16) % 201) - 100;
+    record(window, stats, value);
+    checkAgainstWindow(window, stats);
+  }
+}
+
+TEST(monotonic_sequences)
+{
+  RingBuffer<float, WINDOW> window;
+  RunningStats<WINDOW> stats;
+  stats.attach(&window);
+  for(int i = 0; i < 20; i++)
+  {
+    record(window, stats, i);
+    checkAgainstWindow(window, stats);
+  }
+  for(int i = 20; i > 0; i--)
+  {
+    record(window, stats, i);
+    checkAgainstWindow(window, stats);
+  }
+  for(int i = 0; i < 20; i++)
+  {
+    record(window, stats, 7);
+    checkAgainstWindow(window, stats);
+  }
+  CHECK_CLOSE(0.0, stats.variance(), 1e-6);
+}
+
+TEST(ewma_weights_newest_value)
+{
+  RingBuffer<float, WINDOW> window;
+  RunningStats<WINDOW> stats;
+  stats.attach(&window);
+  stats.setEwmaAlpha(0.5);
+  record(window, stats, 10);
+  CHECK_CLOSE(10.0, stats.ewma(), 1e-6);
+  record(window, stats, 20);
+  CHECK_CLOSE(15.0, stats.ewma(), 1e-6);
+  record(window, stats, 20);
+  CHECK_CLOSE(17.5, stats.ewma(), 1e-6);
+}
+
+TEST(sensor_exposes_window_statistics)
+{
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  sensor.setEwmaAlpha(1.0);
+  for(int i = 1; i <= MAX_LAST_READINGS + 10; i++)
+  {
+    HostSim::setAnalog(A0_PIN, i);
+    sensor.collectInput();
+  }
+
+  /* The window holds 11 .. 30 */
+  CHECK_CLOSE(20.5, sensor.getMean(), 1e-4);
+  CHECK_CLOSE(35.0, sensor.getVariance(), 1e-3);
+  CHECK_CLOSE(sqrt(35.0), sensor.getStandardDeviation(), 1e-4);
+  CHECK_CLOSE(11.0, sensor.getMinimum(), 1e-6);
+  CHECK_CLOSE(30.0, sensor.getMaximum(), 1e-6);
+  CHECK_CLOSE(30.0, sensor.getEwma(), 1e-6);
+}
@@ -0,0 +1,196 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "DhtCache.h"
+
+#define A0_PIN   14
+#define DHT_PIN  2
+
+TEST(raw_input_is_the_average_of_num_readings)
+{
+  int trace[] = { 100, 200, 300, 400, 500, 600, 700, 800, 900, 1000 };
+  HostSim::scriptAnalog(A0_PIN, trace, 10);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, NULL);
+  CHECK_CLOSE(550.0, sensor.collectRawInput(), 1e-4);
+  CHECK_EQUAL(10UL, HostSim::analogReads(A0_PIN));
+  CHECK_EQUAL(INPUT, HostSim::pinModeOf(A0_PIN));
+}
+
+TEST(collect_input_applies_linear_conversion)
+{
+  HostSim::setAnalog(A0_PIN, 500);
+  Sensor sensor(A0_PIN, SOIL_MOISTURE_METER, NULL);
+  CHECK_CLOSE(-0.0273 * 500 + 19.655, sensor.collectInput(), 1e-3);
+  CHECK_CLOSE(-0.0273, sensor.getSlope(), 1e-6);
+  CHECK_CLOSE(19.655, sensor.getIntercept(), 1e-6);
+}
+
+TEST(custom_params_constructor)
+{
+  sensor_params params = { 2, 1, 100, 4, 2, {0.0, 10.0}, "Custom", "u", 1, &basicAnalogicReading, {} };
+  HostSim::setAnalog(A0_PIN, 10);
+  Sensor sensor(A0_PIN, params, "Mine");
+  CHECK_CLOSE(21.0, sensor.collectInput(), 1e-4);
+  CHECK_EQUAL(4UL, HostSim::analogReads(A0_PIN));
+  CHECK(strcmp("Mine", sensor.getLabel()) == 0);
+  CHECK(strcmp("u", sensor.getMeasureUnit()) == 0);
+}
+
+TEST(label_defaults_to_type_name)
+{
+  Sensor sensor(A0_PIN, CO_SENSOR, NULL);
+  CHECK(strcmp("CO sensor", sensor.getLabel()) == 0);
+}
+
+TEST(dht_sensors_read_the_fake_device)
+{
+  DhtCache::clear();
+  HostSim::setDht(DHT_PIN, 23.0, 48.0);
+  Sensor hygrometer(DHT_PIN, HYGROMETER, "Hum");
+  CHECK_CLOSE(48.0, hygrometer.collectRawInput(), 1e-6);
+
+  delay(1000);
+  Sensor thermometer(DHT_PIN, AIR_THERMOMETER, "Temp");
+  CHECK_CLOSE(23.0, thermometer.collectRawInput(), 1e-6);
+}
+
+TEST(formatted_reading)
+{
+  HostSim::setAnalog(A0_PIN, 250);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  CHECK(sensor.formattedReading() == "Light  : 250xx");
+}
+
+TEST(stream_add_does_not_wait_for_the_stream)
+{
+  HostStream streams[MAX_IO_STREAMS + 1];
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  unsigned long start = millis();
+  for(int i = 0; i < MAX_IO_STREAMS; i++)
+  {
+    CHECK_EQUAL(i, sensor.streamAdd(streams[i]));
+    CHECK_EQUAL(STREAM_UNTESTED, sensor.getStreamStatus(i));
+    CHECK(streams[i].output().empty());
+  }
+  CHECK_EQUAL(0UL, millis() - start);
+  CHECK_EQUAL(-1, sensor.streamAdd(streams[MAX_IO_STREAMS]));
+  CHECK_EQUAL(STREAM_NONE, sensor.getStreamStatus(MAX_IO_STREAMS));
+}
+
+TEST(stream_test_runs_in_the_background)
+{
+  HostStream first;
+  HostStream second;
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  sensor.streamAdd(first);
+  sensor.streamAdd(second);
+
+  CHECK(sensor.streamTestBegin(0));
+  CHECK(!sensor.streamTestBegin(1));
+  CHECK_EQUAL(STREAM_TESTING, sensor.getStreamStatus(0));
+  CHECK(!sensor.streamTestPoll());
+  first.feed("xc");
+  CHECK(!sensor.streamTestPoll());
+  CHECK(sensor.streamTestPoll());
+  CHECK_EQUAL(STREAM_OK, sensor.getStreamStatus(0));
+  CHECK(first.output().find("xcTesting of stream 0 complete.") != std::string::npos);
+
+  /* A silent stream times out */
+  CHECK(sensor.streamTestBegin(1));
+  unsigned long start = millis();
+  while(!sensor.streamTestPoll())
+  {
+    delay(1);
+  }
+  CHECK_EQUAL((unsigned long)STREAM_TEST_TIMEOUT, millis() - start);
+  CHECK_EQUAL(STREAM_TIMEOUT, sensor.getStreamStatus(1));
+  CHECK(!sensor.streamTestPoll());
+}
+
+TEST(print_all_writes_every_stream)
+{
+  HostStream first;
+  HostStream second;
+  HostSim::setAnalog(A0_PIN, 12);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  sensor.streamAdd(first);
+  sensor.streamAdd(second);
+  first.clearOutput();
+  second.clearOutput();
+
+  sensor.printAll();
+  CHECK(first.output() == "Light  : 12xx\r\n");
+  CHECK(second.output() == "Light  : 12xx\r\n");
+}
+
+TEST(print_all_does_one_acquisition_for_all_streams)
+{
+  HostStream first;
+  HostStream second;
+  HostStream third;
+  int trace[30];
+  for(int i = 0; i < 30; i++)
+  {
+    trace[i] = 10 * i;
+  }
+  HostSim::scriptAnalog(A0_PIN, trace, 30);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  sensor.streamAdd(first);
+  sensor.streamAdd(second);
+  sensor.streamAdd(third);
+  first.clearOutput();
+  second.clearOutput();
+  third.clearOutput();
+
+  sensor.printAll();
+  CHECK_EQUAL(10UL, HostSim::analogReads(A0_PIN));
+  CHECK(first.output() == "Light  : 45xx\r\n");
+  CHECK(second.output() == first.output());
+  CHECK(third.output() == first.output());
+}
+
+TEST(collect_input_with_max_age_reuses_fresh_readings)
+{
+  HostSim::setAnalog(A0_PIN, 100);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+
+  CHECK_CLOSE(100.0, sensor.collectInput(1000), 1e-4);
+  CHECK_EQUAL(10UL, HostSim::analogReads(A0_PIN));
+  CHECK_EQUAL(0UL, sensor.getLastReadingTime());
+
+  HostSim::setAnalog(A0_PIN, 200);
+  delay(1000);
+  CHECK_CLOSE(100.0, sensor.collectInput(1000), 1e-4);
+  CHECK_EQUAL(10UL, HostSim::analogReads(A0_PIN));
+
+  delay(1);
+  CHECK_CLOSE(200.0, sensor.collectInput(1000), 1e-4);
+  CHECK_EQUAL(20UL, HostSim::analogReads(A0_PIN));
+  CHECK_EQUAL(1001UL, sensor.getLastReadingTime());
+  CHECK_CLOSE(200.0, sensor.getLastValue(), 1e-4);
+
+  /* A max age of zero only reuses a reading taken in the same millisecond */
+  CHECK_CLOSE(200.0, sensor.collectInput(0), 1e-4);
+  CHECK_EQUAL(20UL, HostSim::analogReads(A0_PIN));
+}
+
+TEST(collect_input_records_readings_history)
+{
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  CHECK(sensor.getLastReadings().empty());
+
+  for(int i = 0; i < MAX_LAST_READINGS + 5; i++)
+  {
+    HostSim::setAnalog(A0_PIN, i);
+    sensor.collectInput();
+  }
+
+  const RingBuffer<float, MAX_LAST_READINGS>& history = sensor.getLastReadings();
+  CHECK_EQUAL((unsigned int)MAX_LAST_READINGS, history.size());
+  float expected = 5;
+  for(const float& value : history)
+  {
+    CHECK_CLOSE(expected, value, 1e-4);
+    expected++;
+  }
+  CHECK_CLOSE(MAX_LAST_READINGS + 4, history.newest(), 1e-4);
+}
@@ -0,0 +1,129 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "SensorFilter.h"
+
+#define A0_PIN 14
+
+static sensor_params gasParams(short int numReadings, sensor_filter filter)
+{
+  sensor_params params = { 1, 0, 0, numReadings, 2, {0.0, 100.0}, "Gas", "ppm", 1, &basicAnalogicReading, filter };
+  return params;
+}
+
+TEST(median_ignores_a_spike)
+{
+  int trace[] = { 100, 101, 900, 99, 100 };
+  HostSim::scriptAnalog(A0_PIN, trace, 5);
+  sensor_filter median = { FILTER_MEDIAN, 0, 0, 0 };
+  Sensor gas(A0_PIN, gasParams(5, median), NULL);
+  CHECK_CLOSE(100, gas.collectInput(), 0);
+
+  /* Even counts average the two middle samples */
+  uint16_t samples[] = { 7, 1, 4, 2 };
+  long sum;
+  short int divisor;
+  filterSamples(median, samples, 4, &sum, &divisor);
+  CHECK_EQUAL(6L, sum);
+  CHECK_EQUAL(2, divisor);
+}
+
+TEST(trimmed_mean_drops_both_ends)
+{
+  int trace[] = { 40, 1000, 20, 0, 30 };
+  HostSim::scriptAnalog(A0_PIN, trace, 5);
+  sensor_filter trimmed = { FILTER_TRIMMED_MEAN, 0, 1, 0 };
+  Sensor gas(A0_PIN, gasParams(5, trimmed), NULL);
+  CHECK_CLOSE(30, gas.collectInput(), 0);
+
+  /* Trimming everything leaves the median */
+  trimmed.trim = 3;
+  gas.setFilter(trimmed);
+  HostSim::scriptAnalog(A0_PIN, trace, 5);
+  CHECK_CLOSE(30, gas.collectInput(), 0);
+}
+
+TEST(hampel_replaces_outliers_with_the_median)
+{
+  int trace[] = { 100, 104, 96, 102, 98, 900, 100, 0, 100 };
+  HostSim::scriptAnalog(A0_PIN, trace, 9);
+  sensor_filter hampel = { FILTER_HAMPEL, 0, 0, 3.0 };
+  Sensor gas(A0_PIN, gasParams(9, hampel), NULL);
+
+  /* Median 100, MAD 2: the limit is 8.9, both spikes count as 100 */
+  CHECK_CLOSE(100, gas.collectInput(), 1e-4);
+
+  /* Quantisation noise is kept */
+  int flat[] = { 100, 100, 100, 101, 100, 100, 99, 100, 100 };
+  HostSim::scriptAnalog(A0_PIN, flat, 9);
+  CHECK_CLOSE(900.0 / 9, gas.collectInput(), 1e-4);
+}
+
+TEST(oversampling_adds_resolution)
+{
+  /* A level between two codes, dithered by the noise */
+  int trace[32];
+  for(int i = 0; i < 32; i++)
+  {
+    trace[i] = i % 4 == 0 ? 101 : 100;
+  }
+  HostSim::scriptAnalog(A0_PIN, trace, 32);
+  sensor_filter oversampling = { FILTER_MEAN, 2, 0, 0 };
+  Sensor gas(A0_PIN, gasParams(2, oversampling), NULL);
+  CHECK_CLOSE(100.25, gas.collectInput(), 0);
+  CHECK_EQUAL(32UL, HostSim::analogReads(A0_PIN));
+
+  oversampling.oversamplingBits = 9;
+  gas.setFilter(oversampling);
+  CHECK_EQUAL(MAX_OVERSAMPLING_BITS, gas.getFilter().oversamplingBits);
+}
+
+TEST(filtered_readings_are_the_same_asynchronously)
+{
+  int trace[] = { 100, 101, 900, 99, 100 };
+  sensor_filter median = { FILTER_MEDIAN, 1, 0, 0 };
+  sensor_params params = gasParams(5, median);
+  params.readDelay = 10;
+  Sensor gas(A0_PIN, params, NULL);
+
+  int oversampled[20];
+  for(int i = 0; i < 20; i++)
+  {
+    oversampled[i] = trace[i / 4];
+  }
+  HostSim::scriptAnalog(A0_PIN, oversampled, 20);
+  float direct = gas.collectInput();
+
+  HostSim::scriptAnalog(A0_PIN, oversampled, 20);
+  gas.begin();
+  while(!gas.poll())
+  {
+    delay(1);
+  }
+  CHECK_CLOSE(100, direct, 0);
+  CHECK_CLOSE(direct, gas.getLastValue(), 0);
+}
+
+TEST(sorting_stages_keep_a_bounded_window)
+{
+  HostSim::setAnalog(A0_PIN, 50);
+  sensor_filter median = { FILTER_MEDIAN, 0, 0, 0 };
+  Sensor gas(A0_PIN, gasParams(MAX_FILTER_SAMPLES + 10, median), NULL);
+  gas.collectInput();
+  CHECK_EQUAL((unsigned long)MAX_FILTER_SAMPLES, HostSim::analogReads(A0_PIN));
+
+  /* The mean only sums, it takes all the samples */
+  sensor_filter mean = { FILTER_MEAN, 0, 0, 0 };
+  gas.setFilter(mean);
+  gas.collectInput();
+  CHECK_EQUAL((unsigned long)(2 * MAX_FILTER_SAMPLES + 10), HostSim::analogReads(A0_PIN));
+}
+
+TEST(built_in_types_use_the_filter)
+{
+  int trace[] = { 100, 101, 900, 99, 100, 100, 100, 100, 100, 100 };
+  HostSim::scriptAnalog(A0_PIN, trace, 10);
+  Sensor co(A0_PIN, CO_SENSOR, NULL);
+  sensor_filter median = { FILTER_MEDIAN, 0, 0, 0 };
+  co.setFilter(median);
+  CHECK_CLOSE(100, co.collectInput(), 0);
+}
@@ -0,0 +1,91 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "SensorFormat.h"
+
+#define A0_PIN 14
+
+static bool formatsAs(const char* expected, float value, short int decimals)
+{
+  char buffer[32];
+  size_t length = formatFloat(buffer, sizeof(buffer), value, decimals);
+  return strcmp(expected, buffer) == 0 && length == strlen(expected);
+}
+
+TEST(floats_honour_decimals_and_round)
+{
+  CHECK(formatsAs("3", 3.14159, 0));
+  CHECK(formatsAs("3.1", 3.14159, 1));
+  CHECK(formatsAs("3.142", 3.14159, 3));
+  CHECK(formatsAs("2.50", 2.499, 2));
+  CHECK(formatsAs("10", 9.5, 0));
+  CHECK(formatsAs("0.05", 0.05, 2));
+  CHECK(formatsAs("-19.65", -19.655, 2));
+  CHECK(formatsAs("0", 0, 0));
+}
+
+TEST(large_values_do_not_overflow)
+{
+  /* dtostrf(val, 4, 3) into 8 bytes overflowed from 10000 */
+  CHECK(formatsAs("12345.500", 12345.5, 3));
+  CHECK(formatsAs("1000000", 1000000, 0));
+  CHECK(formatsAs("ovf", 1e12, 0));
+}
+
+TEST(special_values)
+{
+  CHECK(formatsAs("nan", NAN, 2));
+  CHECK(formatsAs("-inf", -INFINITY, 2));
+}
+
+TEST(format_buffer_truncates_and_reports_overflow)
+{
+  char buffer[8];
+  FormatBuffer text(buffer, sizeof(buffer));
+  text.print("abc").print(42L);
+  CHECK(strcmp("abc42", buffer) == 0);
+  CHECK(!text.overflowed());
+  text.print(123.456, 2);
+  CHECK(strcmp("abc4212", buffer) == 0);
+  CHECK_EQUAL(7U, text.length());
+  CHECK(text.overflowed());
+  text.clear().print(F("x")).pad(3).print('|');
+  CHECK(strcmp("x  |", buffer) == 0);
+  text.clear().print(-305L);
+  CHECK(strcmp("-305", buffer) == 0);
+}
+
+TEST(formatted_reading_uses_sensor_decimals)
+{
+  HostSim::setAnalog(A0_PIN, 110);
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, "Soil");
+  char buffer[SENSOR_MESSAGE_SIZE];
+  size_t length = soil.formattedReading(buffer, sizeof(buffer));
+  CHECK(strcmp("Soil   : 16.65%", buffer) == 0);
+  CHECK_EQUAL(strlen(buffer), length);
+
+  soil.formattedReading(buffer, sizeof(buffer), 12345.678);
+  CHECK(strcmp("Soil   : 12345.68%", buffer) == 0);
+}
+
+TEST(formatted_reading_fits_long_labels)
+{
+  Sensor ultraviolet(A0_PIN, ULTRAVIOLET_LIGHT_SENSOR, NULL);
+  char buffer[SENSOR_MESSAGE_SIZE];
+  ultraviolet.formattedReading(buffer, sizeof(buffer), 1023);
+  CHECK(strcmp("Ultraviolet light intensity: 1023xx", buffer) == 0);
+}
+
+TEST(print_all_does_not_touch_the_heap)
+{
+  HostStream stream;
+  HostSim::setAnalog(A0_PIN, 110);
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, "Soil");
+  soil.streamAdd(stream);
+  stream.clearOutput();
+
+  unsigned long allocations = HostSim::stringAllocations();
+  soil.printAll();
+  soil.printReading(0);
+  CHECK_EQUAL(allocations, HostSim::stringAllocations());
+  CHECK(stream.output() == "Soil   : 16.65%\r\nSoil   : 16.65%\r\n");
+}
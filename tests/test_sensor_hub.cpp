@@ -0,0 +1,155 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "SensorHub.h"
+
+#define A0_PIN 14
+#define A1_PIN 15
+
+/* One sample per reading, so readings complete as soon as they start */
+static sensor_params quickParams = { 1, 0, 0, 1, 2, {0.0, 100.0}, "Quick", "u", 1, &basicAnalogicReading, {} };
+
+static Sensor* completed[64];
+static int completedCount = 0;
+
+static void onReading(Sensor* sensor, float value)
+{
+  if(completedCount < 64)
+  {
+    completed[completedCount++] = sensor;
+  }
+}
+
+static void runFor(SensorHub& hub, unsigned long ms)
+{
+  unsigned long end = millis() + ms;
+  while(millis() < end)
+  {
+    hub.run();
+    delay(1);
+  }
+}
+
+TEST(each_sensor_runs_at_its_own_period)
+{
+  Sensor fast(A0_PIN, quickParams, "Fast");
+  Sensor slow(A1_PIN, quickParams, "Slow");
+  SensorHub hub;
+  int fastId = hub.add(&fast, 1000, 0, 0);
+  int slowId = hub.add(&slow, 2500, 0, 0);
+
+  runFor(hub, 10000);
+  CHECK_EQUAL(10UL, hub.getSlot(fastId)->readings);
+  CHECK_EQUAL(4UL, hub.getSlot(slowId)->readings);
+  CHECK_EQUAL(0UL, hub.getMissedDeadlines());
+  CHECK_EQUAL(10000UL, hub.nextDeadline());
+}
+
+TEST(priority_orders_sensors_due_together)
+{
+  completedCount = 0;
+  Sensor low(A0_PIN, quickParams, "Low");
+  Sensor high(A1_PIN, quickParams, "High");
+  SensorHub hub;
+  hub.setCallback(&onReading);
+  hub.add(&low, 1000, 5, 0);
+  hub.add(&high, 1000, 1, 0);
+
+  hub.run();
+  CHECK_EQUAL(2, completedCount);
+  CHECK(completed[0] == &high);
+  CHECK(completed[1] == &low);
+}
+
+TEST(priority_comes_before_lateness)
+{
+  completedCount = 0;
+  Sensor low(A0_PIN, quickParams, "Low");
+  Sensor high(A1_PIN, quickParams, "High");
+  SensorHub hub;
+  hub.setCallback(&onReading);
+  hub.add(&low, 1000, 5, 0);
+  delay(50);
+  hub.add(&high, 1000, 1, 0);
+
+  /* The low priority sensor is 50 ms more overdue, the high priority one still starts first */
+  hub.run();
+  CHECK_EQUAL(2, completedCount);
+  CHECK(completed[0] == &high);
+  CHECK(completed[1] == &low);
+}
+
+TEST(asynchronous_readings_are_polled_to_completion)
+{
+  HostSim::setAnalog(A0_PIN, 42);
+  Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+  SensorHub hub;
+  int id = hub.add(&light, 2000, 0, 0);
+
+  /* 10 samples 100 ms apart */
+  runFor(hub, 899);
+  CHECK(hub.getSlot(id)->running);
+  runFor(hub, 2);
+  CHECK(!hub.getSlot(id)->running);
+  CHECK_EQUAL(1UL, hub.getSlot(id)->readings);
+  CHECK_CLOSE(42.0, light.getLastValue(), 1e-4);
+}
+
+TEST(late_readings_count_as_missed_deadlines)
+{
+  HostSim::setAnalog(A0_PIN, 42);
+  Sensor light(A0_PIN, LIGHT_SENSOR, "Light");
+  SensorHub hub;
+  /* A reading takes 900 ms, more than the period */
+  int id = hub.add(&light, 500, 0, 50);
+
+  runFor(hub, 5000);
+  const hub_slot* slot = hub.getSlot(id);
+  CHECK(slot->readings >= 5);
+  CHECK(slot->missed >= 4);
+  CHECK(slot->maxLateness >= 400);
+  CHECK_EQUAL(slot->missed, hub.getMissedDeadlines());
+}
+
+TEST(jitter_budget_tolerates_small_lateness)
+{
+  Sensor quick(A0_PIN, quickParams, "Quick");
+  SensorHub hub;
+  int id = hub.add(&quick, 100, 0, 20);
+
+  /* The loop only comes back every 15 ms */
+  unsigned long end = millis() + 1000;
+  while(millis() < end)
+  {
+    hub.run();
+    delay(15);
+  }
+  CHECK_EQUAL(0UL, hub.getSlot(id)->missed);
+  CHECK(hub.getSlot(id)->maxLateness > 0);
+}
+
+TEST(utilisation_is_the_share_of_time_in_sensor_work)
+{
+  HostSim::setAnalogReadMicros(100);
+  Sensor quick(A0_PIN, quickParams, "Quick");
+  SensorHub hub;
+  hub.add(&quick, 10, 0, 0);
+
+  runFor(hub, 1000);
+  /* 100 readings of 100 us in about 1 s */
+  CHECK_CLOSE(0.01, hub.getUtilisation(), 0.002);
+
+  hub.resetStatistics();
+  CHECK_EQUAL(0UL, hub.getSlot(0)->readings);
+}
+
+TEST(full_hub_rejects_sensors)
+{
+  Sensor quick(A0_PIN, quickParams, "Quick");
+  SensorHub hub;
+  for(int i = 0; i < MAX_HUB_SENSORS; i++)
+  {
+    CHECK_EQUAL(i, hub.add(&quick, 1000, 0, 0));
+  }
+  CHECK_EQUAL(-1, hub.add(&quick, 1000, 0, 0));
+  CHECK_EQUAL(MAX_HUB_SENSORS, hub.getSensorsCount());
+}
@@ -0,0 +1,25 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+
+#define A0_PIN 14
+
+TEST(built_in_types_are_read_from_flash)
+{
+  HostSim::setAnalog(A0_PIN, 110);
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, "Soil");
+
+  CHECK_EQUAL(SOIL_MOISTURE_METER, soil.getTypeCode());
+  CHECK(strcmp("Soil moisture meter", soil.getSensorType()) == 0);
+  CHECK(strcmp("%", soil.getMeasureUnit()) == 0);
+  CHECK_CLOSE(-0.0273, soil.getSlope(), 1e-6);
+  CHECK_EQUAL(7.0f, soil.getCalibrationPoints()[1]);
+  CHECK_CLOSE(-0.0273 * 110 + 19.655, soil.collectInput(), 1e-4);
+}
+
+TEST(unknown_types_fall_back_to_the_ec_meter)
+{
+  Sensor unknown(A0_PIN, 0x42, NULL);
+  CHECK(strcmp("EC meter", unknown.getLabel()) == 0);
+  CHECK(strcmp("uS/cm", unknown.getMeasureUnit()) == 0);
+  CHECK_EQUAL(400.0f, unknown.getCalibrationPoints()[0]);
+}
@@ -0,0 +1,181 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "StreamRegistry.h"
+
+#define A0_PIN 14
+
+static char noKey()
+{
+  return -1;
+}
+
+TEST(sensors_on_the_same_port_share_one_channel)
+{
+  HostStream serial;
+  HostSim::setAnalog(A0_PIN, 12);
+  {
+    Sensor first(A0_PIN, LIGHT_SENSOR, "One");
+    Sensor second(A0_PIN, LIGHT_SENSOR, "Two");
+    CHECK_EQUAL(0, first.streamAdd(serial));
+    CHECK_EQUAL(0, second.streamAdd(serial));
+    CHECK_EQUAL(1, StreamRegistry::channelsInUse());
+    CHECK_EQUAL(2, StreamRegistry::users(0));
+
+    first.printAll();
+    second.printAll();
+    CHECK(serial.output() == "One    : 12xx\r\nTwo    : 12xx\r\n");
+  }
+  CHECK_EQUAL(0, StreamRegistry::channelsInUse());
+}
+
+TEST(a_channel_added_twice_is_written_once)
+{
+  HostStream serial;
+  HostSim::setAnalog(A0_PIN, 12);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  CHECK_EQUAL(0, sensor.streamAdd(serial));
+  CHECK_EQUAL(0, sensor.streamAdd(serial));
+  CHECK_EQUAL(1, StreamRegistry::users(0));
+
+  /* Same port, other channel */
+  CHECK_EQUAL(1, sensor.streamAdd(serial, &noKey));
+  CHECK_EQUAL(2, StreamRegistry::channelsInUse());
+
+  sensor.printReading(0);
+  CHECK(serial.output() == "Light  : 12xx\r\n");
+}
+
+TEST(sensors_subscribe_by_handle)
+{
+  HostStream serial;
+  int handle = StreamRegistry::open(serial);
+  CHECK(handle >= 0);
+  {
+    Sensor first(A0_PIN, LIGHT_SENSOR, NULL);
+    Sensor second(A0_PIN, LIGHT_SENSOR, NULL);
+    CHECK_EQUAL(0, first.streamAttach(handle));
+    CHECK_EQUAL(0, second.streamAttach(handle));
+    CHECK_EQUAL(3, StreamRegistry::users(handle));
+  }
+  CHECK_EQUAL(1, StreamRegistry::users(handle));
+  StreamRegistry::close(handle);
+  CHECK(StreamRegistry::channel(handle) == NULL);
+
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, NULL);
+  CHECK_EQUAL(-1, sensor.streamAttach(handle));
+}
+
+TEST(a_full_registry_refuses_new_channels)
+{
+  HostStream streams[MAX_SHARED_STREAMS + 1];
+  int handles[MAX_SHARED_STREAMS];
+  for(int i = 0; i < MAX_SHARED_STREAMS; i++)
+  {
+    handles[i] = StreamRegistry::open(streams[i]);
+    CHECK_EQUAL(i, handles[i]);
+  }
+  CHECK_EQUAL(-1, StreamRegistry::open(streams[MAX_SHARED_STREAMS]));
+
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, NULL);
+  CHECK_EQUAL(-1, sensor.streamAdd(streams[MAX_SHARED_STREAMS]));
+  CHECK_EQUAL(0, sensor.streamAdd(streams[3]));
+  CHECK_EQUAL(2, StreamRegistry::users(handles[3]));
+
+  for(int i = 0; i < MAX_SHARED_STREAMS; i++)
+  {
+    StreamRegistry::close(handles[i]);
+  }
+  CHECK_EQUAL(1, StreamRegistry::channelsInUse());
+}
+
+TEST(users_of_a_channel_do_not_wrap)
+{
+  HostStream serial;
+  int handles[255];
+  for(int i = 0; i < 255; i++)
+  {
+    handles[i] = StreamRegistry::open(serial);
+    CHECK_EQUAL(handles[0], handles[i]);
+  }
+  CHECK_EQUAL(255, StreamRegistry::users(handles[0]));
+  CHECK_EQUAL(-1, StreamRegistry::open(serial));
+  CHECK(!StreamRegistry::retain(handles[0]));
+  for(int i = 0; i < 255; i++)
+  {
+    StreamRegistry::close(handles[i]);
+  }
+  CHECK_EQUAL(0, StreamRegistry::channelsInUse());
+}
+
+static String lastWritten;
+
+static void writeLine(String s)
+{
+  lastWritten = s;
+}
+
+TEST(printing_builds_no_string)
+{
+  HostStream serial;
+  HostStream display;
+  LiquidCrystal lcd;
+  HostSim::setAnalog(A0_PIN, 12);
+  Sensor sensor(A0_PIN, LIGHT_SENSOR, "Light");
+  sensor.streamAdd(serial);
+  sensor.streamAdd(display, &lcd);
+
+  unsigned long allocations = HostSim::stringAllocations();
+  sensor.printAll();
+  CHECK_EQUAL(allocations, HostSim::stringAllocations());
+  CHECK(serial.output() == "Light  : 12xx\r\n");
+  CHECK(lcd.screen() == "Light  : 12xx\r\n");
+  CHECK(display.output().empty());
+
+  /* writeChar functions take a String */
+  sensor.streamAdd(&noKey, &writeLine);
+  sensor.printAll();
+  CHECK(lastWritten == "Light  : 12xx");
+  lastWritten = "";
+}
+
+TEST(writes_in_a_batch_are_coalesced_per_port)
+{
+  HostStream serial;
+  HostStream console;
+  HostSim::setAnalog(A0_PIN, 12);
+  Sensor first(A0_PIN, LIGHT_SENSOR, "One");
+  Sensor second(A0_PIN, LIGHT_SENSOR, "Two");
+  Sensor third(A0_PIN, LIGHT_SENSOR, "Three");
+  first.streamAdd(serial);
+  second.streamAdd(serial);
+  third.streamAdd(serial);
+
+  first.printAll();
+  unsigned long unbatched = serial.writes();
+  CHECK(unbatched >= 2);
+  serial.clearOutput();
+
+  /* Three lines, one write, sent at the end of the batch */
+  unsigned long writes = serial.writes();
+  StreamRegistry::beginBatch();
+  StreamRegistry::beginBatch();
+  first.printAll();
+  second.printAll();
+  third.printAll();
+  StreamRegistry::endBatch();
+  CHECK(serial.output().empty());
+  StreamRegistry::endBatch();
+  CHECK_EQUAL(writes + 1, serial.writes());
+  CHECK(serial.output() == "One    : 12xx\r\nTwo    : 12xx\r\nThree  : 12xx\r\n");
+
+  /* Another port takes the pending bytes out first, each port keeps its order */
+  serial.clearOutput();
+  second.streamAdd(console);
+  StreamRegistry::beginBatch();
+  first.printAll();
+  second.printAll();
+  CHECK(serial.output() == "One    : 12xx\r\nTwo    : 12xx\r\n");
+  CHECK(console.output().empty());
+  StreamRegistry::endBatch();
+  CHECK(console.output() == "Two    : 12xx\r\n");
+}
@@ -0,0 +1,200 @@
+#include "SensorTest.h"
+#include "Sensor.h"
+#include "Telemetry.h"
+#include "TelemetryDecoder.h"
+
+#define A0_PIN 14
+
+/* Feeds a whole output to the decoder, returns the results in order */
+static std::vector<TelemetryDecoder::Result> decodeAll(TelemetryDecoder& decoder, const std::string& output)
+{
+  std::vector<TelemetryDecoder::Result> results;
+  for(size_t i = 0; i < output.size(); i++)
+  {
+    TelemetryDecoder::Result result = decoder.feed((uint8_t)output[i]);
+    if(result != TelemetryDecoder::NONE)
+    {
+      results.push_back(result);
+    }
+  }
+  return results;
+}
+
+TEST(crc16_matches_ccitt_false)
+{
+  const byte check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+  CHECK_EQUAL(0x29B1, crc16(check, sizeof(check)));
+}
+
+TEST(cobs_round_trips_zeros_and_long_runs)
+{
+  byte input[300];
+  for(size_t i = 0; i < sizeof(input); i++)
+  {
+    input[i] = i % 100 == 0 ? 0x00 : (byte)(i % 251 + 1);
+  }
+  byte encoded[sizeof(input) + sizeof(input) / 254 + 1];
+
+  size_t lengths[] = { 0, 1, 7, 254, 255, 300 };
+  for(size_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++)
+  {
+    size_t length = cobsEncode(input, lengths[n], encoded);
+    CHECK(length <= lengths[n] + lengths[n] / 254 + 1);
+    for(size_t i = 0; i < length; i++)
+    {
+      CHECK(encoded[i] != 0x00);
+    }
+
+    std::vector<uint8_t> frame(encoded, encoded + length);
+    std::vector<uint8_t> decoded;
+    CHECK(TelemetryDecoder::cobsDecode(frame, decoded));
+    CHECK(decoded == std::vector<uint8_t>(input, input + lengths[n]));
+  }
+}
+
+TEST(binary_output_sends_schema_once_then_samples)
+{
+  HostStream stream;
+  HostSim::setAnalog(A0_PIN, 110);
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, "Soil");
+  soil.setId(7);
+  soil.streamAdd(stream);
+  soil.setOutputMode(OUTPUT_BINARY);
+  stream.clearOutput();
+
+  unsigned long allocations = HostSim::stringAllocations();
+  soil.printAll();
+  soil.printReading(0);
+  CHECK_EQUAL(allocations, HostSim::stringAllocations());
+
+  TelemetryDecoder decoder;
+  std::vector<TelemetryDecoder::Result> results = decodeAll(decoder, stream.output());
+  CHECK_EQUAL(3U, results.size());
+  CHECK(results[0] == TelemetryDecoder::SCHEMA);
+  CHECK(results[1] == TelemetryDecoder::SAMPLE);
+  CHECK(results[2] == TelemetryDecoder::SAMPLE);
+  CHECK_EQUAL(0UL, decoder.errors());
+
+  const TelemetrySchema* schema = decoder.schema(7);
+  CHECK(schema != NULL);
+  CHECK(schema->label == "Soil");
+  CHECK(schema->measureUnit == "%");
+  CHECK_EQUAL(SOIL_MOISTURE_METER, schema->typeCode);
+  CHECK_EQUAL(2, schema->decimals);
+
+  const TelemetrySample& sample = decoder.sample();
+  CHECK_EQUAL(7, sample.sensorId);
+  CHECK_EQUAL(soil.getLastReadingTime(), (unsigned long)sample.timestamp);
+  CHECK_CLOSE(soil.getLastRawValue(), sample.rawValue, 0);
+  CHECK_CLOSE(soil.getLastValue(), sample.value, 0);
+
+  /* The decoder shows the same line the text mode prints */
+  char line[SENSOR_MESSAGE_SIZE];
+  soil.formattedReading(line, sizeof(line), sample.value);
+  CHECK(decoder.format(sample) == line);
+}
+
+TEST(binary_frames_are_compact)
+{
+  HostStream stream;
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, "Soil");
+  soil.streamAdd(stream);
+  soil.setOutputMode(OUTPUT_BINARY);
+  soil.printAll();
+  stream.clearOutput();
+
+  soil.printAll();
+  CHECK(stream.output().size() <= 19);
+  CHECK_EQUAL(0, stream.output()[stream.output().size() - 1]);
+}
+
+TEST(resend_schema_after_reconnect)
+{
+  HostStream stream;
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, "Soil");
+  soil.streamAdd(stream);
+  soil.setOutputMode(OUTPUT_BINARY);
+  soil.printAll();
+  soil.resendSchema();
+  stream.clearOutput();
+  soil.printAll();
+
+  TelemetryDecoder decoder;
+  std::vector<TelemetryDecoder::Result> results = decodeAll(decoder, stream.output());
+  CHECK_EQUAL(2U, results.size());
+  CHECK(results[0] == TelemetryDecoder::SCHEMA);
+}
+
+TEST(decoder_rejects_corrupted_frames_and_resynchronises)
+{
+  byte frame[TELEMETRY_MAX_FRAME];
+  size_t length = telemetrySampleFrame(frame, 1, LIGHT_SENSOR, 1000, 512, 50);
+  std::string output((const char*)frame, length);
+
+  std::string corrupted = output;
+  corrupted[5] ^= 0x10;
+
+  TelemetryDecoder decoder;
+  std::vector<TelemetryDecoder::Result> results = decodeAll(decoder, corrupted + output);
+  CHECK_EQUAL(2U, results.size());
+  CHECK(results[0] == TelemetryDecoder::ERROR);
+  CHECK(results[1] == TelemetryDecoder::SAMPLE);
+  CHECK_EQUAL(1UL, decoder.errors());
+  CHECK_CLOSE(50, decoder.sample().value, 0);
+  CHECK(decoder.format(decoder.sample()) == "#1: 50");
+}
+
+TEST(decoder_rejects_unknown_type_codes)
+{
+  byte frame[TELEMETRY_MAX_FRAME];
+  size_t length = telemetrySampleFrame(frame, 1, SOIL_MOISTURE_METER + 1, 1000, 512, 50);
+  TelemetryDecoder decoder;
+  std::vector<TelemetryDecoder::Result> results = decodeAll(decoder, std::string((const char*)frame, length));
+  CHECK_EQUAL(1U, results.size());
+  CHECK(results[0] == TelemetryDecoder::ERROR);
+  CHECK_EQUAL(1UL, decoder.errors());
+
+  /* A sensor built with an unknown code sends CUSTOM */
+  Sensor unknown(A0_PIN, 0x40, "Odd");
+  CHECK_EQUAL(CUSTOM, unknown.getTypeCode());
+}
+
+TEST(decoded_labels_are_padded_as_the_sensor_pads_them)
+{
+  HostStream stream;
+  Sensor soil(A0_PIN, SOIL_MOISTURE_METER, "pH");
+  soil.streamAdd(stream);
+  soil.setOutputMode(OUTPUT_BINARY);
+  soil.printAll();
+
+  TelemetryDecoder decoder;
+  decodeAll(decoder, stream.output());
+  CHECK_EQUAL(SENSOR_LABEL_WIDTH, decoder.schema(soil.getId())->labelWidth);
+  std::string line = decoder.format(decoder.sample());
+  CHECK_EQUAL((size_t)SENSOR_LABEL_WIDTH, line.find(':'));
+
+  /* The width is the sender's, e.g. a Due's */
+  byte frame[TELEMETRY_MAX_FRAME];
+  size_t length = telemetrySchemaFrame(frame, 3, LIGHT_SENSOR, 1, 20, "Light", "lx");
+  length += telemetrySampleFrame(frame + length, 3, LIGHT_SENSOR, 1000, 512, 50);
+  decodeAll(decoder, std::string((const char*)frame, length));
+  CHECK(decoder.format(decoder.sample()) == "Light               : 50.0lx");
+}
+
+TEST(decoder_rejects_frames_too_short_for_a_header)
+{
+  /* One byte of payload, with a valid CRC */
+  byte record[] = { TELEMETRY_SAMPLE, 0, 0 };
+  unsigned short crc = crc16(record, 1);
+  record[1] = crc & 0xFF;
+  record[2] = crc >> 8;
+  byte frame[sizeof(record) + 2];
+  size_t length = cobsEncode(record, sizeof(record), frame);
+  frame[length++] = 0x00;
+
+  TelemetryDecoder decoder;
+  std::vector<TelemetryDecoder::Result> results = decodeAll(decoder, std::string((const char*)frame, length));
+  CHECK_EQUAL(1U, results.size());
+  CHECK(results[0] == TelemetryDecoder::ERROR);
+  CHECK_EQUAL(1UL, decoder.errors());
+}